@@ -0,0 +1,70 @@
+/**
+ * @file      lvgl_mem.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LVGL_MEM_CLASS_COUNT    5       // 16, 32, 64, 128 and 256 byte slots
+
+typedef struct lvgl_mem_class_stats {
+    uint16_t        size;           // slot size
+    uint32_t        in_use;         // live slots
+    uint32_t        peak;           // high-water mark of live slots
+    uint32_t        slots;          // slots carved from arena pages
+    uint32_t        allocs;
+} lvgl_mem_class_stats_t;
+
+typedef struct lvgl_mem_stats {
+    lvgl_mem_class_stats_t classes[LVGL_MEM_CLASS_COUNT];
+    uint32_t        arena_pages;
+    uint32_t        arena_pages_used;   // pages handed to a size class
+    uint32_t        arena_free_bytes;   // carved slots sitting in free lists
+    uint8_t         frag_pct;           // share of carved arena memory not in use
+    uint32_t        sram_bytes;         // live mid-sized blocks in the internal heap
+    uint32_t        sram_peak;
+    uint32_t        psram_bytes;        // live large blocks in PSRAM
+    uint32_t        psram_peak;
+    uint32_t        fallbacks;          // small requests the arena could not serve
+    uint32_t        failures;
+    uint32_t        used_bytes;         // everything LVGL holds right now
+    uint32_t        peak_used_bytes;
+} lvgl_mem_stats_t;
+
+/**
+ * @brief LVGL's allocator when CONFIG_LV_MEM_CUSTOM is set and this header is
+ *        CONFIG_LV_MEM_CUSTOM_INCLUDE. Small requests come from an internal
+ *        SRAM arena, mid-sized from the internal heap and large ones from
+ *        PSRAM. Not thread safe: LVGL only allocates under lvgl_lock().
+ */
+void *lvgl_mem_alloc(size_t size);
+
+void lvgl_mem_free(void *ptr);
+
+void *lvgl_mem_realloc(void *ptr, size_t size);
+
+// Bytes LVGL holds, the replacement for lv_mem_monitor() with a custom allocator
+uint32_t lvgl_mem_used(void);
+
+void lvgl_mem_get_stats(lvgl_mem_stats_t *stats);
+
+void lvgl_mem_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+// lv_conf_internal.h defaults these to malloc/free/realloc when
+// LV_MEM_CUSTOM is set; lv_mem.c includes this header after it
+#undef LV_MEM_CUSTOM_ALLOC
+#undef LV_MEM_CUSTOM_FREE
+#undef LV_MEM_CUSTOM_REALLOC
+#define LV_MEM_CUSTOM_ALLOC     lvgl_mem_alloc
+#define LV_MEM_CUSTOM_FREE      lvgl_mem_free
+#define LV_MEM_CUSTOM_REALLOC   lvgl_mem_realloc
@@ -0,0 +1,259 @@
+/**
+ * @file      lvgl_mem.c
+ * @license   MIT
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "lvgl_mem.h"
+
+#ifndef CONFIG_LVGL_MEM_ARENA_KB
+#define CONFIG_LVGL_MEM_ARENA_KB        32
+#endif
+#ifndef CONFIG_LVGL_MEM_PSRAM_THRESHOLD
+#define CONFIG_LVGL_MEM_PSRAM_THRESHOLD 4096
+#endif
+
+#define ARENA_PAGE_SIZE     1024
+#define ARENA_PAGES         (CONFIG_LVGL_MEM_ARENA_KB * 1024 / ARENA_PAGE_SIZE)
+
+typedef enum {
+    TIER_SRAM = 0,
+    TIER_PSRAM,
+} block_tier_t;
+
+// Heap blocks carry their size so free/realloc can account for them
+typedef struct block_hdr {
+    uint32_t        size;
+    uint32_t        tier;
+} block_hdr_t;
+
+typedef struct free_slot {
+    struct free_slot *next;
+} free_slot_t;
+
+static const char *TAG = "lvgl_mem";
+
+static const uint16_t class_sizes[LVGL_MEM_CLASS_COUNT] = { 16, 32, 64, 128, 256 };
+
+static uint8_t *arena = NULL;
+static bool arena_tried = false;
+static uint8_t page_class[ARENA_PAGES];     // size class of each carved page
+static free_slot_t *free_lists[LVGL_MEM_CLASS_COUNT];
+static lvgl_mem_stats_t stats;
+
+static void arena_init(void)
+{
+    arena_tried = true;
+    // the class table is reported with or without an arena
+    for (int i = 0; i < LVGL_MEM_CLASS_COUNT; i++) {
+        stats.classes[i].size = class_sizes[i];
+    }
+    arena = (uint8_t *)heap_caps_malloc(ARENA_PAGES * ARENA_PAGE_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!arena) {
+        ESP_LOGW(TAG, "No room for a %d KB arena, small objects use the heap", CONFIG_LVGL_MEM_ARENA_KB);
+        return;
+    }
+    stats.arena_pages = ARENA_PAGES;
+}
+
+static int size_class(size_t size)
+{
+    for (int i = 0; i < LVGL_MEM_CLASS_COUNT; i++) {
+        if (size <= class_sizes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static inline bool in_arena(const void *ptr)
+{
+    return arena && (const uint8_t *)ptr >= arena &&
+           (const uint8_t *)ptr < arena + ARENA_PAGES * ARENA_PAGE_SIZE;
+}
+
+static inline int slot_class(const void *ptr)
+{
+    return page_class[((const uint8_t *)ptr - arena) / ARENA_PAGE_SIZE];
+}
+
+static void track_used(int32_t delta)
+{
+    stats.used_bytes += delta;
+    if (stats.used_bytes > stats.peak_used_bytes) {
+        stats.peak_used_bytes = stats.used_bytes;
+    }
+}
+
+// Carve the next unused arena page into slots of one class
+static bool arena_refill(int cls)
+{
+    if (stats.arena_pages_used >= ARENA_PAGES) {
+        return false;
+    }
+    uint32_t page = stats.arena_pages_used++;
+    uint8_t *base = arena + page * ARENA_PAGE_SIZE;
+    uint16_t size = class_sizes[cls];
+    page_class[page] = cls;
+    for (uint32_t off = 0; off + size <= ARENA_PAGE_SIZE; off += size) {
+        free_slot_t *slot = (free_slot_t *)(base + off);
+        slot->next = free_lists[cls];
+        free_lists[cls] = slot;
+        stats.classes[cls].slots++;
+        stats.arena_free_bytes += size;
+    }
+    return true;
+}
+
+static void *arena_alloc(int cls)
+{
+    if (!free_lists[cls] && !arena_refill(cls)) {
+        return NULL;
+    }
+    free_slot_t *slot = free_lists[cls];
+    free_lists[cls] = slot->next;
+
+    lvgl_mem_class_stats_t *cs = &stats.classes[cls];
+    cs->allocs++;
+    if (++cs->in_use > cs->peak) {
+        cs->peak = cs->in_use;
+    }
+    stats.arena_free_bytes -= class_sizes[cls];
+    track_used(class_sizes[cls]);
+    return slot;
+}
+
+static void *heap_alloc(size_t size)
+{
+    block_tier_t tier = size >= CONFIG_LVGL_MEM_PSRAM_THRESHOLD ? TIER_PSRAM : TIER_SRAM;
+    uint32_t caps = tier == TIER_PSRAM ? MALLOC_CAP_SPIRAM : (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    block_hdr_t *hdr = (block_hdr_t *)heap_caps_malloc(sizeof(block_hdr_t) + size, caps);
+    if (!hdr) {
+        // try the other tier before giving up
+        tier = tier == TIER_PSRAM ? TIER_SRAM : TIER_PSRAM;
+        caps = tier == TIER_PSRAM ? MALLOC_CAP_SPIRAM : (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        hdr = (block_hdr_t *)heap_caps_malloc(sizeof(block_hdr_t) + size, caps);
+        if (!hdr) {
+            stats.failures++;
+            return NULL;
+        }
+    }
+    hdr->size = size;
+    hdr->tier = tier;
+    if (tier == TIER_PSRAM) {
+        stats.psram_bytes += size;
+        if (stats.psram_bytes > stats.psram_peak) {
+            stats.psram_peak = stats.psram_bytes;
+        }
+    } else {
+        stats.sram_bytes += size;
+        if (stats.sram_bytes > stats.sram_peak) {
+            stats.sram_peak = stats.sram_bytes;
+        }
+    }
+    track_used(size);
+    return hdr + 1;
+}
+
+void *lvgl_mem_alloc(size_t size)
+{
+    if (!arena_tried) {
+        arena_init();
+    }
+    int cls = size_class(size);
+    if (cls >= 0 && arena) {
+        void *ptr = arena_alloc(cls);
+        if (ptr) {
+            return ptr;
+        }
+        stats.fallbacks++;
+    }
+    return heap_alloc(size);
+}
+
+void lvgl_mem_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    if (in_arena(ptr)) {
+        int cls = slot_class(ptr);
+        free_slot_t *slot = (free_slot_t *)ptr;
+        slot->next = free_lists[cls];
+        free_lists[cls] = slot;
+        stats.classes[cls].in_use--;
+        stats.arena_free_bytes += class_sizes[cls];
+        track_used(-(int32_t)class_sizes[cls]);
+        return;
+    }
+    block_hdr_t *hdr = (block_hdr_t *)ptr - 1;
+    if (hdr->tier == TIER_PSRAM) {
+        stats.psram_bytes -= hdr->size;
+    } else {
+        stats.sram_bytes -= hdr->size;
+    }
+    track_used(-(int32_t)hdr->size);
+    heap_caps_free(hdr);
+}
+
+void *lvgl_mem_realloc(void *ptr, size_t size)
+{
+    if (!ptr) {
+        return lvgl_mem_alloc(size);
+    }
+    size_t old_size;
+    if (in_arena(ptr)) {
+        int cls = slot_class(ptr);
+        // still the same class: keep the slot
+        if (size_class(size) == cls) {
+            return ptr;
+        }
+        old_size = class_sizes[cls];
+    } else {
+        old_size = ((block_hdr_t *)ptr - 1)->size;
+    }
+    void *new_ptr = lvgl_mem_alloc(size);
+    if (!new_ptr) {
+        return NULL;
+    }
+    memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+    lvgl_mem_free(ptr);
+    return new_ptr;
+}
+
+uint32_t lvgl_mem_used(void)
+{
+    return stats.used_bytes;
+}
+
+void lvgl_mem_get_stats(lvgl_mem_stats_t *out)
+{
+    *out = stats;
+    uint32_t carved = stats.arena_pages_used * ARENA_PAGE_SIZE;
+    out->frag_pct = carved ? (uint8_t)(stats.arena_free_bytes * 100 / carved) : 0;
+}
+
+void lvgl_mem_log_stats(void)
+{
+    lvgl_mem_stats_t s;
+    lvgl_mem_get_stats(&s);
+    ESP_LOGI(TAG, "used %lu B (peak %lu), arena %lu/%lu pages, %u%% free in slots, %lu fallbacks",
+             (unsigned long)s.used_bytes, (unsigned long)s.peak_used_bytes,
+             (unsigned long)s.arena_pages_used, (unsigned long)s.arena_pages,
+             s.frag_pct, (unsigned long)s.fallbacks);
+    for (int i = 0; i < LVGL_MEM_CLASS_COUNT; i++) {
+        ESP_LOGI(TAG, "  %3u B: %lu in use, peak %lu, %lu slots, %lu allocs",
+                 s.classes[i].size, (unsigned long)s.classes[i].in_use,
+                 (unsigned long)s.classes[i].peak, (unsigned long)s.classes[i].slots,
+                 (unsigned long)s.classes[i].allocs);
+    }
+    ESP_LOGI(TAG, "  SRAM %lu B (peak %lu), PSRAM %lu B (peak %lu), %lu failures",
+             (unsigned long)s.sram_bytes, (unsigned long)s.sram_peak,
+             (unsigned long)s.psram_bytes, (unsigned long)s.psram_peak,
+             (unsigned long)s.failures);
+}
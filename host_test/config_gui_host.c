@@ -0,0 +1,40 @@
+/**
+ * @file      config_gui_host.c
+ * @license   MIT
+ *
+ * The GUI running on Linux: starts the application, lets it run and writes
+ * the screen to a PPM image.
+ *
+ *   config_gui_host [seconds] [out.ppm]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_app.h"
+
+int main(int argc, char **argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 2;
+    const char *path = argc > 2 ? argv[2] : "config_gui.ppm";
+
+    host_app_start();
+    vTaskDelay(pdMS_TO_TICKS(seconds * 1000));
+
+    lvgl_render_stats_t render;
+    lvgl_get_render_stats(&render);
+    display_headless_stats_t headless;
+    display_headless_get_stats(&headless);
+    printf("%lu frames, %lu areas, %llu pixels flushed\n", (unsigned long)render.frames,
+           (unsigned long)headless.areas, (unsigned long long)headless.pixels);
+
+    bool ok = false;
+    if (lvgl_lock(-1)) {
+        ok = display_headless_dump_ppm(path);
+        lvgl_unlock();
+    }
+    if (ok) {
+        printf("screen written to %s\n", path);
+    }
+    return ok ? 0 : 1;
+}
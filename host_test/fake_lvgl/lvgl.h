@@ -0,0 +1,573 @@
+/**
+ * @file      lvgl.h
+ * @license   MIT
+ *
+ * A small LVGL 8.3 look-alike for unit tests of the GUI modules. Types keep
+ * the LVGL names and the fields the firmware touches; objects keep their
+ * tree, state, styles, events and group focus the way LVGL does, and the
+ * refresh calls the display driver like LVGL's, but nothing is drawn (see
+ * lvgl_fake.h). Tests that need real rendering build against LVGL itself
+ * (LVGL_DIR).
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LV_MIN(a, b)    ((a) < (b) ? (a) : (b))
+#define LV_MAX(a, b)    ((a) > (b) ? (a) : (b))
+#define LV_UNUSED(x)    ((void)(x))
+
+#define LV_INV_BUF_SIZE 32
+#define LV_DISP_DEF_REFR_PERIOD     30
+#define LV_INDEV_DEF_READ_PERIOD    30
+#define LV_COORD_MAX    ((1 << 13) - 1)
+
+// the firmware's sdkconfig sets CONFIG_LV_TICK_CUSTOM; lv_tick_get() is the monotonic clock here
+#define LV_TICK_CUSTOM  1
+#define LV_NO_TIMER_READY   0xFFFFFFFF
+
+uint32_t lv_tick_get(void);
+uint32_t lv_tick_elaps(uint32_t prev_tick);
+
+typedef int16_t lv_coord_t;
+typedef uint8_t lv_opa_t;
+typedef uint8_t lv_res_t;
+typedef uint32_t lv_state_t;
+typedef uint32_t lv_style_selector_t;
+typedef uint32_t lv_part_t;
+
+#define LV_RES_INV      0
+#define LV_RES_OK       1
+
+#define LV_OPA_TRANSP   0
+#define LV_OPA_60       153
+#define LV_OPA_COVER    255
+
+#define LV_PART_MAIN    0x000000
+
+enum {
+    LV_STATE_DEFAULT     =  0x0000,
+    LV_STATE_CHECKED     =  0x0001,
+    LV_STATE_FOCUSED     =  0x0002,
+    LV_STATE_FOCUS_KEY   =  0x0004,
+    LV_STATE_EDITED      =  0x0008,
+    LV_STATE_HOVERED     =  0x0010,
+    LV_STATE_PRESSED     =  0x0020,
+    LV_STATE_SCROLLED    =  0x0040,
+    LV_STATE_DISABLED    =  0x0080,
+    LV_STATE_USER_1      =  0x1000,
+    LV_STATE_USER_2      =  0x2000,
+    LV_STATE_USER_3      =  0x4000,
+    LV_STATE_USER_4      =  0x8000,
+};
+
+enum {
+    LV_OBJ_FLAG_HIDDEN          = (1L << 0),
+    LV_OBJ_FLAG_CLICKABLE       = (1L << 1),
+    LV_OBJ_FLAG_SCROLLABLE      = (1L << 4),
+    LV_OBJ_FLAG_IGNORE_LAYOUT   = (1L << 17),
+};
+typedef uint32_t lv_obj_flag_t;
+
+enum {
+    LV_KEY_UP        = 17,
+    LV_KEY_DOWN      = 18,
+    LV_KEY_RIGHT     = 19,
+    LV_KEY_LEFT      = 20,
+    LV_KEY_ESC       = 27,
+    LV_KEY_DEL       = 127,
+    LV_KEY_BACKSPACE = 8,
+    LV_KEY_ENTER     = 10,
+    LV_KEY_NEXT      = 9,
+    LV_KEY_PREV      = 11,
+    LV_KEY_HOME      = 2,
+    LV_KEY_END       = 3,
+};
+
+typedef enum {
+    LV_EVENT_ALL = 0,
+    LV_EVENT_PRESSED,
+    LV_EVENT_PRESSING,
+    LV_EVENT_PRESS_LOST,
+    LV_EVENT_SHORT_CLICKED,
+    LV_EVENT_LONG_PRESSED,
+    LV_EVENT_LONG_PRESSED_REPEAT,
+    LV_EVENT_CLICKED,
+    LV_EVENT_RELEASED,
+    LV_EVENT_KEY = 13,
+    LV_EVENT_FOCUSED = 14,
+    LV_EVENT_DEFOCUSED = 15,
+    LV_EVENT_VALUE_CHANGED = 28,
+    LV_EVENT_DELETE = 33,
+} lv_event_code_t;
+
+typedef union {
+    struct {
+        uint16_t blue : 5;
+        uint16_t green : 6;
+        uint16_t red : 5;
+    } ch;
+    uint16_t full;
+} lv_color_t;
+
+static inline lv_color_t lv_color_hex(uint32_t c)
+{
+    lv_color_t color;
+    color.full = (uint16_t)(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F));
+    return color;
+}
+
+static inline lv_color_t lv_color_black(void)
+{
+    return lv_color_hex(0x000000);
+}
+
+static inline lv_color_t lv_color_white(void)
+{
+    return lv_color_hex(0xFFFFFF);
+}
+
+typedef enum {
+    LV_PALETTE_RED,
+    LV_PALETTE_PINK,
+    LV_PALETTE_PURPLE,
+    LV_PALETTE_DEEP_PURPLE,
+    LV_PALETTE_INDIGO,
+    LV_PALETTE_BLUE,
+    LV_PALETTE_LIGHT_BLUE,
+    LV_PALETTE_CYAN,
+    LV_PALETTE_TEAL,
+    LV_PALETTE_GREEN,
+    LV_PALETTE_LIGHT_GREEN,
+    LV_PALETTE_LIME,
+    LV_PALETTE_YELLOW,
+    LV_PALETTE_AMBER,
+    LV_PALETTE_ORANGE,
+    LV_PALETTE_DEEP_ORANGE,
+    LV_PALETTE_BROWN,
+    LV_PALETTE_BLUE_GREY,
+    LV_PALETTE_GREY,
+    _LV_PALETTE_LAST,
+} lv_palette_t;
+
+// The red and grey rows of LVGL's palette; other palettes give grey
+lv_color_t lv_palette_main(lv_palette_t p);
+lv_color_t lv_palette_lighten(lv_palette_t p, uint8_t lvl);
+
+typedef struct {
+    lv_coord_t x1;
+    lv_coord_t y1;
+    lv_coord_t x2;
+    lv_coord_t y2;
+} lv_area_t;
+
+static inline lv_coord_t lv_area_get_width(const lv_area_t *area)
+{
+    return (lv_coord_t)(area->x2 - area->x1 + 1);
+}
+
+static inline lv_coord_t lv_area_get_height(const lv_area_t *area)
+{
+    return (lv_coord_t)(area->y2 - area->y1 + 1);
+}
+
+static inline uint32_t lv_area_get_size(const lv_area_t *area)
+{
+    return (uint32_t)lv_area_get_width(area) * (uint32_t)lv_area_get_height(area);
+}
+
+static inline void lv_area_set(lv_area_t *area, lv_coord_t x1, lv_coord_t y1, lv_coord_t x2, lv_coord_t y2)
+{
+    area->x1 = x1;
+    area->y1 = y1;
+    area->x2 = x2;
+    area->y2 = y2;
+}
+
+static inline bool _lv_area_is_in(const lv_area_t *ain, const lv_area_t *aholder, lv_coord_t radius)
+{
+    (void)radius;
+    return ain->x1 >= aholder->x1 && ain->y1 >= aholder->y1 &&
+           ain->x2 <= aholder->x2 && ain->y2 <= aholder->y2;
+}
+
+static inline bool _lv_area_is_on(const lv_area_t *a1_p, const lv_area_t *a2_p)
+{
+    return a1_p->x1 <= a2_p->x2 && a1_p->x2 >= a2_p->x1 &&
+           a1_p->y1 <= a2_p->y2 && a1_p->y2 >= a2_p->y1;
+}
+
+static inline void _lv_area_join(lv_area_t *a_res_p, const lv_area_t *a1_p, const lv_area_t *a2_p)
+{
+    a_res_p->x1 = LV_MIN(a1_p->x1, a2_p->x1);
+    a_res_p->y1 = LV_MIN(a1_p->y1, a2_p->y1);
+    a_res_p->x2 = LV_MAX(a1_p->x2, a2_p->x2);
+    a_res_p->y2 = LV_MAX(a1_p->y2, a2_p->y2);
+}
+
+typedef struct _lv_obj_t lv_obj_t;
+
+typedef struct _lv_timer_t lv_timer_t;
+typedef void (*lv_timer_cb_t)(lv_timer_t *timer);
+
+struct _lv_timer_t {
+    uint32_t        period;
+    uint32_t        last_run;
+    lv_timer_cb_t   timer_cb;
+    void            *user_data;
+    int32_t         repeat_count;
+    uint32_t        paused : 1;
+};
+
+lv_timer_t *lv_timer_create(lv_timer_cb_t timer_xcb, uint32_t period, void *user_data);
+void lv_timer_set_cb(lv_timer_t *timer, lv_timer_cb_t timer_cb);
+void lv_timer_set_period(lv_timer_t *timer, uint32_t period);
+void lv_timer_ready(lv_timer_t *timer);
+void lv_timer_pause(lv_timer_t *timer);
+void lv_timer_resume(lv_timer_t *timer);
+void lv_timer_del(lv_timer_t *timer);
+uint32_t lv_timer_handler(void);
+
+typedef struct _lv_disp_drv_t lv_disp_drv_t;
+typedef struct _lv_disp_t lv_disp_t;
+
+typedef struct {
+    void            *buf1;
+    void            *buf2;
+    void            *buf_act;
+    uint32_t        size;
+    volatile int    flushing;
+    volatile int    flushing_last;
+    volatile uint32_t last_area : 1;
+    volatile uint32_t last_part : 1;
+} lv_disp_draw_buf_t;
+
+typedef enum {
+    LV_DISP_ROT_NONE = 0,
+    LV_DISP_ROT_90,
+    LV_DISP_ROT_180,
+    LV_DISP_ROT_270
+} lv_disp_rot_t;
+
+struct _lv_disp_drv_t {
+    lv_coord_t      hor_res;
+    lv_coord_t      ver_res;
+    lv_disp_draw_buf_t *draw_buf;
+    uint32_t        direct_mode : 1;
+    uint32_t        full_refresh : 1;
+    uint32_t        sw_rotate : 1;
+    uint32_t        rotated : 2;
+    void (*flush_cb)(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+    void (*rounder_cb)(lv_disp_drv_t *disp_drv, lv_area_t *area);
+    void (*monitor_cb)(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px);
+    void (*wait_cb)(lv_disp_drv_t *disp_drv);
+    void            *user_data;
+};
+
+struct _lv_disp_t {
+    lv_disp_drv_t   *driver;
+    lv_timer_t      *refr_timer;
+    lv_obj_t        *act_scr;
+    lv_area_t       inv_areas[LV_INV_BUF_SIZE];
+    uint8_t         inv_area_joined[LV_INV_BUF_SIZE];
+    uint16_t        inv_p;
+};
+
+lv_timer_t *_lv_disp_get_refr_timer(lv_disp_t *disp);
+void _lv_disp_refr_timer(lv_timer_t *timer);
+void _lv_inv_area(lv_disp_t *disp, const lv_area_t *area_p);
+void lv_disp_draw_buf_init(lv_disp_draw_buf_t *draw_buf, void *buf1, void *buf2, uint32_t size_in_px_cnt);
+void lv_disp_drv_init(lv_disp_drv_t *driver);
+lv_disp_t *lv_disp_drv_register(lv_disp_drv_t *driver);
+void lv_disp_flush_ready(lv_disp_drv_t *disp_drv);
+bool lv_disp_flush_is_last(lv_disp_drv_t *disp_drv);
+lv_disp_t *lv_disp_get_default(void);
+
+typedef struct _lv_event_t lv_event_t;
+typedef void (*lv_event_cb_t)(lv_event_t *e);
+
+struct _lv_event_dsc_t;
+
+struct _lv_event_t {
+    lv_obj_t        *target;
+    lv_obj_t        *current_target;
+    lv_event_code_t code;
+    void            *user_data;
+    void            *param;
+};
+
+static inline void *lv_event_get_param(lv_event_t *e)
+{
+    return e->param;
+}
+
+static inline void *lv_event_get_user_data(lv_event_t *e)
+{
+    return e->user_data;
+}
+
+static inline lv_event_code_t lv_event_get_code(lv_event_t *e)
+{
+    return e->code;
+}
+
+static inline lv_obj_t *lv_event_get_target(lv_event_t *e)
+{
+    return e->target;
+}
+
+static inline lv_obj_t *lv_event_get_current_target(lv_event_t *e)
+{
+    return e->current_target;
+}
+
+/* ---- styles ---- */
+
+// The properties the firmware sets; numbered for the fake, not as in LVGL
+typedef enum {
+    LV_STYLE_PROP_INV = 0,
+    LV_STYLE_WIDTH,
+    LV_STYLE_HEIGHT,
+    LV_STYLE_X,
+    LV_STYLE_Y,
+    LV_STYLE_ALIGN,
+    LV_STYLE_BG_COLOR,
+    LV_STYLE_BG_OPA,
+    LV_STYLE_TEXT_COLOR,
+    LV_STYLE_OPA,
+    LV_STYLE_LAYOUT,
+    LV_STYLE_GRID_COLUMN_DSC_ARRAY,
+    LV_STYLE_GRID_ROW_DSC_ARRAY,
+    LV_STYLE_GRID_CELL_COLUMN_POS,
+    LV_STYLE_GRID_CELL_COLUMN_SPAN,
+    LV_STYLE_GRID_CELL_X_ALIGN,
+    LV_STYLE_GRID_CELL_ROW_POS,
+    LV_STYLE_GRID_CELL_ROW_SPAN,
+    LV_STYLE_GRID_CELL_Y_ALIGN,
+    _LV_STYLE_LAST_BUILT_IN_PROP,
+} lv_style_prop_t;
+
+typedef union {
+    int32_t         num;
+    const void      *ptr;
+    lv_color_t      color;
+} lv_style_value_t;
+
+// Every property in place rather than LVGL's packed list
+typedef struct {
+    uint32_t        set;                // bit per lv_style_prop_t
+    uint8_t         prop_cnt;
+    lv_style_value_t values[_LV_STYLE_LAST_BUILT_IN_PROP];
+} lv_style_t;
+
+typedef enum {
+    LV_ALIGN_DEFAULT = 0,
+    LV_ALIGN_TOP_LEFT,
+    LV_ALIGN_TOP_MID,
+    LV_ALIGN_TOP_RIGHT,
+    LV_ALIGN_BOTTOM_LEFT,
+    LV_ALIGN_BOTTOM_MID,
+    LV_ALIGN_BOTTOM_RIGHT,
+    LV_ALIGN_LEFT_MID,
+    LV_ALIGN_RIGHT_MID,
+    LV_ALIGN_CENTER,
+} lv_align_t;
+
+#define LV_LAYOUT_FLEX  1
+#define LV_LAYOUT_GRID  2
+
+#define LV_GRID_FR(x)           (LV_COORD_MAX - 100 + (x))
+#define LV_GRID_CONTENT         (LV_COORD_MAX - 101)
+#define LV_GRID_TEMPLATE_LAST   (LV_COORD_MAX)
+
+typedef enum {
+    LV_GRID_ALIGN_START,
+    LV_GRID_ALIGN_CENTER,
+    LV_GRID_ALIGN_END,
+    LV_GRID_ALIGN_STRETCH,
+    LV_GRID_ALIGN_SPACE_EVENLY,
+    LV_GRID_ALIGN_SPACE_AROUND,
+    LV_GRID_ALIGN_SPACE_BETWEEN,
+} lv_grid_align_t;
+
+void lv_style_init(lv_style_t *style);
+void lv_style_set_prop(lv_style_t *style, lv_style_prop_t prop, lv_style_value_t value);
+void lv_style_set_bg_color(lv_style_t *style, lv_color_t value);
+void lv_style_set_align(lv_style_t *style, lv_align_t value);
+void lv_style_set_layout(lv_style_t *style, uint16_t value);
+void lv_style_set_grid_column_dsc_array(lv_style_t *style, const lv_coord_t value[]);
+void lv_style_set_grid_row_dsc_array(lv_style_t *style, const lv_coord_t value[]);
+
+void lv_obj_add_style(lv_obj_t *obj, lv_style_t *style, lv_style_selector_t selector);
+void lv_obj_set_local_style_prop(lv_obj_t *obj, lv_style_prop_t prop, lv_style_value_t value,
+                                 lv_style_selector_t selector);
+// The value for the object's current state, with LVGL's precedence: an exact
+// state match wins, else the most specific state the object is in
+lv_style_value_t lv_obj_get_style_prop(const lv_obj_t *obj, lv_part_t part, lv_style_prop_t prop);
+
+static inline lv_opa_t lv_obj_get_style_opa(const lv_obj_t *obj, lv_part_t part)
+{
+    return (lv_opa_t)lv_obj_get_style_prop(obj, part, LV_STYLE_OPA).num;
+}
+
+static inline lv_color_t lv_obj_get_style_bg_color(const lv_obj_t *obj, lv_part_t part)
+{
+    return lv_obj_get_style_prop(obj, part, LV_STYLE_BG_COLOR).color;
+}
+
+/* ---- images ---- */
+
+typedef uint8_t lv_img_cf_t;
+
+enum {
+    LV_IMG_CF_UNKNOWN = 0,
+    LV_IMG_CF_TRUE_COLOR = 4,
+    LV_IMG_CF_TRUE_COLOR_ALPHA = 5,
+};
+
+typedef struct {
+    uint32_t        cf : 5;
+    uint32_t        always_zero : 3;
+    uint32_t        reserved : 2;
+    uint32_t        w : 11;
+    uint32_t        h : 11;
+} lv_img_header_t;
+
+typedef struct {
+    lv_img_header_t header;
+    uint32_t        data_size;
+    const uint8_t   *data;
+} lv_img_dsc_t;
+
+lv_obj_t *lv_img_create(lv_obj_t *parent);
+void lv_img_set_src(lv_obj_t *obj, const void *src);
+void lv_img_cache_invalidate_src(const void *src);
+
+uint32_t lv_snapshot_buf_size_needed(lv_obj_t *obj, lv_img_cf_t cf);
+lv_res_t lv_snapshot_take_to_buf(lv_obj_t *obj, lv_img_cf_t cf, lv_img_dsc_t *dsc, void *buf, uint32_t buff_size);
+
+/* ---- LVGL heap ---- */
+
+typedef struct {
+    uint32_t        total_size;
+    uint32_t        free_cnt;
+    uint32_t        free_size;
+    uint32_t        free_biggest_size;
+    uint32_t        used_cnt;
+    uint32_t        max_used;
+    uint8_t         used_pct;
+    uint8_t         frag_pct;
+} lv_mem_monitor_t;
+
+void lv_mem_monitor(lv_mem_monitor_t *mon_p);
+
+/* ---- objects ---- */
+
+lv_obj_t *lv_obj_create(lv_obj_t *parent);
+void lv_obj_del(lv_obj_t *obj);
+void lv_obj_del_async(lv_obj_t *obj);
+bool lv_obj_is_valid(const lv_obj_t *obj);
+lv_obj_t *lv_btn_create(lv_obj_t *parent);
+lv_obj_t *lv_label_create(lv_obj_t *parent);
+lv_obj_t *lv_scr_act(void);
+lv_obj_t *lv_layer_top(void);
+void lv_scr_load(lv_obj_t *scr);
+
+lv_obj_t *lv_obj_get_parent(const lv_obj_t *obj);
+lv_obj_t *lv_obj_get_screen(const lv_obj_t *obj);
+lv_obj_t *lv_obj_get_child(const lv_obj_t *obj, int32_t id);
+uint32_t lv_obj_get_child_cnt(const lv_obj_t *obj);
+uint32_t lv_obj_get_index(const lv_obj_t *obj);
+void lv_obj_move_to_index(lv_obj_t *obj, int32_t index);
+
+void lv_obj_add_flag(lv_obj_t *obj, lv_obj_flag_t f);
+void lv_obj_clear_flag(lv_obj_t *obj, lv_obj_flag_t f);
+bool lv_obj_has_flag(const lv_obj_t *obj, lv_obj_flag_t f);
+void lv_obj_add_state(lv_obj_t *obj, lv_state_t state);
+void lv_obj_clear_state(lv_obj_t *obj, lv_state_t state);
+lv_state_t lv_obj_get_state(const lv_obj_t *obj);
+bool lv_obj_has_state(const lv_obj_t *obj, lv_state_t state);
+
+// Local style properties, as LVGL sets them for these calls
+void lv_obj_set_style_bg_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector);
+void lv_obj_set_style_text_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector);
+void lv_obj_set_style_grid_column_dsc_array(lv_obj_t *obj, const lv_coord_t value[], lv_style_selector_t selector);
+void lv_obj_set_style_grid_row_dsc_array(lv_obj_t *obj, const lv_coord_t value[], lv_style_selector_t selector);
+void lv_obj_set_pos(lv_obj_t *obj, lv_coord_t x, lv_coord_t y);
+void lv_obj_set_size(lv_obj_t *obj, lv_coord_t w, lv_coord_t h);
+void lv_obj_set_layout(lv_obj_t *obj, uint32_t layout);
+void lv_obj_set_grid_cell(lv_obj_t *obj, lv_grid_align_t x_align, uint8_t col_pos, uint8_t col_span,
+                          lv_grid_align_t y_align, uint8_t row_pos, uint8_t row_span);
+void lv_obj_align(lv_obj_t *obj, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs);
+void lv_obj_align_to(lv_obj_t *obj, const lv_obj_t *base, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs);
+void lv_obj_center(lv_obj_t *obj);
+
+// Sizes follow the grid cell, the set size, an image source or the display
+void lv_obj_update_layout(const lv_obj_t *obj);
+lv_coord_t lv_obj_get_width(const lv_obj_t *obj);
+lv_coord_t lv_obj_get_height(const lv_obj_t *obj);
+
+void lv_label_set_text(lv_obj_t *obj, const char *text);
+void lv_label_set_text_static(lv_obj_t *obj, const char *text);
+void lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...);
+char *lv_label_get_text(const lv_obj_t *obj);
+
+struct _lv_event_dsc_t *lv_obj_add_event_cb(lv_obj_t *obj, lv_event_cb_t event_cb, lv_event_code_t filter,
+                                            void *user_data);
+bool lv_obj_remove_event_cb(lv_obj_t *obj, lv_event_cb_t event_cb);
+lv_res_t lv_event_send(lv_obj_t *obj, lv_event_code_t event_code, void *param);
+
+typedef struct _lv_group_t lv_group_t;
+
+lv_group_t *lv_group_create(void);
+void lv_group_add_obj(lv_group_t *group, lv_obj_t *obj);
+void lv_group_remove_obj(lv_obj_t *obj);
+void lv_group_focus_obj(lv_obj_t *obj);
+lv_obj_t *lv_group_get_focused(const lv_group_t *group);
+
+typedef enum {
+    LV_INDEV_STATE_RELEASED = 0,
+    LV_INDEV_STATE_PRESSED
+} lv_indev_state_t;
+
+typedef enum {
+    LV_INDEV_TYPE_NONE,
+    LV_INDEV_TYPE_POINTER,
+    LV_INDEV_TYPE_KEYPAD,
+} lv_indev_type_t;
+
+typedef struct {
+    uint32_t        key;
+    lv_indev_state_t state;
+    bool            continue_reading;
+} lv_indev_data_t;
+
+typedef struct _lv_indev_drv_t lv_indev_drv_t;
+
+struct _lv_indev_drv_t {
+    lv_indev_type_t type;
+    void (*read_cb)(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
+    lv_timer_t      *read_timer;
+    void            *user_data;
+};
+
+typedef struct _lv_indev_t {
+    lv_indev_drv_t  *driver;
+    lv_group_t      *group;
+} lv_indev_t;
+
+void lv_indev_drv_init(lv_indev_drv_t *driver);
+lv_indev_t *lv_indev_drv_register(lv_indev_drv_t *driver);
+void lv_indev_set_group(lv_indev_t *indev, lv_group_t *group);
+
+#ifdef __cplusplus
+}
+#endif
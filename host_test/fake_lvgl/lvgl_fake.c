@@ -0,0 +1,1244 @@
+/**
+ * @file      lvgl_fake.c
+ * @license   MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lvgl_fake.h"
+
+#define FAKE_TIMERS     32
+#define FAKE_ASYNC      32
+
+/*
+ * LVGL heap model: what LVGL 8.3 allocates for these calls on a 32-bit
+ * target, every block with the allocator's 4 byte header. Close enough to
+ * compare UI builders and to check budget bookkeeping, not byte exact.
+ */
+#define MEM_HDR             4
+#define MEM_OBJ             (40 + MEM_HDR)      // lv_obj_t, also lv_btn_t
+#define MEM_LABEL           (76 + MEM_HDR)      // lv_label_t
+#define MEM_IMG             (64 + MEM_HDR)      // lv_img_t
+#define MEM_SPEC_ATTR       (28 + MEM_HDR)      // with the first child or event callback
+#define MEM_CHILD           4                   // the parent's children array
+#define MEM_EVENT_DSC       12
+#define MEM_STYLE_SLOT      8                   // _lv_obj_style_t, added or local
+#define MEM_LOCAL_STYLE     (8 + MEM_HDR)       // local lv_style_t, one property inline
+#define MEM_LOCAL_PROP      6                   // value and id, from the second property
+#define MEM_GROUP_NODE      (12 + MEM_HDR)
+#define MEM_TIMER           (24 + MEM_HDR)
+
+static lv_fake_event_t events[LV_FAKE_LOG_MAX];
+static uint32_t event_count;
+static uint32_t scr_loads;
+static lv_obj_t *active_screen;
+static lv_obj_t *top_layer;
+static lv_obj_t *async_del[FAKE_ASYNC];
+static uint32_t async_count;
+static lv_timer_t timers[FAKE_TIMERS];
+static bool timer_used[FAKE_TIMERS];
+static lv_disp_t fake_disp;
+static uint32_t flush_ready_count;
+static uint32_t refr_count;
+static lv_obj_t *focused;
+static lv_indev_t *indev_act;           // input device being read
+static lv_fake_stats_t stats;
+static uint32_t mem_used;
+static uint32_t mem_max_used;
+static uint32_t mem_blocks;
+
+uint32_t lv_tick_get(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+uint32_t lv_tick_elaps(uint32_t prev_tick)
+{
+    return lv_tick_get() - prev_tick;
+}
+
+/* ---- heap model ---- */
+
+static void mem_charge(lv_obj_t *obj, int32_t bytes)
+{
+    if (obj) {
+        obj->mem += bytes;
+    }
+    mem_used += bytes;
+    if (mem_used > mem_max_used) {
+        mem_max_used = mem_used;
+    }
+}
+
+// A realloc'd array of elem sized entries going from before to after entries
+static int32_t array_cost(uint32_t before, uint32_t after, uint32_t elem)
+{
+    int32_t bytes = ((int32_t)after - (int32_t)before) * (int32_t)elem;
+    if (!before && after) {
+        bytes += MEM_HDR;
+    } else if (before && !after) {
+        bytes -= MEM_HDR;
+    }
+    return bytes;
+}
+
+static void spec_attr_alloc(lv_obj_t *obj)
+{
+    if (!obj->spec_attr) {
+        obj->spec_attr = true;
+        mem_charge(obj, MEM_SPEC_ATTR);
+    }
+}
+
+void lv_mem_monitor(lv_mem_monitor_t *mon_p)
+{
+    memset(mon_p, 0, sizeof(*mon_p));
+    mon_p->total_size = LV_FAKE_MEM_SIZE;
+    mon_p->free_size = LV_FAKE_MEM_SIZE - mem_used;
+    mon_p->free_biggest_size = mon_p->free_size;
+    mon_p->free_cnt = 1;
+    mon_p->used_cnt = mem_blocks;
+    mon_p->max_used = mem_max_used;
+    mon_p->used_pct = (uint8_t)(mem_used * 100 / LV_FAKE_MEM_SIZE);
+}
+
+/* ---- styles ---- */
+
+lv_color_t lv_palette_main(lv_palette_t p)
+{
+    return lv_color_hex(p == LV_PALETTE_RED ? 0xF44336 : 0x9E9E9E);
+}
+
+lv_color_t lv_palette_lighten(lv_palette_t p, uint8_t lvl)
+{
+    static const uint32_t red[] = { 0xEF5350, 0xE57373, 0xEF9A9A, 0xFFCDD2, 0xFFEBEE };
+    static const uint32_t grey[] = { 0xBDBDBD, 0xE0E0E0, 0xEEEEEE, 0xF5F5F5, 0xFAFAFA };
+    if (lvl < 1 || lvl > 5) {
+        return lv_palette_main(p);
+    }
+    return lv_color_hex(p == LV_PALETTE_RED ? red[lvl - 1] : grey[lvl - 1]);
+}
+
+void lv_style_init(lv_style_t *style)
+{
+    memset(style, 0, sizeof(*style));
+}
+
+// true when the property was not set before
+static bool style_set(lv_style_t *style, lv_style_prop_t prop, lv_style_value_t value)
+{
+    bool is_new = !(style->set & (1u << prop));
+    style->set |= 1u << prop;
+    style->values[prop] = value;
+    style->prop_cnt += is_new;
+    return is_new;
+}
+
+void lv_style_set_prop(lv_style_t *style, lv_style_prop_t prop, lv_style_value_t value)
+{
+    style_set(style, prop, value);
+}
+
+void lv_style_set_bg_color(lv_style_t *style, lv_color_t value)
+{
+    style_set(style, LV_STYLE_BG_COLOR, (lv_style_value_t){ .color = value });
+}
+
+void lv_style_set_align(lv_style_t *style, lv_align_t value)
+{
+    style_set(style, LV_STYLE_ALIGN, (lv_style_value_t){ .num = value });
+}
+
+void lv_style_set_layout(lv_style_t *style, uint16_t value)
+{
+    style_set(style, LV_STYLE_LAYOUT, (lv_style_value_t){ .num = value });
+}
+
+void lv_style_set_grid_column_dsc_array(lv_style_t *style, const lv_coord_t value[])
+{
+    style_set(style, LV_STYLE_GRID_COLUMN_DSC_ARRAY, (lv_style_value_t){ .ptr = value });
+}
+
+void lv_style_set_grid_row_dsc_array(lv_style_t *style, const lv_coord_t value[])
+{
+    style_set(style, LV_STYLE_GRID_ROW_DSC_ARRAY, (lv_style_value_t){ .ptr = value });
+}
+
+static uint32_t local_style_cnt(const lv_obj_t *obj)
+{
+    uint32_t n = 0;
+    while (n < obj->style_cnt && !obj->styles[n].style) {
+        n++;
+    }
+    return n;
+}
+
+static lv_fake_obj_style_t *style_slot_insert(lv_obj_t *obj, uint32_t index)
+{
+    if (obj->style_cnt == LV_FAKE_STYLE_MAX) {
+        fprintf(stderr, "lvgl_fake: more than %d styles on an object\n", LV_FAKE_STYLE_MAX);
+        abort();
+    }
+    memmove(&obj->styles[index + 1], &obj->styles[index], (obj->style_cnt - index) * sizeof(obj->styles[0]));
+    mem_charge(obj, array_cost(obj->style_cnt, obj->style_cnt + 1, MEM_STYLE_SLOT));
+    obj->style_cnt++;
+    memset(&obj->styles[index], 0, sizeof(obj->styles[0]));
+    return &obj->styles[index];
+}
+
+// LVGL puts added styles after the local ones, newest first
+void lv_obj_add_style(lv_obj_t *obj, lv_style_t *style, lv_style_selector_t selector)
+{
+    lv_fake_obj_style_t *slot = style_slot_insert(obj, local_style_cnt(obj));
+    slot->style = style;
+    slot->selector = selector;
+    stats.styles_added++;
+}
+
+void lv_obj_set_local_style_prop(lv_obj_t *obj, lv_style_prop_t prop, lv_style_value_t value,
+                                 lv_style_selector_t selector)
+{
+    lv_fake_obj_style_t *slot = NULL;
+    for (uint32_t i = 0; i < local_style_cnt(obj); i++) {
+        if (obj->styles[i].selector == selector) {
+            slot = &obj->styles[i];
+        }
+    }
+    if (!slot) {
+        // a new local style goes first
+        slot = style_slot_insert(obj, 0);
+        slot->selector = selector;
+        mem_charge(obj, MEM_LOCAL_STYLE);
+        mem_blocks++;
+        stats.local_styles++;
+    }
+    if (style_set(&slot->local, prop, value) && slot->local.prop_cnt > 1) {
+        // the inline property moves to an array once there are two
+        mem_charge(obj, slot->local.prop_cnt == 2 ? 2 * MEM_LOCAL_PROP + MEM_HDR : MEM_LOCAL_PROP);
+    }
+    stats.local_props++;
+}
+
+// LVGL 8.3 get_prop_core(): the first exact state match wins, else the first
+// style of the highest state the object is in
+static bool style_find(const lv_obj_t *obj, lv_part_t part, lv_style_prop_t prop, lv_style_value_t *value)
+{
+    int32_t weight = -1;
+    for (uint32_t i = 0; i < obj->style_cnt; i++) {
+        const lv_fake_obj_style_t *s = &obj->styles[i];
+        const lv_style_t *style = s->style ? s->style : &s->local;
+        lv_state_t state_act = s->selector & 0xFFFF;
+        if ((s->selector & 0xFF0000) != part || !(style->set & (1u << prop)) ||
+                (state_act & ~obj->state)) {
+            continue;
+        }
+        if (state_act == obj->state) {
+            *value = style->values[prop];
+            return true;
+        }
+        if ((int32_t)state_act > weight) {
+            weight = (int32_t)state_act;
+            *value = style->values[prop];
+        }
+    }
+    return weight >= 0;
+}
+
+lv_style_value_t lv_obj_get_style_prop(const lv_obj_t *obj, lv_part_t part, lv_style_prop_t prop)
+{
+    lv_style_value_t value = { 0 };
+    if (!style_find(obj, part, prop, &value)) {
+        if (prop == LV_STYLE_OPA || prop == LV_STYLE_BG_OPA) {
+            value.num = LV_OPA_COVER;
+        } else if (prop == LV_STYLE_BG_COLOR) {
+            value.color = lv_color_white();
+        }
+    }
+    return value;
+}
+
+static void set_local(lv_obj_t *obj, lv_style_prop_t prop, int32_t num, lv_style_selector_t selector)
+{
+    lv_obj_set_local_style_prop(obj, prop, (lv_style_value_t){ .num = num }, selector);
+}
+
+void lv_obj_set_style_bg_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector)
+{
+    obj->bg_color = value;
+    obj->bg_color_sets++;
+    lv_obj_set_local_style_prop(obj, LV_STYLE_BG_COLOR, (lv_style_value_t){ .color = value }, selector);
+}
+
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector)
+{
+    set_local(obj, LV_STYLE_BG_OPA, value, selector);
+}
+
+void lv_obj_set_style_text_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector)
+{
+    lv_obj_set_local_style_prop(obj, LV_STYLE_TEXT_COLOR, (lv_style_value_t){ .color = value }, selector);
+}
+
+void lv_obj_set_style_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector)
+{
+    set_local(obj, LV_STYLE_OPA, value, selector);
+}
+
+void lv_obj_set_style_grid_column_dsc_array(lv_obj_t *obj, const lv_coord_t value[], lv_style_selector_t selector)
+{
+    lv_obj_set_local_style_prop(obj, LV_STYLE_GRID_COLUMN_DSC_ARRAY, (lv_style_value_t){ .ptr = value }, selector);
+}
+
+void lv_obj_set_style_grid_row_dsc_array(lv_obj_t *obj, const lv_coord_t value[], lv_style_selector_t selector)
+{
+    lv_obj_set_local_style_prop(obj, LV_STYLE_GRID_ROW_DSC_ARRAY, (lv_style_value_t){ .ptr = value }, selector);
+}
+
+void lv_obj_set_pos(lv_obj_t *obj, lv_coord_t x, lv_coord_t y)
+{
+    set_local(obj, LV_STYLE_X, x, 0);
+    set_local(obj, LV_STYLE_Y, y, 0);
+}
+
+void lv_obj_set_size(lv_obj_t *obj, lv_coord_t w, lv_coord_t h)
+{
+    set_local(obj, LV_STYLE_WIDTH, w, 0);
+    set_local(obj, LV_STYLE_HEIGHT, h, 0);
+}
+
+void lv_obj_set_layout(lv_obj_t *obj, uint32_t layout)
+{
+    set_local(obj, LV_STYLE_LAYOUT, (int32_t)layout, 0);
+}
+
+void lv_obj_set_grid_cell(lv_obj_t *obj, lv_grid_align_t x_align, uint8_t col_pos, uint8_t col_span,
+                          lv_grid_align_t y_align, uint8_t row_pos, uint8_t row_span)
+{
+    set_local(obj, LV_STYLE_GRID_CELL_COLUMN_POS, col_pos, 0);
+    set_local(obj, LV_STYLE_GRID_CELL_ROW_POS, row_pos, 0);
+    set_local(obj, LV_STYLE_GRID_CELL_X_ALIGN, x_align, 0);
+    set_local(obj, LV_STYLE_GRID_CELL_COLUMN_SPAN, col_span, 0);
+    set_local(obj, LV_STYLE_GRID_CELL_ROW_SPAN, row_span, 0);
+    set_local(obj, LV_STYLE_GRID_CELL_Y_ALIGN, y_align, 0);
+}
+
+void lv_obj_align(lv_obj_t *obj, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs)
+{
+    set_local(obj, LV_STYLE_ALIGN, align, 0);
+    lv_obj_set_pos(obj, x_ofs, y_ofs);
+}
+
+// LVGL works out the position against base and sets it; no coordinates here
+void lv_obj_align_to(lv_obj_t *obj, const lv_obj_t *base, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs)
+{
+    (void)base;
+    (void)align;
+    lv_obj_set_pos(obj, x_ofs, y_ofs);
+}
+
+void lv_obj_center(lv_obj_t *obj)
+{
+    lv_obj_align(obj, LV_ALIGN_CENTER, 0, 0);
+}
+
+/* ---- objects ---- */
+
+static lv_obj_t *obj_new(lv_obj_t *parent, lv_fake_type_t type, uint32_t size)
+{
+    lv_obj_t *obj = calloc(1, sizeof(*obj));
+    obj->parent = parent;
+    obj->valid = true;
+    obj->type = type;
+    obj->flags = LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE;
+    mem_charge(obj, size);
+    mem_blocks++;
+    if (parent) {
+        if (parent->child_cnt == LV_FAKE_CHILD_MAX) {
+            fprintf(stderr, "lvgl_fake: more than %d children\n", LV_FAKE_CHILD_MAX);
+            abort();
+        }
+        spec_attr_alloc(parent);
+        mem_charge(parent, array_cost(parent->child_cnt, parent->child_cnt + 1, MEM_CHILD));
+        parent->children[parent->child_cnt++] = obj;
+    }
+    stats.objects++;
+    stats.live_objects++;
+    return obj;
+}
+
+lv_obj_t *lv_obj_create(lv_obj_t *parent)
+{
+    return obj_new(parent, LV_FAKE_OBJ, MEM_OBJ);
+}
+
+lv_obj_t *lv_btn_create(lv_obj_t *parent)
+{
+    lv_obj_t *obj = obj_new(parent, LV_FAKE_BTN, MEM_OBJ);
+    obj->flags &= ~LV_OBJ_FLAG_SCROLLABLE;
+    return obj;
+}
+
+static void label_text_free(lv_obj_t *obj)
+{
+    if (obj->text_mem) {
+        mem_charge(obj, -(int32_t)obj->text_mem);
+        mem_blocks--;
+        obj->text_mem = 0;
+    }
+}
+
+void lv_label_set_text(lv_obj_t *obj, const char *text)
+{
+    label_text_free(obj);
+    snprintf(obj->text, sizeof(obj->text), "%s", text);
+    obj->text_mem = (uint32_t)strlen(text) + 1 + MEM_HDR;
+    mem_charge(obj, obj->text_mem);
+    mem_blocks++;
+}
+
+void lv_label_set_text_static(lv_obj_t *obj, const char *text)
+{
+    label_text_free(obj);
+    snprintf(obj->text, sizeof(obj->text), "%s", text);
+}
+
+void lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...)
+{
+    char text[LV_FAKE_TEXT_MAX * 4];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    lv_label_set_text(obj, text);
+}
+
+char *lv_label_get_text(const lv_obj_t *obj)
+{
+    return (char *)obj->text;
+}
+
+lv_obj_t *lv_label_create(lv_obj_t *parent)
+{
+    lv_obj_t *obj = obj_new(parent, LV_FAKE_LABEL, MEM_LABEL);
+    obj->flags &= ~(LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    // LVGL's default "Text" is charged but not shown, so tests see a label never set
+    obj->text_mem = sizeof("Text") + MEM_HDR;
+    mem_charge(obj, obj->text_mem);
+    mem_blocks++;
+    return obj;
+}
+
+lv_obj_t *lv_img_create(lv_obj_t *parent)
+{
+    lv_obj_t *obj = obj_new(parent, LV_FAKE_IMG, MEM_IMG);
+    obj->flags &= ~(LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    return obj;
+}
+
+void lv_img_set_src(lv_obj_t *obj, const void *src)
+{
+    obj->img_src = src;
+}
+
+void lv_img_cache_invalidate_src(const void *src)
+{
+    (void)src;
+}
+
+// Events LVGL raises itself reach the callbacks without being logged
+static lv_res_t obj_dispatch(lv_obj_t *obj, lv_event_code_t code, void *param)
+{
+    for (uint32_t i = 0; i < obj->event_cnt && obj->valid; i++) {
+        lv_event_dsc_t dsc = obj->events[i];
+        if (dsc.filter != LV_EVENT_ALL && dsc.filter != code) {
+            continue;
+        }
+        lv_event_t e = {
+            .target = obj,
+            .current_target = obj,
+            .code = code,
+            .user_data = dsc.user_data,
+            .param = param,
+        };
+        dsc.cb(&e);
+        // a callback that removed itself shifted the rest down
+        if (i < obj->event_cnt && obj->events[i].cb != dsc.cb) {
+            i--;
+        }
+    }
+    return obj->valid ? LV_RES_OK : LV_RES_INV;
+}
+
+static void group_remove(lv_obj_t *obj);
+
+// Objects are never freed so lv_obj_is_valid() can look at deleted ones.
+// As LVGL's obj_del_core(): DELETE first, then the children, then the group.
+void lv_obj_del(lv_obj_t *obj)
+{
+    if (!obj->valid) {
+        return;
+    }
+    obj_dispatch(obj, LV_EVENT_DELETE, NULL);
+    while (obj->child_cnt) {
+        lv_obj_del(obj->children[0]);
+    }
+    if (obj->group) {
+        group_remove(obj);
+    }
+    lv_obj_t *parent = obj->parent;
+    if (parent) {
+        uint32_t i = lv_obj_get_index(obj);
+        memmove(&parent->children[i], &parent->children[i + 1],
+                (parent->child_cnt - i - 1) * sizeof(parent->children[0]));
+        mem_charge(parent, array_cost(parent->child_cnt, parent->child_cnt - 1, MEM_CHILD));
+        parent->child_cnt--;
+    }
+    label_text_free(obj);
+    mem_used -= obj->mem;
+    mem_blocks--;
+    obj->mem = 0;
+    obj->valid = false;
+    stats.live_objects--;
+    if (active_screen == obj) {
+        active_screen = NULL;
+    }
+}
+
+void lv_obj_del_async(lv_obj_t *obj)
+{
+    if (async_count < FAKE_ASYNC) {
+        async_del[async_count++] = obj;
+    }
+}
+
+void lv_fake_run_async(void)
+{
+    for (uint32_t i = 0; i < async_count; i++) {
+        lv_obj_del(async_del[i]);
+    }
+    async_count = 0;
+}
+
+bool lv_obj_is_valid(const lv_obj_t *obj)
+{
+    return obj && obj->valid;
+}
+
+lv_obj_t *lv_scr_act(void)
+{
+    if (!active_screen) {
+        active_screen = lv_obj_create(NULL);
+    }
+    return active_screen;
+}
+
+lv_obj_t *lv_layer_top(void)
+{
+    if (!top_layer) {
+        top_layer = lv_obj_create(NULL);
+    }
+    return top_layer;
+}
+
+void lv_scr_load(lv_obj_t *scr)
+{
+    active_screen = scr;
+    fake_disp.act_scr = scr;
+    scr_loads++;
+}
+
+lv_obj_t *lv_obj_get_parent(const lv_obj_t *obj)
+{
+    return obj->parent;
+}
+
+lv_obj_t *lv_obj_get_screen(const lv_obj_t *obj)
+{
+    while (obj->parent) {
+        obj = obj->parent;
+    }
+    return (lv_obj_t *)obj;
+}
+
+lv_obj_t *lv_obj_get_child(const lv_obj_t *obj, int32_t id)
+{
+    if (id < 0) {
+        id += (int32_t)obj->child_cnt;
+    }
+    return id >= 0 && (uint32_t)id < obj->child_cnt ? obj->children[id] : NULL;
+}
+
+uint32_t lv_obj_get_child_cnt(const lv_obj_t *obj)
+{
+    return obj->child_cnt;
+}
+
+uint32_t lv_obj_get_index(const lv_obj_t *obj)
+{
+    const lv_obj_t *parent = obj->parent;
+    for (uint32_t i = 0; parent && i < parent->child_cnt; i++) {
+        if (parent->children[i] == obj) {
+            return i;
+        }
+    }
+    return 0xFFFFFFFF;
+}
+
+void lv_obj_move_to_index(lv_obj_t *obj, int32_t index)
+{
+    lv_obj_t *parent = obj->parent;
+    if (!parent) {
+        return;
+    }
+    if (index < 0) {
+        index += (int32_t)parent->child_cnt;
+    }
+    uint32_t from = lv_obj_get_index(obj);
+    if (index < 0 || (uint32_t)index >= parent->child_cnt || (uint32_t)index == from) {
+        return;
+    }
+    uint32_t to = (uint32_t)index;
+    if (to < from) {
+        memmove(&parent->children[to + 1], &parent->children[to], (from - to) * sizeof(parent->children[0]));
+    } else {
+        memmove(&parent->children[from], &parent->children[from + 1], (to - from) * sizeof(parent->children[0]));
+    }
+    parent->children[to] = obj;
+}
+
+void lv_obj_add_flag(lv_obj_t *obj, lv_obj_flag_t f)
+{
+    obj->flags |= f;
+}
+
+void lv_obj_clear_flag(lv_obj_t *obj, lv_obj_flag_t f)
+{
+    obj->flags &= ~f;
+}
+
+bool lv_obj_has_flag(const lv_obj_t *obj, lv_obj_flag_t f)
+{
+    return (obj->flags & f) == f;
+}
+
+void lv_obj_add_state(lv_obj_t *obj, lv_state_t state)
+{
+    obj->state |= state;
+}
+
+void lv_obj_clear_state(lv_obj_t *obj, lv_state_t state)
+{
+    obj->state &= ~state;
+}
+
+lv_state_t lv_obj_get_state(const lv_obj_t *obj)
+{
+    return obj->state;
+}
+
+bool lv_obj_has_state(const lv_obj_t *obj, lv_state_t state)
+{
+    return (obj->state & state) != 0;
+}
+
+void lv_obj_update_layout(const lv_obj_t *obj)
+{
+    (void)obj;
+}
+
+// Sum of the parent's grid tracks the object's cell spans
+static bool grid_cell_size(const lv_obj_t *obj, bool hor, lv_coord_t *size)
+{
+    lv_style_value_t layout, pos, span, dsc;
+    if (!obj->parent || (obj->flags & LV_OBJ_FLAG_IGNORE_LAYOUT) ||
+            !style_find(obj->parent, LV_PART_MAIN, LV_STYLE_LAYOUT, &layout) || layout.num != LV_LAYOUT_GRID ||
+            !style_find(obj->parent, LV_PART_MAIN,
+                        hor ? LV_STYLE_GRID_COLUMN_DSC_ARRAY : LV_STYLE_GRID_ROW_DSC_ARRAY, &dsc) ||
+            !style_find(obj, LV_PART_MAIN, hor ? LV_STYLE_GRID_CELL_COLUMN_POS : LV_STYLE_GRID_CELL_ROW_POS, &pos) ||
+            !style_find(obj, LV_PART_MAIN, hor ? LV_STYLE_GRID_CELL_COLUMN_SPAN : LV_STYLE_GRID_CELL_ROW_SPAN, &span)) {
+        return false;
+    }
+    const lv_coord_t *track = (const lv_coord_t *)dsc.ptr;
+    uint32_t tracks = 0;
+    while (track[tracks] != LV_GRID_TEMPLATE_LAST) {
+        tracks++;
+    }
+    *size = 0;
+    for (int32_t i = pos.num; i < pos.num + span.num && i < (int32_t)tracks; i++) {
+        *size += track[i];
+    }
+    return true;
+}
+
+static lv_coord_t obj_size(const lv_obj_t *obj, bool hor)
+{
+    lv_coord_t size;
+    lv_style_value_t v;
+    if (!obj->parent) {
+        lv_disp_drv_t *drv = fake_disp.driver;
+        return drv ? (hor ? drv->hor_res : drv->ver_res) : 0;
+    }
+    if (grid_cell_size(obj, hor, &size)) {
+        return size;
+    }
+    if (style_find(obj, LV_PART_MAIN, hor ? LV_STYLE_WIDTH : LV_STYLE_HEIGHT, &v)) {
+        return (lv_coord_t)v.num;
+    }
+    if (obj->type == LV_FAKE_IMG && obj->img_src) {
+        const lv_img_dsc_t *dsc = (const lv_img_dsc_t *)obj->img_src;
+        return (lv_coord_t)(hor ? dsc->header.w : dsc->header.h);
+    }
+    return 0;
+}
+
+lv_coord_t lv_obj_get_width(const lv_obj_t *obj)
+{
+    return obj_size(obj, true);
+}
+
+lv_coord_t lv_obj_get_height(const lv_obj_t *obj)
+{
+    return obj_size(obj, false);
+}
+
+/* ---- snapshots ---- */
+
+static uint32_t snapshot_px_size(lv_img_cf_t cf)
+{
+    return cf == LV_IMG_CF_TRUE_COLOR_ALPHA ? sizeof(lv_color_t) + 1 : sizeof(lv_color_t);
+}
+
+uint32_t lv_snapshot_buf_size_needed(lv_obj_t *obj, lv_img_cf_t cf)
+{
+    return (uint32_t)lv_obj_get_width(obj) * lv_obj_get_height(obj) * snapshot_px_size(cf);
+}
+
+// Nothing is drawn: the buffer is cleared and the object's state recorded
+lv_res_t lv_snapshot_take_to_buf(lv_obj_t *obj, lv_img_cf_t cf, lv_img_dsc_t *dsc, void *buf, uint32_t buff_size)
+{
+    uint32_t size = lv_snapshot_buf_size_needed(obj, cf);
+    if (!size || buff_size < size) {
+        return LV_RES_INV;
+    }
+    memset(buf, 0, size);
+    memset(dsc, 0, sizeof(*dsc));
+    dsc->header.cf = cf;
+    dsc->header.w = (uint32_t)lv_obj_get_width(obj);
+    dsc->header.h = (uint32_t)lv_obj_get_height(obj);
+    dsc->data = (const uint8_t *)buf;
+    dsc->data_size = size;
+    obj->snapshots++;
+    obj->snapshot_state = obj->state;
+    stats.snapshots++;
+    return LV_RES_OK;
+}
+
+/* ---- events ---- */
+
+struct _lv_event_dsc_t *lv_obj_add_event_cb(lv_obj_t *obj, lv_event_cb_t event_cb, lv_event_code_t filter,
+                                            void *user_data)
+{
+    if (obj->event_cnt == LV_FAKE_EVENT_MAX) {
+        fprintf(stderr, "lvgl_fake: more than %d event callbacks\n", LV_FAKE_EVENT_MAX);
+        abort();
+    }
+    spec_attr_alloc(obj);
+    mem_charge(obj, array_cost(obj->event_cnt, obj->event_cnt + 1, MEM_EVENT_DSC));
+    lv_event_dsc_t *dsc = &obj->events[obj->event_cnt++];
+    dsc->cb = event_cb;
+    dsc->filter = filter;
+    dsc->user_data = user_data;
+    stats.event_cbs++;
+    return dsc;
+}
+
+bool lv_obj_remove_event_cb(lv_obj_t *obj, lv_event_cb_t event_cb)
+{
+    for (uint32_t i = 0; i < obj->event_cnt; i++) {
+        if (obj->events[i].cb == event_cb) {
+            memmove(&obj->events[i], &obj->events[i + 1], (obj->event_cnt - i - 1) * sizeof(obj->events[0]));
+            mem_charge(obj, array_cost(obj->event_cnt, obj->event_cnt - 1, MEM_EVENT_DSC));
+            obj->event_cnt--;
+            return true;
+        }
+    }
+    return false;
+}
+
+lv_res_t lv_event_send(lv_obj_t *obj, lv_event_code_t event_code, void *param)
+{
+    if (event_count < LV_FAKE_LOG_MAX) {
+        lv_fake_event_t *e = &events[event_count++];
+        e->target = obj;
+        e->code = event_code;
+        e->key = event_code == LV_EVENT_KEY && param ? *(uint32_t *)param : 0;
+    }
+    return obj_dispatch(obj, event_code, param);
+}
+
+uint32_t lv_fake_event_count(void)
+{
+    return event_count;
+}
+
+const lv_fake_event_t *lv_fake_event(uint32_t index)
+{
+    return index < event_count ? &events[index] : NULL;
+}
+
+uint32_t lv_fake_scr_loads(void)
+{
+    return scr_loads;
+}
+
+/* ---- timers ---- */
+
+lv_timer_t *lv_timer_create(lv_timer_cb_t timer_xcb, uint32_t period, void *user_data)
+{
+    for (uint32_t i = 0; i < FAKE_TIMERS; i++) {
+        if (!timer_used[i]) {
+            lv_timer_t *t = &timers[i];
+            memset(t, 0, sizeof(*t));
+            timer_used[i] = true;
+            t->timer_cb = timer_xcb;
+            t->period = period;
+            t->user_data = user_data;
+            t->repeat_count = -1;
+            t->last_run = lv_tick_get();
+            mem_charge(NULL, MEM_TIMER);
+            mem_blocks++;
+            return t;
+        }
+    }
+    return NULL;
+}
+
+void lv_timer_del(lv_timer_t *timer)
+{
+    uint32_t i = (uint32_t)(timer - timers);
+    if (i < FAKE_TIMERS && timer_used[i]) {
+        timer_used[i] = false;
+        mem_charge(NULL, -MEM_TIMER);
+        mem_blocks--;
+    }
+}
+
+void lv_timer_set_cb(lv_timer_t *timer, lv_timer_cb_t timer_cb)
+{
+    timer->timer_cb = timer_cb;
+}
+
+void lv_timer_set_period(lv_timer_t *timer, uint32_t period)
+{
+    timer->period = period;
+}
+
+void lv_timer_ready(lv_timer_t *timer)
+{
+    timer->last_run = lv_tick_get() - timer->period - 1;
+}
+
+void lv_timer_pause(lv_timer_t *timer)
+{
+    timer->paused = 1;
+}
+
+void lv_timer_resume(lv_timer_t *timer)
+{
+    timer->paused = 0;
+}
+
+// As LVGL's: run the timers whose period has elapsed, return the time to
+// the next one. Pending lv_obj_del_async() deletions run first.
+uint32_t lv_timer_handler(void)
+{
+    lv_fake_run_async();
+    for (uint32_t i = 0; i < FAKE_TIMERS; i++) {
+        lv_timer_t *t = &timers[i];
+        if (!timer_used[i] || t->paused || !t->timer_cb || lv_tick_get() - t->last_run < t->period) {
+            continue;
+        }
+        t->last_run = lv_tick_get();
+        t->timer_cb(t);
+        if (timer_used[i] && t->repeat_count > 0 && --t->repeat_count == 0) {
+            lv_timer_del(t);
+        }
+    }
+    uint32_t next = LV_NO_TIMER_READY;
+    uint32_t now = lv_tick_get();
+    for (uint32_t i = 0; i < FAKE_TIMERS; i++) {
+        lv_timer_t *t = &timers[i];
+        if (!timer_used[i] || t->paused || !t->timer_cb) {
+            continue;
+        }
+        uint32_t elapsed = now - t->last_run;
+        uint32_t remaining = elapsed >= t->period ? 0 : t->period - elapsed;
+        next = LV_MIN(next, remaining);
+    }
+    return next;
+}
+
+/* ---- groups and input devices ---- */
+
+lv_group_t *lv_group_create(void)
+{
+    mem_charge(NULL, 24 + MEM_HDR);
+    mem_blocks++;
+    return calloc(1, sizeof(lv_group_t));
+}
+
+static void group_focus(lv_group_t *group, lv_obj_t *obj)
+{
+    if (group->focused == obj) {
+        return;
+    }
+    lv_obj_t *old = group->focused;
+    group->focused = obj;
+    if (old) {
+        lv_obj_clear_state(old, LV_STATE_FOCUSED | LV_STATE_FOCUS_KEY | LV_STATE_EDITED);
+        obj_dispatch(old, LV_EVENT_DEFOCUSED, indev_act);
+    }
+    if (obj) {
+        // LVGL adds FOCUS_KEY when a keypad or encoder did the focusing
+        bool key = indev_act && indev_act->driver->type == LV_INDEV_TYPE_KEYPAD;
+        lv_obj_add_state(obj, LV_STATE_FOCUSED | (key ? LV_STATE_FOCUS_KEY : 0));
+        obj_dispatch(obj, LV_EVENT_FOCUSED, indev_act);
+    }
+}
+
+// The first object added takes the focus, as lv_group_refocus() does
+void lv_group_add_obj(lv_group_t *group, lv_obj_t *obj)
+{
+    if (obj->group == group) {
+        return;
+    }
+    if (obj->group) {
+        group_remove(obj);
+    }
+    if (group->obj_cnt == LV_FAKE_GROUP_MAX) {
+        fprintf(stderr, "lvgl_fake: more than %d objects in a group\n", LV_FAKE_GROUP_MAX);
+        abort();
+    }
+    group->objs[group->obj_cnt++] = obj;
+    obj->group = group;
+    mem_charge(obj, MEM_GROUP_NODE);
+    if (group->obj_cnt == 1) {
+        group_focus(group, obj);
+    }
+}
+
+// A focused object hands the focus to the next one, wrapping around
+static void group_remove(lv_obj_t *obj)
+{
+    lv_group_t *group = obj->group;
+    uint32_t i = 0;
+    while (i < group->obj_cnt && group->objs[i] != obj) {
+        i++;
+    }
+    if (i == group->obj_cnt) {
+        return;
+    }
+    if (group->focused == obj) {
+        group_focus(group, group->obj_cnt > 1 ? group->objs[(i + 1) % group->obj_cnt] : NULL);
+    }
+    memmove(&group->objs[i], &group->objs[i + 1], (group->obj_cnt - i - 1) * sizeof(group->objs[0]));
+    group->obj_cnt--;
+    obj->group = NULL;
+    mem_charge(obj, -MEM_GROUP_NODE);
+}
+
+void lv_group_remove_obj(lv_obj_t *obj)
+{
+    if (obj->group) {
+        group_remove(obj);
+    }
+}
+
+void lv_group_focus_obj(lv_obj_t *obj)
+{
+    focused = obj;
+    if (obj && obj->group) {
+        group_focus(obj->group, obj);
+    }
+}
+
+lv_obj_t *lv_group_get_focused(const lv_group_t *group)
+{
+    return group->focused;
+}
+
+lv_obj_t *lv_fake_focused(void)
+{
+    return focused;
+}
+
+void lv_indev_drv_init(lv_indev_drv_t *driver)
+{
+    memset(driver, 0, sizeof(*driver));
+    driver->type = LV_INDEV_TYPE_NONE;
+}
+
+// Reads the device as LVGL does, continue_reading included; the keys read
+// are not processed any further
+static void indev_read_timer_cb(lv_timer_t *timer)
+{
+    lv_indev_t *indev = (lv_indev_t *)timer->user_data;
+    lv_indev_data_t data;
+    indev_act = indev;
+    do {
+        memset(&data, 0, sizeof(data));
+        indev->driver->read_cb(indev->driver, &data);
+    } while (data.continue_reading);
+    indev_act = NULL;
+}
+
+lv_indev_t *lv_indev_drv_register(lv_indev_drv_t *driver)
+{
+    lv_indev_t *indev = calloc(1, sizeof(*indev));
+    indev->driver = driver;
+    driver->read_timer = lv_timer_create(indev_read_timer_cb, LV_INDEV_DEF_READ_PERIOD, indev);
+    mem_charge(NULL, 64 + MEM_HDR);
+    mem_blocks++;
+    return indev;
+}
+
+void lv_indev_set_group(lv_indev_t *indev, lv_group_t *group)
+{
+    indev->group = group;
+}
+
+/* ---- display ---- */
+
+void lv_disp_draw_buf_init(lv_disp_draw_buf_t *draw_buf, void *buf1, void *buf2, uint32_t size_in_px_cnt)
+{
+    memset(draw_buf, 0, sizeof(*draw_buf));
+    draw_buf->buf1 = buf1;
+    draw_buf->buf2 = buf2;
+    draw_buf->buf_act = buf1;
+    draw_buf->size = size_in_px_cnt;
+}
+
+void lv_disp_drv_init(lv_disp_drv_t *driver)
+{
+    memset(driver, 0, sizeof(*driver));
+    driver->hor_res = 320;
+    driver->ver_res = 240;
+}
+
+lv_disp_t *lv_fake_disp_create(lv_disp_drv_t *drv)
+{
+    if (fake_disp.refr_timer) {
+        lv_timer_del(fake_disp.refr_timer);
+    }
+    memset(&fake_disp, 0, sizeof(fake_disp));
+    fake_disp.driver = drv;
+    fake_disp.refr_timer = lv_timer_create(_lv_disp_refr_timer, LV_DISP_DEF_REFR_PERIOD, &fake_disp);
+    return &fake_disp;
+}
+
+// The display comes with its first screen loaded, as in LVGL
+lv_disp_t *lv_disp_drv_register(lv_disp_drv_t *driver)
+{
+    lv_disp_t *disp = lv_fake_disp_create(driver);
+    active_screen = lv_obj_create(NULL);
+    disp->act_scr = active_screen;
+    return disp;
+}
+
+lv_disp_t *lv_disp_get_default(void)
+{
+    return fake_disp.driver ? &fake_disp : NULL;
+}
+
+lv_timer_t *_lv_disp_get_refr_timer(lv_disp_t *disp)
+{
+    return disp->refr_timer;
+}
+
+// LVGL 8.3 lv_refr_join_area(): overlapping areas are joined when the union
+// is smaller than the two of them
+static void refr_join_area(lv_disp_t *disp)
+{
+    for (uint16_t in = 0; in < disp->inv_p; in++) {
+        if (disp->inv_area_joined[in]) {
+            continue;
+        }
+        for (uint16_t from = 0; from < disp->inv_p; from++) {
+            if (disp->inv_area_joined[from] || in == from ||
+                    !_lv_area_is_on(&disp->inv_areas[in], &disp->inv_areas[from])) {
+                continue;
+            }
+            lv_area_t joined;
+            _lv_area_join(&joined, &disp->inv_areas[in], &disp->inv_areas[from]);
+            if (lv_area_get_size(&joined) < lv_area_get_size(&disp->inv_areas[in]) +
+                    lv_area_get_size(&disp->inv_areas[from])) {
+                disp->inv_areas[in] = joined;
+                disp->inv_area_joined[from] = 1;
+            }
+        }
+    }
+}
+
+// LVGL waits on a draw buffer still being sent, calling wait_cb meanwhile
+static void draw_buf_wait(lv_disp_drv_t *drv)
+{
+    while (drv->draw_buf->flushing) {
+        stats.buf_waits++;
+        if (drv->wait_cb) {
+            drv->wait_cb(drv);
+        }
+    }
+}
+
+// LVGL 8.3 lv_refr_area() and draw_buf_flush(): an area taller than the
+// draw buffer is rendered and flushed in stripes of as many full rows as
+// fit. A single buffer is waited for before rendering into it, with two the
+// other one is waited for before flushing, then they swap.
+static void refr_area(lv_disp_t *disp, const lv_area_t *area)
+{
+    lv_disp_drv_t *drv = disp->driver;
+    lv_disp_draw_buf_t *buf = drv->draw_buf;
+    lv_coord_t h = lv_area_get_height(area);
+    lv_coord_t max_row = h;
+    if (buf && buf->size) {
+        uint32_t rows = buf->size / lv_area_get_width(area);
+        max_row = rows < (uint32_t)h ? (lv_coord_t)rows : h;
+    }
+    for (lv_coord_t y = area->y1; y <= area->y2; y += max_row) {
+        lv_area_t part = { area->x1, y, area->x2, LV_MIN(y + max_row - 1, area->y2) };
+        bool double_buf = buf && buf->buf1 && buf->buf2;
+        if (buf && buf->buf1 && !buf->buf2) {
+            draw_buf_wait(drv);
+        }
+        stats.rendered_px += lv_area_get_size(&part);
+        if (double_buf) {
+            draw_buf_wait(drv);
+        }
+        if (buf) {
+            buf->last_part = part.y2 == area->y2;
+            buf->flushing = 1;
+            buf->flushing_last = buf->last_area && buf->last_part;
+        }
+        stats.flushes++;
+        if (drv->flush_cb) {
+            drv->flush_cb(drv, &part, buf ? (lv_color_t *)buf->buf_act : NULL);
+        }
+        if (double_buf) {
+            buf->buf_act = buf->buf_act == buf->buf1 ? buf->buf2 : buf->buf1;
+        }
+    }
+}
+
+// Like LVGL's refresh: the timer pauses until something is invalidated,
+// join, flush every area not joined into another, forget them, then report
+// the time and pixels to monitor_cb
+void _lv_disp_refr_timer(lv_timer_t *timer)
+{
+    lv_disp_t *disp = (lv_disp_t *)timer->user_data;
+    lv_disp_drv_t *drv = disp->driver;
+    uint32_t start = lv_tick_get();
+    refr_count++;
+    lv_timer_pause(timer);
+    refr_join_area(disp);
+    int32_t last = -1;
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (!disp->inv_area_joined[i]) {
+            last = i;
+        }
+    }
+    uint32_t px = 0;
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (disp->inv_area_joined[i]) {
+            continue;
+        }
+        if (drv->draw_buf) {
+            drv->draw_buf->last_area = i == last;
+            drv->draw_buf->last_part = 0;
+        }
+        px += lv_area_get_size(&disp->inv_areas[i]);
+        refr_area(disp, &disp->inv_areas[i]);
+    }
+    memset(disp->inv_area_joined, 0, sizeof(disp->inv_area_joined));
+    disp->inv_p = 0;
+    if (px && drv->monitor_cb) {
+        drv->monitor_cb(drv, lv_tick_get() - start, px);
+    }
+}
+
+// The LVGL 8.3 invalidation: clip, round, drop areas already covered, and
+// wake the refresh timer
+void _lv_inv_area(lv_disp_t *disp, const lv_area_t *area_p)
+{
+    lv_area_t area = *area_p;
+    lv_area_t screen = { 0, 0, (lv_coord_t)(disp->driver->hor_res - 1), (lv_coord_t)(disp->driver->ver_res - 1) };
+    area.x1 = LV_MAX(area.x1, screen.x1);
+    area.y1 = LV_MAX(area.y1, screen.y1);
+    area.x2 = LV_MIN(area.x2, screen.x2);
+    area.y2 = LV_MIN(area.y2, screen.y2);
+    if (area.x1 > area.x2 || area.y1 > area.y2) {
+        return;
+    }
+    if (disp->driver->rounder_cb) {
+        disp->driver->rounder_cb(disp->driver, &area);
+    }
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (_lv_area_is_in(&area, &disp->inv_areas[i], 0)) {
+            return;
+        }
+    }
+    if (disp->inv_p < LV_INV_BUF_SIZE) {
+        disp->inv_areas[disp->inv_p++] = area;
+    } else {
+        disp->inv_p = 1;
+        disp->inv_areas[0] = screen;
+    }
+    if (disp->refr_timer) {
+        lv_timer_resume(disp->refr_timer);
+    }
+}
+
+void lv_disp_flush_ready(lv_disp_drv_t *disp_drv)
+{
+    if (disp_drv && disp_drv->draw_buf) {
+        disp_drv->draw_buf->flushing = 0;
+        disp_drv->draw_buf->flushing_last = 0;
+    }
+    flush_ready_count++;
+}
+
+bool lv_disp_flush_is_last(lv_disp_drv_t *disp_drv)
+{
+    return disp_drv->draw_buf->flushing_last;
+}
+
+uint32_t lv_fake_flush_ready_count(void)
+{
+    return flush_ready_count;
+}
+
+uint32_t lv_fake_refr_count(void)
+{
+    return refr_count;
+}
+
+void lv_fake_get_stats(lv_fake_stats_t *out)
+{
+    *out = stats;
+}
+
+void lv_fake_reset(void)
+{
+    event_count = 0;
+    scr_loads = 0;
+    async_count = 0;
+    flush_ready_count = 0;
+    refr_count = 0;
+    focused = NULL;
+    uint32_t live = stats.live_objects;
+    memset(&stats, 0, sizeof(stats));
+    stats.live_objects = live;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file      lvgl_fake.h
+ * @license   MIT
+ *
+ * What the fake LVGL saw: objects carry their tree, state, styles, event
+ * callbacks and the last values set on them, events sent and screen loads
+ * are logged in order. Objects are charged to a model of the LVGL heap
+ * (lvgl_fake.c) that lv_mem_monitor() reports.
+ */
+#pragma once
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LV_FAKE_TEXT_MAX    64
+#define LV_FAKE_LOG_MAX     256
+#define LV_FAKE_CHILD_MAX   32
+#define LV_FAKE_EVENT_MAX   8
+#define LV_FAKE_STYLE_MAX   12
+#define LV_FAKE_GROUP_MAX   32
+#define LV_FAKE_MEM_SIZE    (48 * 1024)     // CONFIG_LV_MEM_SIZE_KILOBYTES
+
+typedef enum {
+    LV_FAKE_OBJ,
+    LV_FAKE_BTN,
+    LV_FAKE_LABEL,
+    LV_FAKE_IMG,
+} lv_fake_type_t;
+
+typedef struct _lv_event_dsc_t {
+    lv_event_cb_t   cb;
+    void            *user_data;
+    lv_event_code_t filter;
+} lv_event_dsc_t;
+
+// An added style, or with style NULL the object's local style for selector
+typedef struct {
+    const lv_style_t *style;
+    lv_style_selector_t selector;
+    lv_style_t      local;
+} lv_fake_obj_style_t;
+
+struct _lv_obj_t {
+    lv_obj_t        *parent;
+    bool            valid;
+    lv_color_t      bg_color;
+    uint32_t        bg_color_sets;
+    char            text[LV_FAKE_TEXT_MAX];
+    lv_fake_type_t  type;
+    lv_state_t      state;
+    uint32_t        flags;
+    lv_obj_t        *children[LV_FAKE_CHILD_MAX];
+    uint32_t        child_cnt;
+    lv_event_dsc_t  events[LV_FAKE_EVENT_MAX];
+    uint32_t        event_cnt;
+    // in LVGL's lookup order: local styles, then added ones, newest first
+    lv_fake_obj_style_t styles[LV_FAKE_STYLE_MAX];
+    uint32_t        style_cnt;
+    lv_group_t      *group;
+    const void      *img_src;
+    uint32_t        text_mem;           // heap copy of a label's text, 0 when static
+    uint32_t        snapshots;
+    lv_state_t      snapshot_state;     // state of the last snapshot
+    bool            spec_attr;          // LVGL's lazily allocated children/events block
+    uint32_t        mem;                // LVGL heap charged to the object
+};
+
+struct _lv_group_t {
+    lv_obj_t        *objs[LV_FAKE_GROUP_MAX];
+    uint32_t        obj_cnt;
+    lv_obj_t        *focused;
+};
+
+typedef struct {
+    lv_obj_t        *target;
+    lv_event_code_t code;
+    uint32_t        key;            // LV_EVENT_KEY only
+} lv_fake_event_t;
+
+typedef struct {
+    uint32_t        objects;        // created
+    uint32_t        live_objects;
+    uint32_t        local_props;    // local style properties written
+    uint32_t        local_styles;   // local style blocks allocated (one per selector)
+    uint32_t        styles_added;   // lv_obj_add_style()
+    uint32_t        event_cbs;      // lv_obj_add_event_cb()
+    uint32_t        snapshots;
+    uint32_t        flushes;        // flush_cb calls
+    uint64_t        rendered_px;    // pixels "rendered" into draw buffers
+    uint32_t        buf_waits;      // wait_cb calls made waiting for a draw buffer
+} lv_fake_stats_t;
+
+// Events sent with lv_event_send(), oldest first. Events LVGL raises itself
+// (DELETE, FOCUSED, DEFOCUSED) reach the callbacks but are not logged.
+uint32_t lv_fake_event_count(void);
+const lv_fake_event_t *lv_fake_event(uint32_t index);
+
+uint32_t lv_fake_scr_loads(void);
+
+// Completes lv_obj_del_async() deletions, as the next lv_timer_handler() would
+void lv_fake_run_async(void);
+
+// Last object given to lv_group_focus_obj()
+lv_obj_t *lv_fake_focused(void);
+
+// The display the refresh timer and flush_ready go to
+lv_disp_t *lv_fake_disp_create(lv_disp_drv_t *drv);
+uint32_t lv_fake_flush_ready_count(void);
+// Calls made to _lv_disp_refr_timer(), with the areas it saw
+uint32_t lv_fake_refr_count(void);
+
+void lv_fake_get_stats(lv_fake_stats_t *stats);
+
+// Clears the logs and the counters; objects and the heap model are kept
+void lv_fake_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
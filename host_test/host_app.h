@@ -0,0 +1,50 @@
+/**
+ * @file      host_app.h
+ * @license   MIT
+ *
+ * app_main() for the host: the same start-up as main.cpp with the board
+ * peripherals simulated. The joystick answers at rest with the button up,
+ * the PMU is absent and deep sleep is not armed.
+ */
+#pragma once
+#include "esp_err.h"
+#include "nvs_flash.h"
+#include "host_mock.h"
+#include "lvgl.h"
+#include "amoled_driver.h"
+#include "display_headless.h"
+#include "i2c_driver.h"
+#include "i2c_bus_manager.h"
+#include "power_driver.h"
+#include "lvgl_config.h"
+#include "button_config.h"
+#include "joystick_config.h"
+#include "relay_config.h"
+
+#define HOST_JOYSTICK_ADDR  0x20
+
+static inline void host_app_start(void)
+{
+    i2c_master_bus_handle_t i2c_bus;
+    uint8_t *joystick = host_i2c_add(HOST_JOYSTICK_ADDR);
+    joystick[0x03] = 0x80;          // X at JOYSTICK_AXIS_MID
+    joystick[0x05] = 0x80;          // Y
+    joystick[0x07] = 1;             // button released
+
+    ESP_ERROR_CHECK(nvs_flash_init());
+    ESP_ERROR_CHECK(i2c_driver_init(&i2c_bus));
+    ESP_ERROR_CHECK(i2c_bus_manager_init(i2c_bus));
+    power_driver_init();
+    display_init();
+    lv_init();
+    lvgl_config();
+    if (lvgl_lock(-1)) {
+        config_gui();
+        lvgl_unlock();
+    }
+    button_config();
+    lvgl_go();
+    button_go();
+    joystick_go();
+    relay_config();
+}
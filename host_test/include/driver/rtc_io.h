@@ -0,0 +1,12 @@
+/**
+ * @file      rtc_io.h
+ * @license   MIT
+ */
+#pragma once
+#include "driver/gpio.h"
+
+static inline esp_err_t rtc_gpio_pulldown_en(gpio_num_t gpio_num)
+{
+    (void)gpio_num;
+    return ESP_OK;
+}
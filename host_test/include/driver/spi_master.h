@@ -0,0 +1,114 @@
+/**
+ * @file      spi_master.h
+ * @license   MIT
+ *
+ * Host stand-in for the SPI master driver. Transactions are recorded and fed
+ * to a model of the panel (host_mock.h). Queued transactions stay on the
+ * "wire" until the test lets them complete or the driver collects them; the
+ * pre/post callbacks run in simulated ISR context.
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+} spi_host_device_t;
+
+#define SPI_DMA_CH_AUTO                 3
+
+#define SPICOMMON_BUSFLAG_MASTER        (1 << 0)
+#define SPICOMMON_BUSFLAG_GPIO_PINS     (1 << 2)
+
+#define SPI_DEVICE_HALFDUPLEX           (1 << 4)
+
+#define SPI_TRANS_MODE_DIO              (1 << 0)
+#define SPI_TRANS_MODE_QIO              (1 << 1)
+#define SPI_TRANS_USE_RXDATA            (1 << 2)
+#define SPI_TRANS_USE_TXDATA            (1 << 3)
+#define SPI_TRANS_MODE_DIOQIO_ADDR      (1 << 4)
+#define SPI_TRANS_VARIABLE_CMD          (1 << 5)
+#define SPI_TRANS_VARIABLE_ADDR         (1 << 6)
+#define SPI_TRANS_VARIABLE_DUMMY        (1 << 7)
+#define SPI_TRANS_CS_KEEP_ACTIVE        (1 << 8)
+#define SPI_TRANS_MULTILINE_CMD         (1 << 9)
+#define SPI_TRANS_MODE_OCT              (1 << 10)
+#define SPI_TRANS_MULTILINE_ADDR        SPI_TRANS_MODE_DIOQIO_ADDR
+
+typedef struct {
+    int data0_io_num;
+    int data1_io_num;
+    int sclk_io_num;
+    int data2_io_num;
+    int data3_io_num;
+    int data4_io_num;
+    int data5_io_num;
+    int data6_io_num;
+    int data7_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+} spi_bus_config_t;
+
+typedef struct spi_transaction_t spi_transaction_t;
+typedef void (*transaction_cb_t)(spi_transaction_t *trans);
+
+typedef struct {
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    int clock_speed_hz;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+struct spi_transaction_t {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;          // bits
+    size_t rxlength;
+    void *user;
+    union {
+        const void *tx_buffer;
+        uint8_t tx_data[4];
+    };
+    union {
+        void *rx_buffer;
+        uint8_t rx_data[4];
+    };
+};
+
+typedef struct {
+    struct spi_transaction_t base;
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+} spi_transaction_ext_t;
+
+typedef struct spi_device_t *spi_device_handle_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, int dma_chan);
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config,
+                             spi_device_handle_t *handle);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc,
+                                      TickType_t ticks_to_wait);
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc);
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc);
+
+#ifdef __cplusplus
+}
+#endif
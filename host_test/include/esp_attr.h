@@ -0,0 +1,11 @@
+/**
+ * @file      esp_attr.h
+ * @license   MIT
+ *
+ * Host stand-in: there is no IRAM, the placement attributes are empty.
+ */
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define FORCE_INLINE_ATTR   static inline __attribute__((always_inline))
@@ -0,0 +1,50 @@
+/**
+ * @file      FreeRTOS.h
+ * @license   MIT
+ *
+ * Host stand-in for the FreeRTOS kernel on pthreads: tasks are threads, the
+ * tick is 1 ms of the monotonic clock and "ISR context" is a per-thread flag
+ * the mocks set while they run driver callbacks.
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFALSE                 ((BaseType_t)0)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ      CONFIG_FREERTOS_HZ
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTICKS_TO_MS(ticks)    ((TickType_t)(((uint64_t)(ticks) * 1000) / configTICK_RATE_HZ))
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES
+
+#define portYIELD_FROM_ISR(...) do { } while (0)
+
+BaseType_t xPortInIsrContext(void);
+
+// The host scheduler never needs a yield from an ISR
+static inline void host_isr_no_yield(BaseType_t *woken)
+{
+    if (woken) {
+        *woken = pdFALSE;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
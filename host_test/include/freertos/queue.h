@@ -0,0 +1,31 @@
+/**
+ * @file      queue.h
+ * @license   MIT
+ */
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueGenericSend(QueueHandle_t queue, const void *item, TickType_t ticks, bool front);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define xQueueSend(queue, item, ticks)          xQueueGenericSend((queue), (item), (ticks), false)
+#define xQueueSendToBack(queue, item, ticks)    xQueueGenericSend((queue), (item), (ticks), false)
+#define xQueueSendToFront(queue, item, ticks)   xQueueGenericSend((queue), (item), (ticks), true)
+#define xQueueSendFromISR(queue, item, woken) \
+    (host_isr_no_yield(woken), xQueueGenericSend((queue), (item), 0, false))
+#define xQueueReceiveFromISR(queue, item, woken) \
+    (host_isr_no_yield(woken), xQueueReceive((queue), (item), 0))
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,41 @@
+/**
+ * @file      semphr.h
+ * @license   MIT
+ */
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+typedef struct {
+    void *dummy[8];
+} StaticSemaphore_t;
+
+SemaphoreHandle_t host_semaphore_create(int kind, UBaseType_t max_count, UBaseType_t initial);
+BaseType_t host_semaphore_take(SemaphoreHandle_t sem, TickType_t ticks, bool recursive);
+BaseType_t host_semaphore_give(SemaphoreHandle_t sem, bool recursive);
+
+#define HOST_SEM_COUNTING   0
+#define HOST_SEM_MUTEX      1
+
+#define xSemaphoreCreateBinary()                host_semaphore_create(HOST_SEM_COUNTING, 1, 0)
+#define xSemaphoreCreateBinaryStatic(buf)       ((void)(buf), host_semaphore_create(HOST_SEM_COUNTING, 1, 0))
+#define xSemaphoreCreateCounting(max, initial)  host_semaphore_create(HOST_SEM_COUNTING, (max), (initial))
+#define xSemaphoreCreateMutex()                 host_semaphore_create(HOST_SEM_MUTEX, 1, 1)
+#define xSemaphoreCreateRecursiveMutex()        host_semaphore_create(HOST_SEM_MUTEX, 1, 1)
+#define xSemaphoreTake(sem, ticks)              host_semaphore_take((sem), (ticks), false)
+#define xSemaphoreTakeRecursive(sem, ticks)     host_semaphore_take((sem), (ticks), true)
+#define xSemaphoreGive(sem)                     host_semaphore_give((sem), false)
+#define xSemaphoreGiveRecursive(sem)            host_semaphore_give((sem), true)
+#define xSemaphoreGiveFromISR(sem, woken)       (host_isr_no_yield(woken), host_semaphore_give((sem), false))
+#define xSemaphoreTakeFromISR(sem, woken)       (host_isr_no_yield(woken), host_semaphore_take((sem), 0, false))
+#define vSemaphoreDelete(sem)                   vQueueDelete(sem)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file      task.h
+ * @license   MIT
+ */
+#pragma once
+#include <sched.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define tskIDLE_PRIORITY        ((UBaseType_t)0)
+#define tskNO_AFFINITY          ((BaseType_t)0x7FFFFFFF)
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *created_task);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+#define taskYIELD()             ((void)sched_yield())
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, UBaseType_t index, uint32_t value, eNotifyAction action,
+                              uint32_t *previous_value);
+BaseType_t xTaskGenericNotifyWait(UBaseType_t index, uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                  uint32_t *value, TickType_t ticks);
+uint32_t ulTaskGenericNotifyTake(UBaseType_t index, BaseType_t clear_on_exit, TickType_t ticks);
+
+#define xTaskNotify(task, value, action) \
+    xTaskGenericNotify((task), 0, (value), (action), NULL)
+#define xTaskNotifyIndexed(task, index, value, action) \
+    xTaskGenericNotify((task), (index), (value), (action), NULL)
+#define xTaskNotifyFromISR(task, value, action, woken) \
+    (host_isr_no_yield(woken), xTaskGenericNotify((task), 0, (value), (action), NULL))
+#define xTaskNotifyIndexedFromISR(task, index, value, action, woken) \
+    (host_isr_no_yield(woken), xTaskGenericNotify((task), (index), (value), (action), NULL))
+#define xTaskNotifyGive(task) \
+    xTaskGenericNotify((task), 0, 0, eIncrement, NULL)
+#define xTaskNotifyGiveIndexed(task, index) \
+    xTaskGenericNotify((task), (index), 0, eIncrement, NULL)
+#define vTaskNotifyGiveFromISR(task, woken) \
+    do { host_isr_no_yield(woken); xTaskGenericNotify((task), 0, 0, eIncrement, NULL); } while (0)
+#define vTaskNotifyGiveIndexedFromISR(task, index, woken) \
+    do { host_isr_no_yield(woken); xTaskGenericNotify((task), (index), 0, eIncrement, NULL); } while (0)
+#define xTaskNotifyWait(clear_on_entry, clear_on_exit, value, ticks) \
+    xTaskGenericNotifyWait(0, (clear_on_entry), (clear_on_exit), (value), (ticks))
+#define xTaskNotifyWaitIndexed(index, clear_on_entry, clear_on_exit, value, ticks) \
+    xTaskGenericNotifyWait((index), (clear_on_entry), (clear_on_exit), (value), (ticks))
+#define ulTaskNotifyTake(clear_on_exit, ticks) \
+    ulTaskGenericNotifyTake(0, (clear_on_exit), (ticks))
+#define ulTaskNotifyTakeIndexed(index, clear_on_exit, ticks) \
+    ulTaskGenericNotifyTake((index), (clear_on_exit), (ticks))
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+/**
+ * @file      gpio_ll.h
+ * @license   MIT
+ *
+ * Host stand-in for the GPIO low level layer. On the target these are inline
+ * register writes that stay usable with the flash cache disabled; here they
+ * set the pin store and check that callers in ISR context used them.
+ */
+#pragma once
+#include <stdint.h>
+#include "hal/gpio_types.h"
+#include "soc/gpio_struct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIO_LL_GET_HW(num) (((num) == GPIO_PORT_0) ? (&GPIO) : NULL)
+
+void host_gpio_ll_set_level(uint32_t gpio_num, uint32_t level);
+
+static inline void gpio_ll_set_level(gpio_dev_t *hw, uint32_t gpio_num, uint32_t level)
+{
+    (void)hw;
+    host_gpio_ll_set_level(gpio_num, level);
+}
+
+#ifdef __cplusplus
+}
+#endif
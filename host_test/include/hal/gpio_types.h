@@ -0,0 +1,10 @@
+/**
+ * @file      gpio_types.h
+ * @license   MIT
+ */
+#pragma once
+
+typedef enum {
+    GPIO_PORT_0 = 0,
+    GPIO_PORT_MAX,
+} gpio_port_t;
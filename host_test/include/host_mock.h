@@ -0,0 +1,94 @@
+/**
+ * @file      host_mock.h
+ * @license   MIT
+ *
+ * Test-side controls of the host stand-ins: GPIO inputs, the SPI panel model,
+ * the I2C register files, NVS and heap failure injection.
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Simulated interrupt context, seen by xPortInIsrContext() on this thread */
+void host_isr_enter(void);
+void host_isr_exit(void);
+
+/* Calls that are not allowed from ISR context on the target (flash code with
+ * the cache disabled) bump this counter when made from a simulated ISR */
+uint32_t host_isr_violations(void);
+void host_isr_violation(const char *what);
+
+/* ---- GPIO ---- */
+
+// Drive an input; runs the pin's ISR handler in ISR context on a matching edge
+void host_gpio_set_input(gpio_num_t gpio_num, int level);
+int host_gpio_level(gpio_num_t gpio_num);
+uint32_t host_gpio_writes(gpio_num_t gpio_num);         // set_level calls
+uint32_t host_gpio_transitions(gpio_num_t gpio_num);    // level changes by writes
+void host_gpio_reset(void);
+
+/* ---- SPI panel model ---- */
+
+typedef struct host_spi_record {
+    uint32_t        seq;            // order on the wire
+    uint16_t        cmd;
+    uint32_t        addr;
+    uint32_t        flags;
+    uint32_t        bytes;          // command, address and data
+    bool            queued;         // spi_device_queue_trans(), not polling
+    bool            cs_low;         // CS asserted while on the wire
+    int64_t         queued_us;
+    int64_t         done_us;
+} host_spi_record_t;
+
+// Panel memory of width x height RGB565 pixels (as sent, byte swapped)
+void host_panel_init(uint16_t width, uint16_t height);
+// Data only reaches the panel while this pin is low
+void host_spi_set_cs_pin(int gpio_num);
+const uint16_t *host_panel_ram(void);
+uint8_t host_panel_madctl(void);
+// From now on MADCTL values other than upright rotate and mirror the
+// addressing; by default MADCTL is only recorded
+void host_panel_follow_madctl(uint8_t upright);
+
+uint32_t host_spi_count(void);
+const host_spi_record_t *host_spi_get(uint32_t index);
+uint64_t host_spi_wire_bytes(void);
+void host_spi_clear(void);
+
+// Queued transactions not yet on the wire
+uint32_t host_spi_pending(void);
+// Let up to count queued transactions finish, as the DMA would; returns how many did
+uint32_t host_spi_complete(uint32_t count);
+// Queued transactions finish on their own from a background thread
+void host_spi_autocomplete(bool on);
+
+/* ---- I2C register files ---- */
+
+uint8_t *host_i2c_add(uint16_t address);                // the device's 256 registers
+void host_i2c_set_latency(uint16_t address, uint32_t us);   // bus time per transfer
+uint32_t host_i2c_transfers(uint16_t address);
+uint32_t host_i2c_bytes_read(uint16_t address);
+uint32_t host_i2c_overlaps(void);                       // transfers that ran concurrently
+void host_i2c_reset(void);
+
+/* ---- NVS ---- */
+
+uint32_t host_nvs_commits(void);
+uint32_t host_nvs_writes(void);                         // set_blob calls
+void host_nvs_reset(void);                              // erase everything
+
+/* ---- heap ---- */
+
+// The next count allocations asking for any of caps fail
+void host_heap_fail(uint32_t caps, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
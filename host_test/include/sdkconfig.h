@@ -0,0 +1,42 @@
+/**
+ * @file      sdkconfig.h
+ * @license   MIT
+ *
+ * Host build configuration: the project defaults (sdkconfig) for the
+ * T-Display-S3 AMOLED Touch. Options a test flips are left to the test
+ * target's compile definitions, booleans stay undefined when off as with
+ * Kconfig.
+ */
+#pragma once
+
+#define CONFIG_IDF_TARGET_LINUX                 1
+#define CONFIG_LILYGO_T_DISPLAY_S3_AMOLED_TOUCH 1
+
+#define CONFIG_AMOLED_QUEUED_DMA                1
+#ifndef CONFIG_AMOLED_HW_ROTATION
+#define CONFIG_AMOLED_HW_ROTATION               1
+#endif
+#ifndef CONFIG_AMOLED_DELTA_FULL_PERCENT
+#define CONFIG_AMOLED_DELTA_FULL_PERCENT        70
+#endif
+#ifndef CONFIG_FRAME_PROFILER_DUMP_MS
+#define CONFIG_FRAME_PROFILER_DUMP_MS           0
+#endif
+
+#define CONFIG_SCREEN_MEM_BUDGET_KB             24
+#ifndef CONFIG_RENDER_CACHE
+#define CONFIG_RENDER_CACHE                     1
+#endif
+
+#define CONFIG_JOYSTICK_BURST_READ              1
+#define CONFIG_JOYSTICK_ACTIVE_HZ               200
+#define CONFIG_JOYSTICK_IDLE_HZ                 20
+#define CONFIG_JOYSTICK_IDLE_AFTER_MS           500
+#define CONFIG_JOYSTICK_DEADZONE                120
+#define CONFIG_JOYSTICK_FILTER_SHIFT            2
+
+#define CONFIG_LVGL_MEM_ARENA_KB                32
+#define CONFIG_LVGL_MEM_PSRAM_THRESHOLD         4096
+
+#define CONFIG_FREERTOS_HZ                      1000
+#define CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES 2
@@ -0,0 +1,9 @@
+/**
+ * @file      clk_tree_defs.h
+ * @license   MIT
+ */
+#pragma once
+
+typedef enum {
+    I2C_CLK_SRC_DEFAULT = 0,
+} i2c_clock_source_t;
@@ -0,0 +1,14 @@
+/**
+ * @file      gpio_struct.h
+ * @license   MIT
+ *
+ * Host stand-in for the GPIO register block; the low level calls go to the
+ * same pin store as the driver.
+ */
+#pragma once
+
+typedef struct gpio_dev {
+    int unused;
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
@@ -0,0 +1,51 @@
+/**
+ * @file      lv_conf.h
+ * @license   MIT
+ *
+ * LVGL 8.3 configuration for the host GUI targets, mirroring the LVGL part
+ * of the project sdkconfig. Options not set here keep LVGL's defaults.
+ */
+#pragma once
+
+#define LV_COLOR_DEPTH                  16
+#define LV_COLOR_16_SWAP                1
+
+#define LV_MEM_CUSTOM                   1
+#define LV_MEM_CUSTOM_INCLUDE           "lvgl_mem.h"
+#define LV_MEM_BUF_MAX_NUM              16
+
+#define LV_DISP_DEF_REFR_PERIOD         30
+#define LV_INDEV_DEF_READ_PERIOD        30
+#define LV_TICK_CUSTOM                  1
+#define LV_TICK_CUSTOM_INCLUDE          "esp_timer.h"
+#define LV_TICK_CUSTOM_SYS_TIME_EXPR    (esp_timer_get_time() / 1000LL)
+#define LV_DPI_DEF                      130
+
+#define LV_DRAW_COMPLEX                 1
+#define LV_SHADOW_CACHE_SIZE            0
+#define LV_CIRCLE_CACHE_SIZE            4
+#define LV_LAYER_SIMPLE_BUF_SIZE        (24 * 1024)
+#define LV_IMG_CACHE_DEF_SIZE           0
+#define LV_GRADIENT_MAX_STOPS           2
+#define LV_GRAD_CACHE_DEF_SIZE          0
+#define LV_DISP_ROT_MAX_BUF             (10 * 1024)
+
+#define LV_USE_LOG                      0
+#define LV_USE_ASSERT_NULL              1
+#define LV_USE_ASSERT_MALLOC            1
+#define LV_USE_PERF_MONITOR             0
+#define LV_USE_MEM_MONITOR              0
+#define LV_USE_USER_DATA                1
+
+#define LV_FONT_MONTSERRAT_14           1
+#define LV_FONT_DEFAULT                 &lv_font_montserrat_14
+
+#define LV_USE_THEME_DEFAULT            1
+#define LV_THEME_DEFAULT_DARK           0
+#define LV_THEME_DEFAULT_GROW           1
+#define LV_THEME_DEFAULT_TRANSITION_TIME 80
+#define LV_USE_THEME_BASIC              1
+
+#define LV_USE_FLEX                     1
+#define LV_USE_GRID                     1
+#define LV_USE_SNAPSHOT                 1
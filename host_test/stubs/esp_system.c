@@ -0,0 +1,257 @@
+/**
+ * @file      esp_system.c
+ * @license   MIT
+ *
+ * Logging, error names, the capability heap and NVS for the host build.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "nvs_flash.h"
+#include "host_mock.h"
+
+/* ---- log ---- */
+
+static esp_log_level_t log_level(void)
+{
+    static int level = -1;
+    if (level < 0) {
+        const char *env = getenv("HOST_LOG");
+        level = ESP_LOG_WARN;
+        if (env && !strcmp(env, "info")) {
+            level = ESP_LOG_INFO;
+        } else if (env && !strcmp(env, "debug")) {
+            level = ESP_LOG_VERBOSE;
+        } else if (env && !strcmp(env, "none")) {
+            level = ESP_LOG_NONE;
+        }
+    }
+    return (esp_log_level_t)level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char letters[] = "NEWIDV";
+    if (level > log_level()) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    flockfile(stderr);
+    fprintf(stderr, "%c (%s) ", letters[level], tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    funlockfile(stderr);
+    va_end(args);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+    default: return "UNKNOWN ERROR";
+    }
+}
+
+/* ---- heap ---- */
+
+static uint32_t fail_caps;
+static uint32_t fail_count;
+
+void host_heap_fail(uint32_t caps, uint32_t count)
+{
+    fail_caps = caps;
+    fail_count = count;
+}
+
+static bool heap_should_fail(uint32_t caps)
+{
+    if (fail_count && (caps & fail_caps)) {
+        fail_count--;
+        return true;
+    }
+    return false;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return heap_should_fail(caps) ? NULL : malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    return heap_should_fail(caps) ? NULL : calloc(n, size);
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps)
+{
+    return heap_should_fail(caps) ? NULL : realloc(ptr, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return caps & MALLOC_CAP_SPIRAM ? 8 * 1024 * 1024 : 256 * 1024;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+/* ---- NVS ---- */
+
+#define NVS_MAX_ENTRIES     16
+#define NVS_MAX_BLOB        256
+
+typedef struct {
+    char        ns[16];
+    char        key[16];
+    size_t      len;
+    uint8_t     data[NVS_MAX_BLOB];
+} nvs_entry_t;
+
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static nvs_entry_t nvs_entries[NVS_MAX_ENTRIES];
+static char nvs_namespaces[8][16];
+static uint32_t nvs_commit_count;
+static uint32_t nvs_write_count;
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    host_nvs_reset();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    (void)open_mode;
+    pthread_mutex_lock(&nvs_lock);
+    for (int i = 0; i < 8; i++) {
+        if (!nvs_namespaces[i][0] || !strcmp(nvs_namespaces[i], name)) {
+            strncpy(nvs_namespaces[i], name, 15);
+            *out_handle = i + 1;
+            pthread_mutex_unlock(&nvs_lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_ERR_NVS_NO_FREE_PAGES;
+}
+
+static nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key, bool create)
+{
+    const char *ns = nvs_namespaces[handle - 1];
+    nvs_entry_t *unused = NULL;
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        nvs_entry_t *e = &nvs_entries[i];
+        if (!e->key[0]) {
+            unused = unused ? unused : e;
+        } else if (!strcmp(e->ns, ns) && !strcmp(e->key, key)) {
+            return e;
+        }
+    }
+    if (create && unused) {
+        strncpy(unused->ns, ns, 15);
+        strncpy(unused->key, key, 15);
+        return unused;
+    }
+    return NULL;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&nvs_lock);
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    if (!e) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (!out_value) {
+        *length = e->len;
+    } else if (*length < e->len) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out_value, e->data, e->len);
+        *length = e->len;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    if (length > NVS_MAX_BLOB) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    pthread_mutex_lock(&nvs_lock);
+    nvs_entry_t *e = nvs_find(handle, key, true);
+    if (e) {
+        memcpy(e->data, value, length);
+        e->len = length;
+        nvs_write_count++;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return e ? ESP_OK : ESP_ERR_NVS_NO_FREE_PAGES;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    pthread_mutex_lock(&nvs_lock);
+    nvs_commit_count++;
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+uint32_t host_nvs_commits(void)
+{
+    return nvs_commit_count;
+}
+
+uint32_t host_nvs_writes(void)
+{
+    return nvs_write_count;
+}
+
+void host_nvs_reset(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    memset(nvs_entries, 0, sizeof(nvs_entries));
+    nvs_commit_count = 0;
+    nvs_write_count = 0;
+    pthread_mutex_unlock(&nvs_lock);
+}
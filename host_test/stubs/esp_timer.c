@@ -0,0 +1,192 @@
+/**
+ * @file      esp_timer.c
+ * @license   MIT
+ *
+ * esp_timer on the monotonic clock with one dispatch thread.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "esp_timer.h"
+
+#define TIMER_MAX   16
+
+struct esp_timer {
+    esp_timer_cb_t  callback;
+    void            *arg;
+    bool            active;
+    uint64_t        period_us;      // 0 for one-shot
+    int64_t         alarm_us;
+};
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_cond;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+static struct esp_timer *timers[TIMER_MAX];
+static int64_t start_ns;
+
+static int64_t clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// like the target, time counts from start-up
+__attribute__((constructor)) static void timer_clock_init(void)
+{
+    start_ns = clock_ns();
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (clock_ns() - start_ns) / 1000;
+}
+
+static void *timer_dispatch(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&timer_lock);
+    while (1) {
+        struct esp_timer *next = NULL;
+        for (int i = 0; i < TIMER_MAX; i++) {
+            struct esp_timer *t = timers[i];
+            if (t && t->active && (!next || t->alarm_us < next->alarm_us)) {
+                next = t;
+            }
+        }
+        if (!next) {
+            pthread_cond_wait(&timer_cond, &timer_lock);
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        if (next->alarm_us > now) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            int64_t wait_ns = (next->alarm_us - now) * 1000;
+            ts.tv_sec += wait_ns / 1000000000LL;
+            ts.tv_nsec += wait_ns % 1000000000LL;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&timer_cond, &timer_lock, &ts);
+            continue;
+        }
+        if (next->period_us) {
+            next->alarm_us += next->period_us;
+            if (next->alarm_us < now) {
+                next->alarm_us = now + next->period_us;
+            }
+        } else {
+            next->active = false;
+        }
+        esp_timer_cb_t cb = next->callback;
+        void *cb_arg = next->arg;
+        pthread_mutex_unlock(&timer_lock);
+        cb(cb_arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    return NULL;
+}
+
+static void timer_init(void)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timer_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_t thread;
+    pthread_create(&thread, NULL, timer_dispatch, NULL);
+    pthread_detach(thread);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    pthread_once(&timer_once, timer_init);
+    struct esp_timer *t = calloc(1, sizeof(*t));
+    if (!t) {
+        return ESP_ERR_NO_MEM;
+    }
+    t->callback = args->callback;
+    t->arg = args->arg;
+    pthread_mutex_lock(&timer_lock);
+    for (int i = 0; i < TIMER_MAX; i++) {
+        if (!timers[i]) {
+            timers[i] = t;
+            pthread_mutex_unlock(&timer_lock);
+            *out_handle = t;
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&timer_lock);
+    free(t);
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t timer_arm(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us, bool restart)
+{
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&timer_lock);
+    if (timer->active != restart) {
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        timer->active = true;
+        timer->period_us = period_us;
+        timer->alarm_us = esp_timer_get_time() + (int64_t)timeout_us;
+        pthread_cond_signal(&timer_cond);
+    }
+    pthread_mutex_unlock(&timer_lock);
+    return err;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_arm(timer, timeout_us, 0, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return timer_arm(timer, period, period, false);
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    uint64_t period = timer->period_us ? timeout_us : 0;
+    return timer_arm(timer, timeout_us, period, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&timer_lock);
+    if (!timer->active) {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    pthread_mutex_unlock(&timer_lock);
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer_lock);
+    for (int i = 0; i < TIMER_MAX; i++) {
+        if (timers[i] == timer) {
+            timers[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&timer_lock);
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer_lock);
+    bool active = timer->active;
+    pthread_mutex_unlock(&timer_lock);
+    return active;
+}
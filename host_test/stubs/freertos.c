@@ -0,0 +1,424 @@
+/**
+ * @file      freertos.c
+ * @license   MIT
+ *
+ * FreeRTOS on pthreads. All kernel objects share one lock and one condition
+ * variable: the host runs few tasks and this keeps every wait simple.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "host_mock.h"
+
+struct host_task {
+    pthread_t       thread;
+    TaskFunction_t  fn;
+    void            *arg;
+    char            name[16];
+    uint32_t        value[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+    bool            pending[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+};
+
+struct host_queue {
+    int             kind;           // -1 queue, else HOST_SEM_*
+    UBaseType_t     length;
+    UBaseType_t     item_size;
+    UBaseType_t     count;
+    UBaseType_t     head;
+    struct host_task *owner;        // mutexes
+    UBaseType_t     depth;          // recursive takes
+    uint8_t         items[];
+};
+
+static pthread_mutex_t kernel_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t kernel_cond;
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+static __thread struct host_task *current_task;
+static __thread int isr_depth;
+static uint32_t isr_violations;
+
+static void kernel_init(void)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&kernel_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static void kernel_enter(void)
+{
+    pthread_once(&kernel_once, kernel_init);
+    pthread_mutex_lock(&kernel_lock);
+}
+
+static void kernel_exit(void)
+{
+    pthread_mutex_unlock(&kernel_lock);
+}
+
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ms = pdTICKS_TO_MS(ticks);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// Wait for any kernel object to change; false once the deadline passed
+static bool kernel_wait(TickType_t ticks, const struct timespec *deadline)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(&kernel_cond, &kernel_lock);
+        return true;
+    }
+    return pthread_cond_timedwait(&kernel_cond, &kernel_lock, deadline) != ETIMEDOUT;
+}
+
+BaseType_t xPortInIsrContext(void)
+{
+    return isr_depth > 0;
+}
+
+void host_isr_enter(void)
+{
+    isr_depth++;
+}
+
+void host_isr_exit(void)
+{
+    isr_depth--;
+}
+
+void host_isr_violation(const char *what)
+{
+    if (isr_depth > 0) {
+        __atomic_add_fetch(&isr_violations, 1, __ATOMIC_RELAXED);
+        (void)what;
+    }
+}
+
+uint32_t host_isr_violations(void)
+{
+    return __atomic_load_n(&isr_violations, __ATOMIC_RELAXED);
+}
+
+/* ---- tasks ---- */
+
+static struct host_task *task_self(void)
+{
+    if (!current_task) {
+        // threads not created by xTaskCreate (main, test threads) get a handle on first use
+        current_task = calloc(1, sizeof(*current_task));
+        current_task->thread = pthread_self();
+        strcpy(current_task->name, "host");
+    }
+    return current_task;
+}
+
+static void *task_entry(void *arg)
+{
+    struct host_task *task = arg;
+    current_task = task;
+    task->fn(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *created_task)
+{
+    (void)stack_depth;
+    (void)priority;
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (!task) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+    if (created_task) {
+        *created_task = task;
+    }
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id)
+{
+    (void)core_id;
+    return xTaskCreate(fn, name, stack_depth, arg, priority, created_task);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (!task || task == current_task) {
+        pthread_exit(NULL);
+    }
+    // deleting another task is not needed by the firmware
+    abort();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    uint64_t us = (uint64_t)pdTICKS_TO_MS(ticks) * 1000;
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000 };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return pdMS_TO_TICKS((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return task_self();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    (void)task;
+    return 1024;
+}
+
+/* ---- notifications ---- */
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, UBaseType_t index, uint32_t value, eNotifyAction action,
+                              uint32_t *previous_value)
+{
+    assert(task && index < configTASK_NOTIFICATION_ARRAY_ENTRIES);
+    BaseType_t ret = pdPASS;
+    kernel_enter();
+    if (previous_value) {
+        *previous_value = task->value[index];
+    }
+    switch (action) {
+    case eSetBits:
+        task->value[index] |= value;
+        break;
+    case eIncrement:
+        task->value[index]++;
+        break;
+    case eSetValueWithOverwrite:
+        task->value[index] = value;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (task->pending[index]) {
+            ret = pdFAIL;
+        } else {
+            task->value[index] = value;
+        }
+        break;
+    case eNoAction:
+        break;
+    }
+    task->pending[index] = true;
+    pthread_cond_broadcast(&kernel_cond);
+    kernel_exit();
+    return ret;
+}
+
+BaseType_t xTaskGenericNotifyWait(UBaseType_t index, uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                  uint32_t *value, TickType_t ticks)
+{
+    struct host_task *task = task_self();
+    struct timespec deadline = deadline_after(ticks);
+    BaseType_t ret = pdFALSE;
+    kernel_enter();
+    if (!task->pending[index]) {
+        task->value[index] &= ~clear_on_entry;
+    }
+    while (!task->pending[index] && kernel_wait(ticks, &deadline)) {
+    }
+    if (value) {
+        *value = task->value[index];
+    }
+    if (task->pending[index]) {
+        task->value[index] &= ~clear_on_exit;
+        ret = pdTRUE;
+    }
+    task->pending[index] = false;
+    kernel_exit();
+    return ret;
+}
+
+uint32_t ulTaskGenericNotifyTake(UBaseType_t index, BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct host_task *task = task_self();
+    struct timespec deadline = deadline_after(ticks);
+    kernel_enter();
+    while (!task->value[index] && kernel_wait(ticks, &deadline)) {
+    }
+    uint32_t count = task->value[index];
+    if (count) {
+        task->value[index] = clear_on_exit ? 0 : count - 1;
+    }
+    task->pending[index] = false;
+    kernel_exit();
+    return count;
+}
+
+/* ---- queues and semaphores ---- */
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *q = calloc(1, sizeof(*q) + (size_t)length * item_size);
+    if (!q) {
+        return NULL;
+    }
+    q->kind = -1;
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    free(queue);
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t q, const void *item, TickType_t ticks, bool front)
+{
+    struct timespec deadline = deadline_after(ticks);
+    BaseType_t ret = pdFALSE;
+    kernel_enter();
+    while (q->count == q->length && kernel_wait(ticks, &deadline)) {
+    }
+    if (q->count < q->length) {
+        UBaseType_t slot;
+        if (front) {
+            q->head = (q->head + q->length - 1) % q->length;
+            slot = q->head;
+        } else {
+            slot = (q->head + q->count) % q->length;
+        }
+        memcpy(&q->items[slot * q->item_size], item, q->item_size);
+        q->count++;
+        pthread_cond_broadcast(&kernel_cond);
+        ret = pdTRUE;
+    }
+    kernel_exit();
+    return ret;
+}
+
+static BaseType_t queue_get(QueueHandle_t q, void *item, TickType_t ticks, bool remove)
+{
+    struct timespec deadline = deadline_after(ticks);
+    BaseType_t ret = pdFALSE;
+    kernel_enter();
+    while (!q->count && kernel_wait(ticks, &deadline)) {
+    }
+    if (q->count) {
+        memcpy(item, &q->items[q->head * q->item_size], q->item_size);
+        if (remove) {
+            q->head = (q->head + 1) % q->length;
+            q->count--;
+            pthread_cond_broadcast(&kernel_cond);
+        }
+        ret = pdTRUE;
+    }
+    kernel_exit();
+    return ret;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    return queue_get(queue, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    return queue_get(queue, item, ticks, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    kernel_enter();
+    UBaseType_t count = queue->count;
+    kernel_exit();
+    return count;
+}
+
+SemaphoreHandle_t host_semaphore_create(int kind, UBaseType_t max_count, UBaseType_t initial)
+{
+    struct host_queue *q = calloc(1, sizeof(*q));
+    if (!q) {
+        return NULL;
+    }
+    q->kind = kind;
+    q->length = max_count;
+    q->count = initial;
+    return q;
+}
+
+BaseType_t host_semaphore_take(SemaphoreHandle_t sem, TickType_t ticks, bool recursive)
+{
+    struct host_task *self = task_self();
+    struct timespec deadline = deadline_after(ticks);
+    BaseType_t ret = pdFALSE;
+    kernel_enter();
+    if (recursive && sem->owner == self) {
+        sem->depth++;
+        kernel_exit();
+        return pdTRUE;
+    }
+    while (!sem->count && kernel_wait(ticks, &deadline)) {
+    }
+    if (sem->count) {
+        sem->count--;
+        if (sem->kind == HOST_SEM_MUTEX) {
+            sem->owner = self;
+            sem->depth = 1;
+        }
+        ret = pdTRUE;
+    }
+    kernel_exit();
+    return ret;
+}
+
+BaseType_t host_semaphore_give(SemaphoreHandle_t sem, bool recursive)
+{
+    BaseType_t ret = pdTRUE;
+    kernel_enter();
+    if (sem->kind == HOST_SEM_MUTEX) {
+        assert(sem->owner == current_task);
+        if (recursive && --sem->depth) {
+            kernel_exit();
+            return pdTRUE;
+        }
+        sem->owner = NULL;
+        sem->depth = 0;
+    }
+    if (sem->count < sem->length) {
+        sem->count++;
+        pthread_cond_broadcast(&kernel_cond);
+    } else {
+        ret = pdFALSE;
+    }
+    kernel_exit();
+    return ret;
+}
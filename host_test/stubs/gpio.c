@@ -0,0 +1,192 @@
+/**
+ * @file      gpio.c
+ * @license   MIT
+ *
+ * In-memory GPIO pins. gpio_set_level() is flash code on the target (with
+ * CONFIG_GPIO_CTRL_FUNC_IN_IRAM off), so calls from a simulated ISR are
+ * counted as violations; gpio_ll_set_level() is the ISR safe path.
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#include "host_mock.h"
+
+typedef struct {
+    int             level;
+    gpio_int_type_t intr_type;
+    gpio_isr_t      handler;
+    void            *arg;
+    uint32_t        writes;
+    uint32_t        transitions;
+} host_pin_t;
+
+gpio_dev_t GPIO;
+
+static pthread_mutex_t gpio_lock = PTHREAD_MUTEX_INITIALIZER;
+static host_pin_t pins[GPIO_NUM_MAX];
+
+static host_pin_t *pin(gpio_num_t gpio_num)
+{
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX ? &pins[gpio_num] : NULL;
+}
+
+static void pin_write(gpio_num_t gpio_num, uint32_t level)
+{
+    host_pin_t *p = pin(gpio_num);
+    if (!p) {
+        return;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    p->writes++;
+    if (p->level != !!level) {
+        p->transitions++;
+        p->level = !!level;
+    }
+    pthread_mutex_unlock(&gpio_lock);
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        if (config->pin_bit_mask & (1ULL << i)) {
+            pins[i].intr_type = config->intr_type;
+            if (config->pull_up_en && config->mode == GPIO_MODE_INPUT) {
+                pins[i].level = 1;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    return pin(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    (void)mode;
+    return pin(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    host_isr_violation("gpio_set_level");
+    pin_write(gpio_num, level);
+    return pin(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+void host_gpio_ll_set_level(uint32_t gpio_num, uint32_t level)
+{
+    pin_write((gpio_num_t)gpio_num, level);
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    host_pin_t *p = pin(gpio_num);
+    return p ? p->level : 0;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    host_pin_t *p = pin(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p->intr_type = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    (void)intr_alloc_flags;
+    static bool installed;
+    if (installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    installed = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    host_pin_t *p = pin(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    p->handler = isr_handler;
+    p->arg = args;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    return gpio_isr_handler_add(gpio_num, NULL, NULL);
+}
+
+void host_gpio_set_input(gpio_num_t gpio_num, int level)
+{
+    host_pin_t *p = pin(gpio_num);
+    pthread_mutex_lock(&gpio_lock);
+    int old = p->level;
+    p->level = !!level;
+    gpio_isr_t handler = p->handler;
+    void *arg = p->arg;
+    bool fire = false;
+    switch (p->intr_type) {
+    case GPIO_INTR_POSEDGE:
+        fire = !old && level;
+        break;
+    case GPIO_INTR_NEGEDGE:
+        fire = old && !level;
+        break;
+    case GPIO_INTR_ANYEDGE:
+        fire = old != !!level;
+        break;
+    case GPIO_INTR_LOW_LEVEL:
+        fire = !level;
+        break;
+    case GPIO_INTR_HIGH_LEVEL:
+        fire = level;
+        break;
+    default:
+        break;
+    }
+    pthread_mutex_unlock(&gpio_lock);
+    if (fire && handler) {
+        host_isr_enter();
+        handler(arg);
+        host_isr_exit();
+    }
+}
+
+int host_gpio_level(gpio_num_t gpio_num)
+{
+    return gpio_get_level(gpio_num);
+}
+
+uint32_t host_gpio_writes(gpio_num_t gpio_num)
+{
+    host_pin_t *p = pin(gpio_num);
+    return p ? p->writes : 0;
+}
+
+uint32_t host_gpio_transitions(gpio_num_t gpio_num)
+{
+    host_pin_t *p = pin(gpio_num);
+    return p ? p->transitions : 0;
+}
+
+void host_gpio_reset(void)
+{
+    pthread_mutex_lock(&gpio_lock);
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        pins[i].writes = 0;
+        pins[i].transitions = 0;
+    }
+    pthread_mutex_unlock(&gpio_lock);
+}
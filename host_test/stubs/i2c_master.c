@@ -0,0 +1,182 @@
+/**
+ * @file      i2c_master.c
+ * @license   MIT
+ *
+ * I2C master over register-file devices. A write selects the register and
+ * stores the bytes after it, a read continues from the selected register;
+ * both auto-increment. Each transfer takes the device's latency, and two
+ * transfers on the bus at once are counted as overlaps.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "driver/i2c_master.h"
+#include "host_mock.h"
+
+#define I2C_MAX_DEVICES     8
+
+struct i2c_master_dev_t {
+    uint16_t        address;
+    bool            present;
+    uint8_t         regs[256];
+    uint8_t         reg_ptr;
+    uint32_t        latency_us;
+    uint32_t        transfers;
+    uint32_t        bytes_read;
+};
+
+struct i2c_master_bus_t {
+    int             unused;
+};
+
+static pthread_mutex_t i2c_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct i2c_master_bus_t bus;
+static struct i2c_master_dev_t devices[I2C_MAX_DEVICES];
+static int busy;
+static uint32_t overlaps;
+
+static struct i2c_master_dev_t *i2c_find(uint16_t address, bool create)
+{
+    for (int i = 0; i < I2C_MAX_DEVICES; i++) {
+        if (devices[i].present && devices[i].address == address) {
+            return &devices[i];
+        }
+    }
+    if (create) {
+        for (int i = 0; i < I2C_MAX_DEVICES; i++) {
+            if (!devices[i].present) {
+                memset(&devices[i], 0, sizeof(devices[i]));
+                devices[i].present = true;
+                devices[i].address = address;
+                return &devices[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+static void i2c_busy(struct i2c_master_dev_t *dev)
+{
+    if (__atomic_add_fetch(&busy, 1, __ATOMIC_SEQ_CST) > 1) {
+        __atomic_add_fetch(&overlaps, 1, __ATOMIC_SEQ_CST);
+    }
+    if (dev->latency_us) {
+        struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)dev->latency_us * 1000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static void i2c_idle(void)
+{
+    __atomic_sub_fetch(&busy, 1, __ATOMIC_SEQ_CST);
+}
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *bus_config, i2c_master_bus_handle_t *ret_bus_handle)
+{
+    (void)bus_config;
+    *ret_bus_handle = &bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle)
+{
+    (void)bus_handle;
+    pthread_mutex_lock(&i2c_lock);
+    // devices that do not answer are still accepted, as on the target
+    struct i2c_master_dev_t *dev = i2c_find(dev_config->device_address, true);
+    pthread_mutex_unlock(&i2c_lock);
+    if (!dev) {
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus_handle, uint16_t address, int xfer_timeout_ms)
+{
+    (void)bus_handle;
+    (void)xfer_timeout_ms;
+    pthread_mutex_lock(&i2c_lock);
+    struct i2c_master_dev_t *dev = i2c_find(address, false);
+    pthread_mutex_unlock(&i2c_lock);
+    return dev ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms)
+{
+    return i2c_master_transmit_receive(i2c_dev, write_buffer, write_size, NULL, 0, xfer_timeout_ms);
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t i2c_dev, uint8_t *read_buffer, size_t read_size,
+                             int xfer_timeout_ms)
+{
+    return i2c_master_transmit_receive(i2c_dev, NULL, 0, read_buffer, read_size, xfer_timeout_ms);
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer,
+                                      size_t write_size, uint8_t *read_buffer, size_t read_size,
+                                      int xfer_timeout_ms)
+{
+    (void)xfer_timeout_ms;
+    i2c_busy(i2c_dev);
+    pthread_mutex_lock(&i2c_lock);
+    i2c_dev->transfers++;
+    if (write_size) {
+        i2c_dev->reg_ptr = write_buffer[0];
+        for (size_t i = 1; i < write_size; i++) {
+            i2c_dev->regs[i2c_dev->reg_ptr++] = write_buffer[i];
+        }
+    }
+    for (size_t i = 0; i < read_size; i++) {
+        read_buffer[i] = i2c_dev->regs[i2c_dev->reg_ptr++];
+    }
+    i2c_dev->bytes_read += read_size;
+    pthread_mutex_unlock(&i2c_lock);
+    i2c_idle();
+    return ESP_OK;
+}
+
+uint8_t *host_i2c_add(uint16_t address)
+{
+    pthread_mutex_lock(&i2c_lock);
+    struct i2c_master_dev_t *dev = i2c_find(address, true);
+    pthread_mutex_unlock(&i2c_lock);
+    return dev->regs;
+}
+
+void host_i2c_set_latency(uint16_t address, uint32_t us)
+{
+    i2c_find(address, true)->latency_us = us;
+}
+
+uint32_t host_i2c_transfers(uint16_t address)
+{
+    struct i2c_master_dev_t *dev = i2c_find(address, false);
+    return dev ? dev->transfers : 0;
+}
+
+uint32_t host_i2c_bytes_read(uint16_t address)
+{
+    struct i2c_master_dev_t *dev = i2c_find(address, false);
+    return dev ? dev->bytes_read : 0;
+}
+
+uint32_t host_i2c_overlaps(void)
+{
+    return __atomic_load_n(&overlaps, __ATOMIC_SEQ_CST);
+}
+
+void host_i2c_reset(void)
+{
+    pthread_mutex_lock(&i2c_lock);
+    for (int i = 0; i < I2C_MAX_DEVICES; i++) {
+        devices[i].transfers = 0;
+        devices[i].bytes_read = 0;
+    }
+    overlaps = 0;
+    pthread_mutex_unlock(&i2c_lock);
+}
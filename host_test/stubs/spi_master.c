@@ -0,0 +1,352 @@
+/**
+ * @file      spi_master.c
+ * @license   MIT
+ *
+ * SPI master with a model of a QSPI AMOLED panel behind it. A transaction is
+ * decoded when it goes on the wire: CASET/RASET set the window, RAMWR (0x32
+ * 0x2C00) and the command-less continuation chunks fill panel memory from the
+ * caller's buffer, as the DMA would read it at that moment. Once a test
+ * calls host_panel_follow_madctl(), MADCTL also steers the addressing: the
+ * window is in the exchanged (MV) frame and MX/MY mirror the stored pixel.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driver/spi_master.h"
+#include "esp_timer.h"
+#include "host_mock.h"
+
+#define SPI_MAX_QUEUE       64
+#define SPI_MAX_RECORDS     65536
+
+struct spi_device_t {
+    spi_device_interface_config_t config;
+};
+
+static pthread_mutex_t spi_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t spi_cond = PTHREAD_COND_INITIALIZER;
+static struct spi_device_t device;
+static bool device_added;
+
+static spi_transaction_t *pending[SPI_MAX_QUEUE];   // queued, not on the wire yet
+static int64_t pending_us[SPI_MAX_QUEUE];
+static uint32_t pending_head, pending_count;
+static spi_transaction_t *done[SPI_MAX_QUEUE];      // finished, not collected yet
+static uint32_t done_head, done_count;
+static bool autocomplete;
+
+static host_spi_record_t *records;
+static uint32_t record_count;
+static uint32_t wire_seq;
+static uint64_t wire_bytes;
+
+static uint16_t *panel;
+static uint16_t panel_w, panel_h;
+static uint16_t win_xs, win_xe, win_ys, win_ye;
+static uint16_t cur_x, cur_y;
+static uint8_t madctl;
+static bool follow_madctl;
+static uint8_t madctl_upright;      // MADCTL that shows panel RAM as stored
+static int cs_pin = -1;
+
+void host_panel_init(uint16_t width, uint16_t height)
+{
+    pthread_mutex_lock(&spi_lock);
+    free(panel);
+    panel = calloc((size_t)width * height, sizeof(uint16_t));
+    panel_w = width;
+    panel_h = height;
+    win_xs = win_ys = 0;
+    win_xe = width - 1;
+    win_ye = height - 1;
+    pthread_mutex_unlock(&spi_lock);
+}
+
+void host_spi_set_cs_pin(int gpio_num)
+{
+    cs_pin = gpio_num;
+}
+
+const uint16_t *host_panel_ram(void)
+{
+    return panel;
+}
+
+uint8_t host_panel_madctl(void)
+{
+    return madctl;
+}
+
+void host_panel_follow_madctl(uint8_t upright)
+{
+    pthread_mutex_lock(&spi_lock);
+    follow_madctl = true;
+    madctl_upright = upright;
+    pthread_mutex_unlock(&spi_lock);
+}
+
+static void panel_write(const uint8_t *data, size_t bytes)
+{
+    if (!panel) {
+        return;
+    }
+    // the bits flipped from upright: MV exchanges the address frame, then
+    // MX and MY mirror the column and row the pixel is stored at
+    uint8_t flip = follow_madctl ? madctl ^ madctl_upright : 0;
+    bool mv = flip & 0x20;
+    uint16_t addr_w = mv ? panel_h : panel_w;
+    uint16_t addr_h = mv ? panel_w : panel_h;
+    for (size_t i = 0; i + 1 < bytes; i += 2) {
+        if (cur_y > win_ye || cur_y >= addr_h) {
+            return;     // past the window
+        }
+        if (cur_x < addr_w) {
+            uint16_t px;
+            memcpy(&px, &data[i], 2);
+            uint16_t col = mv ? cur_y : cur_x;
+            uint16_t row = mv ? cur_x : cur_y;
+            if (flip & 0x40) {
+                col = panel_w - 1 - col;
+            }
+            if (flip & 0x80) {
+                row = panel_h - 1 - row;
+            }
+            panel[(size_t)row * panel_w + col] = px;
+        }
+        if (++cur_x > win_xe) {
+            cur_x = win_xs;
+            cur_y++;
+        }
+    }
+}
+
+static void panel_decode(const spi_transaction_t *t, uint8_t cmd_bits, const uint8_t *data, size_t bytes)
+{
+    uint8_t reg = (t->addr >> 8) & 0xFF;
+    if (cmd_bits == 0) {
+        panel_write(data, bytes);
+    } else if (t->cmd == 0x32 && reg == 0x2C) {
+        cur_x = win_xs;
+        cur_y = win_ys;
+        panel_write(data, bytes);
+    } else if (t->cmd == 0x02 && reg == 0x2A && bytes == 4) {
+        win_xs = data[0] << 8 | data[1];
+        win_xe = data[2] << 8 | data[3];
+    } else if (t->cmd == 0x02 && reg == 0x2B && bytes == 4) {
+        win_ys = data[0] << 8 | data[1];
+        win_ye = data[2] << 8 | data[3];
+    } else if (t->cmd == 0x02 && reg == 0x36 && bytes >= 1) {
+        madctl = data[0];
+    }
+}
+
+// Put one transaction on the wire; called with spi_lock held
+static void spi_wire(spi_transaction_t *t, bool queued, int64_t queued_us)
+{
+    const spi_transaction_ext_t *ext = (const spi_transaction_ext_t *)t;
+    uint8_t cmd_bits = t->flags & SPI_TRANS_VARIABLE_CMD ? ext->command_bits : device.config.command_bits;
+    uint8_t addr_bits = t->flags & SPI_TRANS_VARIABLE_ADDR ? ext->address_bits : device.config.address_bits;
+    size_t data_bytes = t->length / 8;
+    const uint8_t *data = t->flags & SPI_TRANS_USE_TXDATA ? t->tx_data : (const uint8_t *)t->tx_buffer;
+
+    if (device.config.pre_cb) {
+        host_isr_enter();
+        device.config.pre_cb(t);
+        host_isr_exit();
+    }
+    bool cs_low = cs_pin < 0 || gpio_get_level(cs_pin) == 0;
+    if (cs_low) {
+        panel_decode(t, cmd_bits, data, data_bytes);
+    }
+
+    if (record_count < SPI_MAX_RECORDS) {
+        if (!records) {
+            records = calloc(SPI_MAX_RECORDS, sizeof(*records));
+        }
+        host_spi_record_t *r = &records[record_count++];
+        r->seq = wire_seq;
+        r->cmd = cmd_bits ? t->cmd : 0;
+        r->addr = addr_bits ? (uint32_t)t->addr : 0;
+        r->flags = t->flags;
+        r->bytes = (cmd_bits + addr_bits) / 8 + data_bytes;
+        r->queued = queued;
+        r->cs_low = cs_low;
+        r->queued_us = queued_us;
+        r->done_us = esp_timer_get_time();
+    }
+    wire_seq++;
+    wire_bytes += (cmd_bits + addr_bits) / 8 + data_bytes;
+
+    if (device.config.post_cb) {
+        host_isr_enter();
+        device.config.post_cb(t);
+        host_isr_exit();
+    }
+}
+
+// The oldest queued transaction finishes; called with spi_lock held
+static bool spi_complete_one(void)
+{
+    if (!pending_count) {
+        return false;
+    }
+    spi_transaction_t *t = pending[pending_head];
+    int64_t queued_us = pending_us[pending_head];
+    pending_head = (pending_head + 1) % SPI_MAX_QUEUE;
+    pending_count--;
+    spi_wire(t, true, queued_us);
+    done[(done_head + done_count) % SPI_MAX_QUEUE] = t;
+    done_count++;
+    pthread_cond_broadcast(&spi_cond);
+    return true;
+}
+
+static void *spi_dma_thread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&spi_lock);
+    while (1) {
+        while (autocomplete && spi_complete_one()) {
+        }
+        pthread_cond_wait(&spi_cond, &spi_lock);
+    }
+    return NULL;
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, int dma_chan)
+{
+    (void)host_id;
+    (void)bus_config;
+    (void)dma_chan;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config,
+                             spi_device_handle_t *handle)
+{
+    (void)host_id;
+    if (device_added) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (dev_config->queue_size > SPI_MAX_QUEUE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    device.config = *dev_config;
+    device_added = true;
+    *handle = &device;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait)
+{
+    (void)ticks_to_wait;
+    pthread_mutex_lock(&spi_lock);
+    if (pending_count + done_count >= (uint32_t)handle->config.queue_size) {
+        pthread_mutex_unlock(&spi_lock);
+        return ESP_ERR_TIMEOUT;
+    }
+    pending[(pending_head + pending_count) % SPI_MAX_QUEUE] = trans_desc;
+    pending_us[(pending_head + pending_count) % SPI_MAX_QUEUE] = esp_timer_get_time();
+    pending_count++;
+    pthread_cond_broadcast(&spi_cond);
+    pthread_mutex_unlock(&spi_lock);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc,
+                                      TickType_t ticks_to_wait)
+{
+    (void)handle;
+    (void)ticks_to_wait;
+    pthread_mutex_lock(&spi_lock);
+    // waiting for the result is waiting for the DMA: finish the oldest one
+    if (!done_count && !spi_complete_one()) {
+        pthread_mutex_unlock(&spi_lock);
+        return ESP_ERR_TIMEOUT;
+    }
+    *trans_desc = done[done_head];
+    done_head = (done_head + 1) % SPI_MAX_QUEUE;
+    done_count--;
+    pthread_mutex_unlock(&spi_lock);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    (void)handle;
+    pthread_mutex_lock(&spi_lock);
+    // the bus is acquired once the queue drained
+    while (spi_complete_one()) {
+    }
+    spi_wire(trans_desc, false, esp_timer_get_time());
+    pthread_mutex_unlock(&spi_lock);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    spi_transaction_t *result;
+    esp_err_t err = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+    if (err == ESP_OK) {
+        err = spi_device_get_trans_result(handle, &result, portMAX_DELAY);
+    }
+    return err;
+}
+
+uint32_t host_spi_count(void)
+{
+    return record_count;
+}
+
+const host_spi_record_t *host_spi_get(uint32_t index)
+{
+    return index < record_count ? &records[index] : NULL;
+}
+
+uint64_t host_spi_wire_bytes(void)
+{
+    return wire_bytes;
+}
+
+void host_spi_clear(void)
+{
+    pthread_mutex_lock(&spi_lock);
+    record_count = 0;
+    wire_bytes = 0;
+    pthread_mutex_unlock(&spi_lock);
+}
+
+uint32_t host_spi_pending(void)
+{
+    pthread_mutex_lock(&spi_lock);
+    uint32_t count = pending_count;
+    pthread_mutex_unlock(&spi_lock);
+    return count;
+}
+
+uint32_t host_spi_complete(uint32_t count)
+{
+    uint32_t n = 0;
+    pthread_mutex_lock(&spi_lock);
+    while (n < count && spi_complete_one()) {
+        n++;
+    }
+    pthread_mutex_unlock(&spi_lock);
+    return n;
+}
+
+void host_spi_autocomplete(bool on)
+{
+    static bool started;
+    pthread_mutex_lock(&spi_lock);
+    autocomplete = on;
+    if (on && !started) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, spi_dma_thread, NULL);
+        pthread_detach(thread);
+        started = true;
+    }
+    pthread_cond_broadcast(&spi_cond);
+    pthread_mutex_unlock(&spi_lock);
+}
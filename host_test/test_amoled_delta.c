@@ -0,0 +1,118 @@
+/**
+ * @file      test_amoled_delta.c
+ * @license   MIT
+ *
+ * The delta flush of amoled_driver.c against the SPI panel model. Areas of
+ * any size and position, in any order, must leave the panel showing exactly
+ * what LVGL drew, while unchanged pixels stay off the wire as soon as an
+ * earlier area has sent them.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "test_util.h"
+#include "host_mock.h"
+#include "amoled_driver.h"
+
+#define ROUNDS          400
+
+static uint16_t screen[AMOLED_WIDTH * AMOLED_HEIGHT];      // what LVGL drew
+static uint16_t area_buf[AMOLED_WIDTH * AMOLED_HEIGHT];
+static uint64_t full_bytes;
+
+static uint32_t rnd(uint32_t n)
+{
+    static uint32_t state = 12345;
+    state = state * 1103515245u + 12345u;
+    return (state >> 8) % n;
+}
+
+// Flush one area of the screen like lvgl_flush_cb() and wait for it
+static void flush(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    for (uint16_t r = 0; r < h; r++) {
+        memcpy(&area_buf[(uint32_t)r * w], &screen[(uint32_t)(y + r) * AMOLED_WIDTH + x], w * sizeof(uint16_t));
+    }
+    display_push_colors(x, y, w, h, area_buf);
+    host_spi_complete(UINT32_MAX);
+    CHECK_EQ(ulTaskNotifyTakeIndexed(AMOLED_FLUSH_NOTIFY_INDEX, pdTRUE, 0), 1);
+    full_bytes += (uint64_t)w * h * 2;
+}
+
+static uint32_t panel_mismatch(void)
+{
+    const uint16_t *ram = host_panel_ram();
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < AMOLED_WIDTH * AMOLED_HEIGHT; i++) {
+        wrong += ram[i] != screen[i];
+    }
+    return wrong;
+}
+
+int main(void)
+{
+    host_panel_init(AMOLED_WIDTH, AMOLED_HEIGHT);
+    host_spi_set_cs_pin(BOARD_DISP_CS);
+    display_init();
+    amoled_register_flush_done_task(xTaskGetCurrentTaskHandle());
+    uint32_t sent, skipped;
+
+    // a label away from row 0, drawn and then redrawn with one digit changed:
+    // the second flush sends the changed pixels only
+    for (uint32_t i = 0; i < 100 * 20; i++) {
+        screen[(200 + i / 100) * AMOLED_WIDTH + 50 + i % 100] = (uint16_t)(0x4000 + i);
+    }
+    flush(50, 200, 100, 20);
+    for (uint16_t r = 205; r < 212; r++) {
+        screen[r * AMOLED_WIDTH + 90] ^= 0xFFFF;
+        screen[r * AMOLED_WIDTH + 91] ^= 0xFFFF;
+    }
+    flush(50, 200, 100, 20);
+    amoled_get_delta_stats(&sent, &skipped);
+    CHECK_EQ(sent, 100 * 20 + 7 * 2);
+    CHECK_EQ(skipped, 100 * 20 - 7 * 2);
+    CHECK_EQ(panel_mismatch(), 0);
+
+    // an area overlapping known and unknown columns is sent whole, and then known
+    flush(120, 200, 60, 20);
+    flush(50, 200, 130, 20);
+    amoled_get_delta_stats(&sent, &skipped);
+    CHECK_EQ(sent, 100 * 20 + 7 * 2 + 60 * 20);
+    CHECK_EQ(panel_mismatch(), 0);
+
+    // random areas with sparse edits, the way labels and focus rings change
+    host_spi_clear();
+    full_bytes = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        uint16_t w = (uint16_t)(1 + rnd(AMOLED_WIDTH));
+        uint16_t h = (uint16_t)(1 + rnd(60));
+        uint16_t x = (uint16_t)rnd(AMOLED_WIDTH - w + 1);
+        uint16_t y = (uint16_t)rnd(AMOLED_HEIGHT - h + 1);
+        uint32_t edits = rnd(4) == 0 ? (uint32_t)w * h : rnd(20);
+        for (uint32_t e = 0; e < edits; e++) {
+            screen[(y + rnd(h)) * AMOLED_WIDTH + x + rnd(w)] = (uint16_t)rnd(0x10000);
+        }
+        flush(x, y, w, h);
+        if (round % 50 == 0) {
+            CHECK_EQ(panel_mismatch(), 0);
+        }
+    }
+    CHECK_EQ(panel_mismatch(), 0);
+
+    // pixels pushed through the public window API are not in the shadow
+    for (uint32_t i = 0; i < 10 * 10; i++) {
+        screen[(300 + i / 10) * AMOLED_WIDTH + 30 + i % 10] = 0x1234;
+        area_buf[i] = 0x1234;
+    }
+    amoled_set_window(30, 300, 39, 309);
+    amoled_push_buffer(area_buf, 10 * 10);
+    flush(0, 290, AMOLED_WIDTH, 30);
+    CHECK_EQ(panel_mismatch(), 0);
+
+    uint64_t wire = host_spi_wire_bytes();
+    printf("%d random areas: %llu bytes on the wire, %llu pixel bytes without delta (%.0f%%)\n",
+           ROUNDS, (unsigned long long)wire, (unsigned long long)full_bytes, 100.0 * wire / full_bytes);
+    CHECK(wire < full_bytes);
+    return TEST_RESULT();
+}
@@ -0,0 +1,245 @@
+/**
+ * @file      test_amoled_queued.c
+ * @license   MIT
+ *
+ * The queued DMA path of amoled_driver.c against the SPI panel model: the
+ * transaction ISRs only touch CS through the LL layer and give the
+ * flush-done notification with the time the transfer ended, the pixels land
+ * in panel RAM, and the notification index leaves the task's other
+ * notifications alone. Then the column/row bounds: resent only when they
+ * change, as amoled_get_window_stats() counts them, and the cost per flush
+ * on the wire against the unbatched amoled_set_window() + amoled_push_buffer()
+ * path for scattered small areas and for one area redrawn in place.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "test_util.h"
+#include "esp_timer.h"
+#include "host_mock.h"
+#include "amoled_driver.h"
+
+#define STRIPE_LINES    40
+#define SMALL_AREAS     120
+#define SMALL_SIDE      16
+
+// Bus time: four data lines, and the board's window setup cost spread over
+// the three CS cycles it takes unbatched
+#define CS_CYCLE_US     ((double)DISPLAY_AREA_OVERHEAD_US / 3)
+#define BYTE_US         (2.0 / (DEFAULT_SCK_SPEED / 1e6))
+
+typedef struct {
+    uint32_t        transactions;
+    uint64_t        bytes;
+    uint32_t        cs_cycles;
+    double          bus_us;
+} flush_cost_t;
+
+static uint32_t take_flush_done(TickType_t ticks)
+{
+    return ulTaskNotifyTakeIndexed(AMOLED_FLUSH_NOTIFY_INDEX, pdFALSE, ticks);
+}
+
+static void fill(uint16_t *px, uint32_t len, uint16_t seed)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        px[i] = (uint16_t)(seed + i * 7);
+    }
+}
+
+static int panel_mismatch(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *px)
+{
+    const uint16_t *ram = host_panel_ram();
+    int wrong = 0;
+    for (uint16_t r = 0; r < h; r++) {
+        wrong += memcmp(&ram[(uint32_t)(y + r) * AMOLED_WIDTH + x], &px[(uint32_t)r * w], w * sizeof(uint16_t)) != 0;
+    }
+    return wrong;
+}
+
+static void window_delta(uint32_t *sent, uint32_t *skipped)
+{
+    static uint32_t last_sent, last_skipped;
+    uint32_t s, k;
+    amoled_get_window_stats(&s, &k);
+    *sent = s - last_sent;
+    *skipped = k - last_skipped;
+    last_sent = s;
+    last_skipped = k;
+}
+
+// Position of the i-th small area: scattered over the screen, or always the same
+static void small_area(uint32_t i, bool scattered, uint16_t *x, uint16_t *y)
+{
+    *x = scattered ? (uint16_t)((i * 37) % (AMOLED_WIDTH - SMALL_SIDE)) : 100;
+    *y = scattered ? (uint16_t)((i * 53) % (AMOLED_HEIGHT - SMALL_SIDE)) : 300;
+}
+
+// SMALL_AREAS flushes, batched through display_push_colors() or as before.
+// The stub's wire takes no time and the batched path waits for a thread
+// handoff per area, so the time is the bus model's, not the host's.
+static flush_cost_t flush_small(bool batched, bool scattered, uint16_t *px)
+{
+    uint32_t records = host_spi_count();
+    uint64_t bytes = host_spi_wire_bytes();
+    uint32_t cs = host_gpio_transitions(BOARD_DISP_CS);
+    for (uint32_t i = 0; i < SMALL_AREAS; i++) {
+        uint16_t x, y;
+        small_area(i, scattered, &x, &y);
+        if (batched) {
+            display_push_colors(x, y, SMALL_SIDE, SMALL_SIDE, px);
+            take_flush_done(pdMS_TO_TICKS(1000));
+        } else {
+            amoled_set_window(x, y, x + SMALL_SIDE - 1, y + SMALL_SIDE - 1);
+            amoled_push_buffer(px, SMALL_SIDE * SMALL_SIDE);
+        }
+    }
+    flush_cost_t cost = {
+        .transactions = host_spi_count() - records,
+        .bytes = host_spi_wire_bytes() - bytes,
+        .cs_cycles = (host_gpio_transitions(BOARD_DISP_CS) - cs) / 2,
+    };
+    cost.bus_us = cost.bytes * BYTE_US + cost.cs_cycles * CS_CYCLE_US;
+    return cost;
+}
+
+static void print_cost(const char *what, const flush_cost_t *unbatched, const flush_cost_t *batched)
+{
+    printf("%s, per flush: unbatched %.2f transactions %.1f bytes %.2f CS cycles %.1f us, "
+           "batched %.2f transactions %.1f bytes %.2f CS cycles %.1f us\n", what,
+           (double)unbatched->transactions / SMALL_AREAS, (double)unbatched->bytes / SMALL_AREAS,
+           (double)unbatched->cs_cycles / SMALL_AREAS, unbatched->bus_us / SMALL_AREAS,
+           (double)batched->transactions / SMALL_AREAS, (double)batched->bytes / SMALL_AREAS,
+           (double)batched->cs_cycles / SMALL_AREAS, batched->bus_us / SMALL_AREAS);
+}
+
+int main(void)
+{
+    host_panel_init(AMOLED_WIDTH, AMOLED_HEIGHT);
+    host_spi_set_cs_pin(BOARD_DISP_CS);
+    display_init();
+    amoled_register_flush_done_task(xTaskGetCurrentTaskHandle());
+    CHECK_EQ(host_isr_violations(), 0);
+
+    uint32_t stripe_px = (uint32_t)AMOLED_WIDTH * STRIPE_LINES;
+    uint16_t *stripe = malloc(stripe_px * sizeof(uint16_t));
+    fill(stripe, stripe_px, 0x1234);
+
+    // nothing is signalled while the transfer is still queued
+    display_push_colors(0, 100, AMOLED_WIDTH, STRIPE_LINES, stripe);
+    CHECK(host_spi_pending() > 0);
+    CHECK_EQ(take_flush_done(0), 0);
+
+    // the last chunk's ISR gives exactly one notification, from LL CS writes only
+    host_spi_complete(UINT32_MAX);
+    CHECK_EQ(take_flush_done(0), 1);
+    CHECK_EQ(take_flush_done(0), 0);
+    CHECK_EQ(host_isr_violations(), 0);
+    CHECK_EQ(host_gpio_level(BOARD_DISP_CS), 1);
+    CHECK_EQ(panel_mismatch(0, 100, AMOLED_WIDTH, STRIPE_LINES, stripe), 0);
+
+    // the completion time is the ISR's, however late the task collects it
+    display_push_colors(0, 300, AMOLED_WIDTH, STRIPE_LINES, stripe);
+    int64_t before = esp_timer_get_time();
+    host_spi_complete(UINT32_MAX);
+    int64_t after = esp_timer_get_time();
+    vTaskDelay(pdMS_TO_TICKS(20));
+    CHECK_EQ(take_flush_done(0), 1);
+    CHECK(display_flush_done_us() >= before);
+    CHECK(display_flush_done_us() <= after);
+
+    // a wake bit pending on index 0 survives flushes and their collection
+    xTaskNotify(xTaskGetCurrentTaskHandle(), 1 << 3, eSetBits);
+    display_push_colors(10, 200, 50, 20, stripe);
+    host_spi_complete(UINT32_MAX);
+    CHECK_EQ(take_flush_done(0), 1);
+    uint32_t bits = 0;
+    CHECK(xTaskNotifyWait(0, UINT32_MAX, &bits, 0) == pdTRUE);
+    CHECK_EQ(bits, 1 << 3);
+
+    // a stream of areas finishing in the background: one give per area
+    host_spi_autocomplete(true);
+    uint32_t collected = 0;
+    for (int i = 0; i < 50; i++) {
+        fill(stripe, stripe_px, (uint16_t)i);
+        display_push_colors(0, (uint16_t)((i % 10) * STRIPE_LINES), AMOLED_WIDTH, STRIPE_LINES, stripe);
+        // LVGL gets the buffer back only once the transfer is done
+        collected += take_flush_done(pdMS_TO_TICKS(1000));
+        CHECK_EQ(panel_mismatch(0, (uint16_t)((i % 10) * STRIPE_LINES), AMOLED_WIDTH, STRIPE_LINES, stripe), 0);
+    }
+    host_spi_autocomplete(false);
+    CHECK_EQ(collected, 50);
+    CHECK_EQ(host_isr_violations(), 0);
+
+    // column/row bounds are only sent when they changed since the last area;
+    // amoled_set_window() sends its own and forgets them
+    uint32_t sent, skipped;
+    amoled_set_window(0, 0, 0, 0);
+    window_delta(&sent, &skipped);
+    display_push_colors(10, 200, 50, 20, stripe);
+    host_spi_complete(UINT32_MAX);
+    take_flush_done(0);
+    window_delta(&sent, &skipped);
+    CHECK_EQ(sent, 2);
+    CHECK_EQ(skipped, 0);
+    uint32_t records = host_spi_count();
+    display_push_colors(10, 200, 50, 20, stripe);         // the same window again
+    host_spi_complete(UINT32_MAX);
+    take_flush_done(0);
+    window_delta(&sent, &skipped);
+    CHECK_EQ(sent, 0);
+    CHECK_EQ(skipped, 2);
+    CHECK_EQ(host_spi_count() - records, 1);                // the pixels alone
+    display_push_colors(10, 260, 50, 20, stripe);         // other rows
+    host_spi_complete(UINT32_MAX);
+    take_flush_done(0);
+    window_delta(&sent, &skipped);
+    CHECK_EQ(sent, 1);
+    CHECK_EQ(skipped, 1);
+    display_push_colors(70, 260, 50, 20, stripe);         // other columns
+    host_spi_complete(UINT32_MAX);
+    take_flush_done(0);
+    window_delta(&sent, &skipped);
+    CHECK_EQ(sent, 1);
+    CHECK_EQ(skipped, 1);
+    CHECK_EQ(panel_mismatch(70, 260, 50, 20, stripe), 0);
+    display_push_colors(0, 0, 50, 20, stripe);            // both
+    host_spi_complete(UINT32_MAX);
+    take_flush_done(0);
+    window_delta(&sent, &skipped);
+    CHECK_EQ(sent, 2);
+    CHECK_EQ(skipped, 0);
+    CHECK_EQ(host_isr_violations(), 0);
+
+    // cost per flush of small areas on the wire, against the unbatched path
+    // of three polling commands, each in its own CS cycle, then the pixels
+    uint16_t px[SMALL_SIDE * SMALL_SIDE];
+    fill(px, SMALL_SIDE * SMALL_SIDE, 0x0F0F);
+    host_spi_autocomplete(true);
+    flush_cost_t scattered_old = flush_small(false, true, px);
+    flush_cost_t scattered_new = flush_small(true, true, px);
+    flush_cost_t in_place_old = flush_small(false, false, px);
+    flush_cost_t in_place_new = flush_small(true, false, px);
+    host_spi_autocomplete(false);
+    print_cost("scattered areas", &scattered_old, &scattered_new);
+    print_cost("one area redrawn", &in_place_old, &in_place_new);
+    CHECK_EQ(scattered_old.transactions, SMALL_AREAS * 4);
+    CHECK_EQ(scattered_old.cs_cycles, SMALL_AREAS * 4);
+    // CASET and RASET queued with the pixels: a transaction and a CS cycle
+    // less each, the RAMWR command rides on the first pixel chunk
+    CHECK(scattered_new.transactions <= SMALL_AREAS * 3);
+    CHECK(scattered_new.bytes < scattered_old.bytes);
+    CHECK(scattered_new.cs_cycles < scattered_old.cs_cycles);
+    CHECK(scattered_new.bus_us < scattered_old.bus_us);
+    // the bounds are sent with the first area, the rest is pixels
+    CHECK_EQ(in_place_old.transactions, SMALL_AREAS * 4);
+    CHECK_EQ(in_place_new.transactions, SMALL_AREAS + 2);
+    CHECK_EQ(in_place_new.bytes, SMALL_AREAS * (4 + SMALL_SIDE * SMALL_SIDE * 2) + 2 * 8);
+    CHECK(in_place_new.bus_us < in_place_old.bus_us);
+    CHECK(panel_mismatch(100, 300, SMALL_SIDE, SMALL_SIDE, px) == 0);
+    CHECK_EQ(host_isr_violations(), 0);
+
+    free(stripe);
+    return TEST_RESULT();
+}
@@ -0,0 +1,184 @@
+/**
+ * @file      test_amoled_rotation.c
+ * @license   MIT
+ *
+ * Rotation through amoled_driver.c, built twice: test_amoled_rotation_hw
+ * programs MADCTL, test_amoled_rotation_sw (CONFIG_AMOLED_HW_ROTATION=0)
+ * copies each area rotated into the bounce buffer. The panel model follows
+ * MADCTL in both. Every rotation, with and without mirror, gets a logical
+ * image tiled with areas of odd sizes, then one pixel wide edges and corner
+ * areas on top; panel RAM must hold that image rotated. The software build
+ * leaves its panel images in amoled_rotation_sw.bin and the hardware build,
+ * run after it, must match them pixel for pixel.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "test_util.h"
+#include "esp_timer.h"
+#include "host_mock.h"
+#include "amoled_driver.h"
+
+#define SCENES          8       // four rotations, without and with mirror
+#define PANEL_PX        ((uint32_t)AMOLED_WIDTH * AMOLED_HEIGHT)
+#define SW_IMAGES       "amoled_rotation_sw.bin"
+
+// Tile sizes cycled through across and down the screen, clipped at the edges
+static const uint16_t tile_w[] = { 37, 1, 64, 13, 3 };
+static const uint16_t tile_h[] = { 29, 1, 47, 5 };
+
+static uint16_t logical[PANEL_PX];
+static uint16_t expect[PANEL_PX];
+static uint16_t images[SCENES][PANEL_PX];
+
+static uint16_t pixel(uint16_t x, uint16_t y, uint16_t seed)
+{
+    return (uint16_t)(x * 131u + y * 7919u + seed * 40503u) ^ (uint16_t)(y << 11);
+}
+
+// One area as LVGL would flush it; the buffer is kept until the transfer is done
+static void push_area(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t seed)
+{
+    uint16_t stride = display_width();
+    uint16_t *buf = malloc((size_t)w * h * sizeof(uint16_t));
+    for (uint16_t r = 0; r < h; r++) {
+        for (uint16_t c = 0; c < w; c++) {
+            buf[r * w + c] = pixel(x + c, y + r, seed);
+            logical[(uint32_t)(y + r) * stride + x + c] = buf[r * w + c];
+        }
+    }
+    display_push_colors(x, y, w, h, buf);
+    CHECK_EQ(ulTaskNotifyTakeIndexed(AMOLED_FLUSH_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(1000)), 1);
+    free(buf);
+}
+
+// Where a logical pixel shows on the panel, as the software path maps it
+static void build_expect(display_rotation_t rotation, bool mirror)
+{
+    uint16_t lw = display_width();
+    uint16_t lh = display_height();
+    for (uint16_t ly = 0; ly < lh; ly++) {
+        for (uint16_t lx = 0; lx < lw; lx++) {
+            uint16_t px, py;
+            switch (rotation) {
+            case DISPLAY_ROTATE_90:
+                px = AMOLED_WIDTH - 1 - ly;
+                py = lx;
+                break;
+            case DISPLAY_ROTATE_180:
+                px = AMOLED_WIDTH - 1 - lx;
+                py = AMOLED_HEIGHT - 1 - ly;
+                break;
+            case DISPLAY_ROTATE_270:
+                px = ly;
+                py = AMOLED_HEIGHT - 1 - lx;
+                break;
+            default:
+                px = lx;
+                py = ly;
+                break;
+            }
+            if (mirror) {
+                px = AMOLED_WIDTH - 1 - px;
+            }
+            expect[(uint32_t)py * AMOLED_WIDTH + px] = logical[(uint32_t)ly * lw + lx];
+        }
+    }
+}
+
+static uint32_t differing(const uint16_t *a, const uint16_t *b)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < PANEL_PX; i++) {
+        n += a[i] != b[i];
+    }
+    return n;
+}
+
+int main(void)
+{
+    host_panel_init(AMOLED_WIDTH, AMOLED_HEIGHT);
+    host_panel_follow_madctl(AMOLED_MADCTL_DEFAULT);
+    host_spi_set_cs_pin(BOARD_DISP_CS);
+    display_init();
+    amoled_register_flush_done_task(xTaskGetCurrentTaskHandle());
+    host_spi_autocomplete(true);
+
+    uint64_t push_ns = 0;
+    uint32_t areas = 0;
+    for (int scene = 0; scene < SCENES; scene++) {
+        display_rotation_t rotation = (display_rotation_t)(scene % 4);
+        bool mirror = scene >= 4;
+        host_panel_init(AMOLED_WIDTH, AMOLED_HEIGHT);
+        memset(logical, 0, sizeof(logical));
+        CHECK(display_set_rotation(rotation, mirror));
+        uint16_t lw = display_width();
+        uint16_t lh = display_height();
+        CHECK_EQ((uint32_t)lw * lh, PANEL_PX);
+#if CONFIG_AMOLED_HW_ROTATION
+        CHECK_EQ(host_panel_madctl() == AMOLED_MADCTL_DEFAULT, rotation == DISPLAY_ROTATE_0 && !mirror);
+#else
+        CHECK_EQ(host_panel_madctl(), AMOLED_MADCTL_DEFAULT);
+#endif
+
+        uint64_t t0 = test_now_ns();
+        uint32_t ti = 0;
+        for (uint16_t y = 0, row = 0; y < lh; y += tile_h[row++ % 4]) {
+            uint16_t h = tile_h[row % 4];
+            h = y + h > lh ? lh - y : h;
+            for (uint16_t x = 0; x < lw; x += tile_w[ti++ % 5]) {
+                uint16_t w = tile_w[ti % 5];
+                w = x + w > lw ? lw - x : w;
+                push_area(x, y, w, h, (uint16_t)scene);
+                areas++;
+            }
+        }
+        // redrawn on top: the last column and row, a corner, and a small
+        // area off the origin
+        push_area(lw - 1, 0, 1, lh, 100 + scene);
+        push_area(0, lh - 1, lw, 1, 200 + scene);
+        push_area(lw - 3, lh - 5, 3, 5, 300 + scene);
+        push_area(lw - 1, lh - 1, 1, 1, 400 + scene);
+        push_area(1, 2, 5, 3, 500 + scene);
+        areas += 5;
+        push_ns += test_now_ns() - t0;
+
+        build_expect(rotation, mirror);
+        uint32_t wrong = differing(host_panel_ram(), expect);
+        if (wrong) {
+            printf("rotation %d%s: %lu pixels wrong\n", rotation * 90, mirror ? " mirrored" : "",
+                   (unsigned long)wrong);
+        }
+        CHECK_EQ(wrong, 0);
+        memcpy(images[scene], host_panel_ram(), sizeof(images[scene]));
+    }
+    host_spi_autocomplete(false);
+    printf("%s rotation: %lu areas in %.1f ms\n", CONFIG_AMOLED_HW_ROTATION ? "MADCTL" : "software",
+           (unsigned long)areas, push_ns / 1e6);
+
+#if CONFIG_AMOLED_HW_ROTATION
+    // the same panel images as the software path left behind
+    FILE *f = fopen(SW_IMAGES, "rb");
+    CHECK(f != NULL);
+    if (f) {
+        static uint16_t sw[PANEL_PX];
+        for (int scene = 0; scene < SCENES; scene++) {
+            CHECK_EQ(fread(sw, sizeof(sw), 1, f), 1);
+            CHECK_EQ(differing(images[scene], sw), 0);
+        }
+        fclose(f);
+    }
+#else
+    FILE *f = fopen(SW_IMAGES, "wb");
+    CHECK(f != NULL);
+    if (f) {
+        CHECK_EQ(fwrite(images, sizeof(images), 1, f), 1);
+        fclose(f);
+    }
+#endif
+    CHECK_EQ(host_isr_violations(), 0);
+    return TEST_RESULT();
+}
@@ -0,0 +1,160 @@
+/**
+ * @file      test_amoled_te.c
+ * @license   MIT
+ *
+ * TE frame pacing of amoled_driver.c (CONFIG_AMOLED_TE_SYNC) with a thread
+ * pulsing the TE pin at a fixed period, through the GPIO ISR as the panel
+ * would. The measured period must follow the pulses and a later change of
+ * rate. Every edge must be counted. display_wait_vblank() must return on
+ * the next edge. A frame whose last area finished before the next TE is on
+ * time; one that ran past it is missed, and so is a wait the TE line leaves
+ * unanswered for 50 ms.
+ */
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "test_util.h"
+#include "esp_timer.h"
+#include "host_mock.h"
+#include "amoled_driver.h"
+
+#define PERIOD_60HZ_US  16667
+#define PERIOD_120HZ_US 8333
+#define TE_TIMEOUT_US   50000
+#define PULSE_US        500
+
+static atomic_uint te_period_us = PERIOD_60HZ_US;
+static atomic_bool te_running = true;
+static atomic_uint te_edges;
+
+static void sleep_until(struct timespec *t, uint32_t us)
+{
+    t->tv_nsec += (long)us * 1000;
+    while (t->tv_nsec >= 1000000000L) {
+        t->tv_nsec -= 1000000000L;
+        t->tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, t, NULL);
+}
+
+// The panel: a short high pulse on TE at the start of every scan
+static void *te_thread(void *arg)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    while (1) {
+        uint32_t period = atomic_load(&te_period_us);
+        if (atomic_load(&te_running)) {
+            host_gpio_set_input(BOARD_DISP_TE, 1);
+            atomic_fetch_add(&te_edges, 1);
+            sleep_until(&t, PULSE_US);
+            host_gpio_set_input(BOARD_DISP_TE, 0);
+            sleep_until(&t, period - PULSE_US);
+        } else {
+            sleep_until(&t, period);
+        }
+    }
+    return NULL;
+}
+
+static display_te_stats_t te_stats(void)
+{
+    display_te_stats_t st;
+    display_get_te_stats(&st);
+    return st;
+}
+
+static bool near(uint32_t measured, uint32_t expected, uint32_t percent)
+{
+    return (uint64_t)abs((int)measured - (int)expected) * 100 <= (uint64_t)expected * percent;
+}
+
+// One frame of a single area, the area sent after delay_us
+static void frame(uint32_t delay_us)
+{
+    static uint16_t px[32 * 8];
+    display_wait_vblank();
+    display_frame_begin();
+    if (delay_us) {
+        vTaskDelay(pdMS_TO_TICKS(delay_us / 1000));
+    }
+    display_push_colors(0, 0, 32, 8, px);
+    CHECK_EQ(ulTaskNotifyTakeIndexed(AMOLED_FLUSH_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(1000)), 1);
+    display_frame_end();
+}
+
+int main(void)
+{
+    host_panel_init(AMOLED_WIDTH, AMOLED_HEIGHT);
+    host_spi_set_cs_pin(BOARD_DISP_CS);
+    pthread_t te;
+    pthread_create(&te, NULL, te_thread, NULL);
+    // init waits for the first TE edges to seed the period
+    display_init();
+    amoled_register_flush_done_task(xTaskGetCurrentTaskHandle());
+    host_spi_autocomplete(true);
+
+    /* ---- period and edge count ---- */
+    vTaskDelay(pdMS_TO_TICKS(200));
+    printf("TE period %lu us at 60 Hz\n", (unsigned long)display_frame_period_us());
+    CHECK(near(display_frame_period_us(), PERIOD_60HZ_US, 5));
+    CHECK_EQ(te_stats().frame_period_us, display_frame_period_us());
+    uint32_t edges = atomic_load(&te_edges);
+    display_te_stats_t st = te_stats();
+    vTaskDelay(pdMS_TO_TICKS(300));
+    CHECK_EQ(te_stats().vblank_count - st.vblank_count, atomic_load(&te_edges) - edges);
+    CHECK(te_stats().vblank_count - st.vblank_count >= 15);
+    CHECK_EQ(te_stats().missed_vblank, 0);
+
+    /* ---- the wait ends on the next edge ---- */
+    for (int i = 0; i < 10; i++) {
+        uint32_t before = te_stats().vblank_count;
+        int64_t t0 = esp_timer_get_time();
+        display_wait_vblank();
+        int64_t waited = esp_timer_get_time() - t0;
+        CHECK_EQ(te_stats().vblank_count, before + 1);
+        CHECK(waited <= PERIOD_60HZ_US + 2000);
+        vTaskDelay(pdMS_TO_TICKS(i % 3 * 5));
+    }
+    CHECK_EQ(te_stats().missed_vblank, 0);
+
+    /* ---- frames on time and past the next TE ---- */
+    for (int i = 0; i < 5; i++) {
+        frame(0);
+    }
+    CHECK_EQ(te_stats().missed_vblank, 0);
+    for (int i = 0; i < 3; i++) {
+        frame(PERIOD_60HZ_US * 3 / 2);
+    }
+    CHECK_EQ(te_stats().missed_vblank, 3);
+    frame(0);
+    CHECK_EQ(te_stats().missed_vblank, 3);
+
+    /* ---- no TE: the wait gives up after 50 ms ---- */
+    atomic_store(&te_running, false);
+    vTaskDelay(pdMS_TO_TICKS(40));
+    st = te_stats();
+    int64_t t0 = esp_timer_get_time();
+    display_wait_vblank();
+    int64_t waited = esp_timer_get_time() - t0;
+    printf("wait without TE returned after %lld us\n", (long long)waited);
+    CHECK(waited >= TE_TIMEOUT_US - 2000);
+    CHECK(waited < TE_TIMEOUT_US + 20000);
+    CHECK_EQ(te_stats().missed_vblank, st.missed_vblank + 1);
+    CHECK_EQ(te_stats().vblank_count, st.vblank_count);
+
+    /* ---- the period follows a new rate ---- */
+    atomic_store(&te_period_us, PERIOD_120HZ_US);
+    atomic_store(&te_running, true);
+    vTaskDelay(pdMS_TO_TICKS(500));
+    printf("TE period %lu us at 120 Hz\n", (unsigned long)display_frame_period_us());
+    CHECK(near(display_frame_period_us(), PERIOD_120HZ_US, 5));
+
+    host_spi_autocomplete(false);
+    CHECK_EQ(host_isr_violations(), 0);
+    return TEST_RESULT();
+}
@@ -0,0 +1,302 @@
+/**
+ * @file      test_area_planner.c
+ * @license   MIT
+ *
+ * The area planner on the fake LVGL display: neighbouring areas are merged
+ * and near full-width areas widened before the refresh, far apart areas are
+ * left alone. Then a replay of what the control screen invalidates in use
+ * (focus moves, presses, the vacuum toggle, a screen switch and the info
+ * screens' label updates), flushed with and without the planner, counting
+ * areas, pixel bytes and the SPI transactions display_push_colors() would
+ * send for them.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "test_util.h"
+#include "lvgl_fake.h"
+#include "product_pins.h"
+#include "area_planner.h"
+
+#define HOR_RES         240
+#define VER_RES         536
+#define STRIPE_LINES    40
+#define FLUSH_MAX       64
+
+// Control screen grid of lvgl_config.c: columns 75/74/75, rows of 60
+#define COL_X(c)        ((c) == 0 ? 0 : (c) == 1 ? 75 : 149)
+#define COL_W(c)        ((c) == 1 ? 74 : 75)
+#define ROW_Y(r)        ((r) * 60)
+// focus outline and shadow of the default theme, drawn outside a button
+#define BTN_EXT         4
+
+typedef enum { BTN_UP, BTN_CRD_UP, BTN_CRD_DN, BTN_VAC, BTN_DOWN } control_btn_t;
+
+static const struct {
+    uint8_t col, row, row_span;
+} control_cells[] = {
+    [BTN_UP]     = { 1, 0, 1 },
+    [BTN_CRD_UP] = { 2, 3, 2 },
+    [BTN_CRD_DN] = { 0, 3, 2 },
+    [BTN_VAC]    = { 1, 3, 2 },
+    [BTN_DOWN]   = { 1, 7, 1 },
+};
+
+static lv_area_t flushed[FLUSH_MAX];
+static uint32_t flushed_count;
+
+// What the flushes of a run cost, sent the way display_push_colors() sends them
+typedef struct {
+    uint32_t        flushes;
+    uint64_t        pixel_bytes;
+    uint32_t        transactions;
+    uint64_t        wire_bytes;
+} replay_cost_t;
+
+static replay_cost_t cost;
+static uint32_t last_caset = UINT32_MAX;
+static uint32_t last_raset = UINT32_MAX;
+
+static void flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    (void)drv;
+    (void)color_p;
+    if (flushed_count < FLUSH_MAX) {
+        flushed[flushed_count++] = *area;
+    }
+    // unchanged column/row bounds are skipped, then RAMWR with the pixels
+    uint32_t caset = (uint32_t)area->x1 << 16 | (uint16_t)area->x2;
+    uint32_t raset = (uint32_t)area->y1 << 16 | (uint16_t)area->y2;
+    uint32_t px = lv_area_get_size(area);
+    cost.flushes++;
+    cost.pixel_bytes += px * 2;
+    cost.wire_bytes += px * 2 + 4;
+    cost.transactions++;
+    if (caset != last_caset) {
+        cost.transactions++;
+        cost.wire_bytes += 8;
+        last_caset = caset;
+    }
+    if (raset != last_raset) {
+        cost.transactions++;
+        cost.wire_bytes += 8;
+        last_raset = raset;
+    }
+}
+
+static void invalidate(lv_disp_t *disp, lv_coord_t x1, lv_coord_t y1, lv_coord_t x2, lv_coord_t y2)
+{
+    lv_area_t a = { x1, y1, x2, y2 };
+    _lv_inv_area(disp, &a);
+}
+
+static void refresh(lv_disp_t *disp)
+{
+    flushed_count = 0;
+    lv_timer_t *timer = _lv_disp_get_refr_timer(disp);
+    timer->timer_cb(timer);
+}
+
+static bool area_eq(const lv_area_t *a, lv_coord_t x1, lv_coord_t y1, lv_coord_t x2, lv_coord_t y2)
+{
+    return a->x1 == x1 && a->y1 == y1 && a->x2 == x2 && a->y2 == y2;
+}
+
+/* ---- the control screen replay ---- */
+
+// A button redrawn for a state change, with what it draws outside itself
+static void invalidate_btn(lv_disp_t *disp, control_btn_t btn)
+{
+    lv_coord_t x = COL_X(control_cells[btn].col);
+    lv_coord_t y = ROW_Y(control_cells[btn].row);
+    invalidate(disp, x - BTN_EXT, y - BTN_EXT, x + COL_W(control_cells[btn].col) - 1 + BTN_EXT,
+               y + 60 * control_cells[btn].row_span - 1 + BTN_EXT);
+}
+
+static void focus_move(lv_disp_t *disp, control_btn_t from, control_btn_t to)
+{
+    invalidate_btn(disp, from);
+    invalidate_btn(disp, to);
+    refresh(disp);
+}
+
+// A press and its release, each a redraw of the button
+static void press(lv_disp_t *disp, control_btn_t btn)
+{
+    invalidate_btn(disp, btn);
+    refresh(disp);
+    invalidate_btn(disp, btn);
+    refresh(disp);
+}
+
+static void screen_switch(lv_disp_t *disp)
+{
+    invalidate(disp, 0, 0, HOR_RES - 1, VER_RES - 1);
+    refresh(disp);
+}
+
+// An info screen's body label at (10, 50) changing text: LVGL redraws the
+// old and the new size of the label
+static void label_update(lv_disp_t *disp, lv_coord_t *w, lv_coord_t new_w, lv_coord_t h)
+{
+    invalidate(disp, 10, 50, 10 + *w - 1, 50 + h - 1);
+    invalidate(disp, 10, 50, 10 + new_w - 1, 50 + h - 1);
+    *w = new_w;
+    refresh(disp);
+}
+
+static void replay(lv_disp_t *disp)
+{
+    // boot: the control screen loads with the first button focused
+    screen_switch(disp);
+    // the joystick walks the focus around, as the keypad maps it
+    const control_btn_t walk[] = {
+        BTN_UP, BTN_VAC, BTN_CRD_UP, BTN_VAC, BTN_CRD_DN, BTN_VAC, BTN_DOWN, BTN_VAC, BTN_UP
+    };
+    for (uint32_t i = 1; i < sizeof(walk) / sizeof(walk[0]); i++) {
+        focus_move(disp, walk[i - 1], walk[i]);
+    }
+    // crane up and down, crowd in and out, a few times each
+    for (int i = 0; i < 5; i++) {
+        press(disp, BTN_UP);
+        focus_move(disp, BTN_UP, BTN_VAC);
+        focus_move(disp, BTN_VAC, BTN_CRD_UP);
+        press(disp, BTN_CRD_UP);
+        focus_move(disp, BTN_CRD_UP, BTN_VAC);
+        focus_move(disp, BTN_VAC, BTN_CRD_DN);
+        press(disp, BTN_CRD_DN);
+        focus_move(disp, BTN_CRD_DN, BTN_VAC);
+        focus_move(disp, BTN_VAC, BTN_DOWN);
+        press(disp, BTN_DOWN);
+        focus_move(disp, BTN_DOWN, BTN_VAC);
+        focus_move(disp, BTN_VAC, BTN_UP);
+    }
+    // vacuum on and off: the long press turns the whole background red
+    for (int i = 0; i < 2; i++) {
+        focus_move(disp, BTN_UP, BTN_VAC);
+        invalidate_btn(disp, BTN_VAC);
+        refresh(disp);
+        screen_switch(disp);
+        invalidate_btn(disp, BTN_VAC);
+        refresh(disp);
+        focus_move(disp, BTN_VAC, BTN_UP);
+    }
+    // the joystick screen for three seconds of 10 Hz updates, the system
+    // screen for five, then back
+    screen_switch(disp);
+    lv_coord_t w = 150;
+    for (int i = 0; i < 30; i++) {
+        label_update(disp, &w, (lv_coord_t)(150 + (i * 7) % 25), 85);
+    }
+    screen_switch(disp);
+    w = 170;
+    for (int i = 0; i < 5; i++) {
+        label_update(disp, &w, (lv_coord_t)(170 + (i * 11) % 30), 119);
+    }
+    screen_switch(disp);
+}
+
+static replay_cost_t replay_run(bool planned, area_planner_stats_t *stats)
+{
+    static lv_disp_draw_buf_t draw_buf = { .size = DISPLAY_BUFFER_SIZE };
+    static lv_disp_drv_t drv = { .hor_res = HOR_RES, .ver_res = VER_RES, .draw_buf = &draw_buf, .flush_cb = flush_cb };
+    lv_disp_t *disp = lv_fake_disp_create(&drv);
+    if (planned) {
+        area_planner_init(disp);
+    }
+    memset(&cost, 0, sizeof(cost));
+    last_caset = UINT32_MAX;
+    last_raset = UINT32_MAX;
+    replay(disp);
+    area_planner_get_stats(stats);
+    return cost;
+}
+
+int main(void)
+{
+    static lv_disp_draw_buf_t draw_buf = { .size = HOR_RES * STRIPE_LINES };
+    static lv_disp_drv_t drv = { .hor_res = HOR_RES, .ver_res = VER_RES, .draw_buf = &draw_buf, .flush_cb = flush_cb };
+    lv_disp_t *disp = lv_fake_disp_create(&drv);
+    area_planner_init(disp);
+    area_planner_stats_t stats;
+
+    // a small area on its own is flushed as it is
+    invalidate(disp, 1, 41, 3, 43);
+    refresh(disp);
+    CHECK_EQ(flushed_count, 1);
+    CHECK(area_eq(&flushed[0], 1, 41, 3, 43));
+    area_planner_get_stats(&stats);
+    CHECK_EQ(stats.areas, 1);
+
+    // two labels a few pixels apart become one transfer
+    invalidate(disp, 20, 100, 60, 115);
+    invalidate(disp, 20, 118, 60, 130);
+    refresh(disp);
+    CHECK_EQ(flushed_count, 1);
+    CHECK(area_eq(&flushed[0], 20, 100, 60, 130));
+    area_planner_get_stats(&stats);
+    CHECK_EQ(stats.areas, 3);
+    CHECK_EQ(stats.merged, 1);
+
+    // opposite corners: the bounding box would cost far more than a window setup
+    invalidate(disp, 0, 0, 49, 49);
+    invalidate(disp, 190, 480, 239, 535);
+    refresh(disp);
+    CHECK_EQ(flushed_count, 2);
+    area_planner_get_stats(&stats);
+    CHECK_EQ(stats.areas, 5);
+    CHECK_EQ(stats.merged, 1);
+
+    // a stripe two pixels short of the width is sent full width
+    invalidate(disp, 1, 200, 238, 219);
+    refresh(disp);
+    CHECK_EQ(flushed_count, 1);
+    CHECK(area_eq(&flushed[0], 0, 200, HOR_RES - 1, 219));
+    area_planner_get_stats(&stats);
+    CHECK_EQ(stats.widened, 1);
+
+    // three close areas collapse into one, the middle one swallowed
+    invalidate(disp, 10, 300, 30, 310);
+    invalidate(disp, 12, 305, 28, 308);
+    invalidate(disp, 10, 314, 30, 320);
+    refresh(disp);
+    CHECK_EQ(flushed_count, 1);
+    CHECK(area_eq(&flushed[0], 10, 300, 30, 320));
+
+    // a refresh with nothing invalidated plans nothing
+    area_planner_get_stats(&stats);
+    uint32_t areas = stats.areas;
+    refresh(disp);
+    CHECK_EQ(flushed_count, 0);
+    area_planner_get_stats(&stats);
+    CHECK_EQ(stats.areas, areas);
+
+    // an area taller than the draw buffer still goes out in stripes
+    invalidate(disp, 0, 0, HOR_RES - 1, 99);
+    refresh(disp);
+    CHECK_EQ(flushed_count, 3);
+    CHECK(area_eq(&flushed[2], 0, 80, HOR_RES - 1, 99));
+
+    /* ---- the control screen replay, without and with the planner ---- */
+    area_planner_stats_t unused, planned_stats;
+    replay_cost_t lvgl_only = replay_run(false, &unused);
+    replay_cost_t planned = replay_run(true, &planned_stats);
+    printf("control screen replay: %lu areas, %lu merged, %lu widened, %lu pixel times saved\n",
+           (unsigned long)planned_stats.areas, (unsigned long)planned_stats.merged,
+           (unsigned long)planned_stats.widened, (unsigned long)planned_stats.saved_px);
+    printf("  LVGL join only: %lu flushes, %llu pixel bytes, %lu transactions, %llu wire bytes\n",
+           (unsigned long)lvgl_only.flushes, (unsigned long long)lvgl_only.pixel_bytes,
+           (unsigned long)lvgl_only.transactions, (unsigned long long)lvgl_only.wire_bytes);
+    printf("  planned:        %lu flushes, %llu pixel bytes, %lu transactions, %llu wire bytes\n",
+           (unsigned long)planned.flushes, (unsigned long long)planned.pixel_bytes,
+           (unsigned long)planned.transactions, (unsigned long long)planned.wire_bytes);
+    printf("  saved:          %ld flushes, %ld transactions, %lld wire bytes\n",
+           (long)lvgl_only.flushes - (long)planned.flushes,
+           (long)lvgl_only.transactions - (long)planned.transactions,
+           (long long)lvgl_only.wire_bytes - (long long)planned.wire_bytes);
+    // every merge counted saves a flush over LVGL's own join, and none is
+    // counted that LVGL would have made anyway
+    CHECK(planned.flushes <= lvgl_only.flushes);
+    CHECK(planned.transactions <= lvgl_only.transactions);
+    CHECK_EQ(lvgl_only.flushes - planned.flushes, planned_stats.merged);
+    return TEST_RESULT();
+}
@@ -0,0 +1,203 @@
+/**
+ * @file      test_button_debounce.c
+ * @license   MIT
+ *
+ * Recorded switch bounce replayed into the button debouncer, first into the
+ * state machine on its own (exact timestamps), then as GPIO interrupts into
+ * the button task, which has to turn them into clicks, double clicks and
+ * long presses sent to the active screen.
+ */
+#include <stdlib.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "test_util.h"
+#include "host_mock.h"
+#include "lvgl_fake.h"
+#include "product_pins.h"
+#include "ui_queue.h"
+#include "button_config.h"
+
+#define DEBOUNCE_US     (20 * 1000)     // BUTTON_DEBOUNCE_US
+
+// A level change of the pin, relative to the start of the pattern
+typedef struct {
+    int32_t         at_us;
+    int             level;
+} bounce_t;
+
+// Tactile switch closing: contacts chatter for about 2 ms
+static const bounce_t press_bounce[] = {
+    { 0, 0 }, { 90, 1 }, { 150, 0 }, { 420, 1 }, { 510, 0 }, { 1130, 1 }, { 1180, 0 }, { 1950, 1 }, { 2010, 0 },
+};
+
+// Opening: shorter, but with one late rebound
+static const bounce_t release_bounce[] = {
+    { 0, 1 }, { 60, 0 }, { 130, 1 }, { 900, 0 }, { 960, 1 }, { 7200, 0 }, { 7240, 1 },
+};
+
+// A 40 us dip on the line (ESD, a relay switching next to it)
+static const bounce_t glitch[] = {
+    { 0, 0 }, { 40, 1 },
+};
+
+#define COUNT(a)    (sizeof(a) / sizeof((a)[0]))
+
+typedef struct {
+    button_debounce_t db;
+    int             level;          // the pin
+    int64_t         t;              // time of the last edge
+    uint32_t        changes;
+    int64_t         change_us[8];
+} replay_t;
+
+// What the button task does: sample the pin once the line went quiet
+static void replay_settle(replay_t *r, int64_t until)
+{
+    int64_t change_us;
+    if (r->db.settling && r->db.settle_us <= until &&
+        button_debounce_settle(&r->db, r->level, &change_us)) {
+        if (r->changes < COUNT(r->change_us)) {
+            r->change_us[r->changes] = change_us;
+        }
+        r->changes++;
+    }
+}
+
+static void replay(replay_t *r, int64_t start, const bounce_t *pattern, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int64_t t = start + pattern[i].at_us;
+        replay_settle(r, t);
+        r->level = pattern[i].level;
+        r->t = t;
+        button_debounce_edge(&r->db, t);
+    }
+}
+
+static void replay_quiet(replay_t *r, int64_t until)
+{
+    replay_settle(r, until);
+}
+
+static void sleep_us(uint32_t us)
+{
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+// Bounce into the real pin; the GPIO mock runs the ISR on every edge
+static void play(gpio_num_t gpio, const bounce_t *pattern, size_t count)
+{
+    int32_t at = 0;
+    for (size_t i = 0; i < count; i++) {
+        sleep_us((uint32_t)(pattern[i].at_us - at));
+        at = pattern[i].at_us;
+        host_gpio_set_input(gpio, pattern[i].level);
+    }
+}
+
+static void click(gpio_num_t gpio, uint32_t hold_ms)
+{
+    play(gpio, press_bounce, COUNT(press_bounce));
+    vTaskDelay(pdMS_TO_TICKS(hold_ms));
+    play(gpio, release_bounce, COUNT(release_bounce));
+}
+
+// Keys the button task sent to the active screen since the last call
+static uint32_t keys_sent(uint32_t *keys, uint32_t max)
+{
+    static uint32_t seen;
+    ui_queue_drain();
+    uint32_t n = 0;
+    for (; seen < lv_fake_event_count(); seen++) {
+        const lv_fake_event_t *e = lv_fake_event(seen);
+        if (e->code == LV_EVENT_KEY && n < max) {
+            keys[n++] = e->key;
+        }
+    }
+    return n;
+}
+
+int main(void)
+{
+    /* ---- the state machine, replayed with exact timestamps ---- */
+    replay_t r = { .level = 1 };
+
+    // one change per burst, dated at its first edge
+    replay(&r, 1000000, press_bounce, COUNT(press_bounce));
+    replay_quiet(&r, 1100000);
+    replay(&r, 1300000, release_bounce, COUNT(release_bounce));
+    replay_quiet(&r, 1400000);
+    CHECK_EQ(r.changes, 2);
+    CHECK_EQ(r.change_us[0], 1000000);
+    CHECK_EQ(r.change_us[1], 1300000);
+    CHECK(!r.db.pressed);
+
+    // the late rebound of the release is still inside the window: not sampled early
+    CHECK(r.db.settle_us == 1300000 + 7240 + DEBOUNCE_US);
+
+    // a glitch is two edges and no change
+    replay(&r, 2000000, glitch, COUNT(glitch));
+    replay_quiet(&r, 2100000);
+    CHECK_EQ(r.changes, 2);
+    CHECK(!r.db.pressed);
+
+    // the same glitch while held is no release either
+    replay(&r, 3000000, press_bounce, COUNT(press_bounce));
+    replay_quiet(&r, 3100000);
+    bounce_t up_glitch[] = { { 0, 1 }, { 40, 0 } };
+    replay(&r, 3200000, up_glitch, COUNT(up_glitch));
+    replay_quiet(&r, 3300000);
+    CHECK_EQ(r.changes, 3);
+    CHECK(r.db.pressed);
+
+    // a tap shorter than the debounce time merges into one burst and is lost,
+    // the price of sampling only once the line is quiet
+    replay(&r, 4000000, release_bounce, COUNT(release_bounce));
+    replay(&r, 4010000, press_bounce, COUNT(press_bounce));
+    replay_quiet(&r, 4100000);
+    CHECK_EQ(r.changes, 3);
+
+    /* ---- the button task, on GPIO interrupts ---- */
+    gpio_num_t boot = (gpio_num_t)BOARD_BUTTON1_PIN;
+    gpio_num_t user = (gpio_num_t)BOARD_BUTTON2_PIN;
+    uint32_t keys[8];
+    ui_queue_init();
+    button_config();
+    button_go();
+
+    click(boot, 80);
+    vTaskDelay(pdMS_TO_TICKS(450));
+    CHECK_EQ(keys_sent(keys, 8), 1);
+    CHECK_EQ(keys[0], LV_KEY_NEXT);
+
+    click(user, 60);
+    vTaskDelay(pdMS_TO_TICKS(80));
+    click(user, 60);
+    vTaskDelay(pdMS_TO_TICKS(450));
+    CHECK_EQ(keys_sent(keys, 8), 1);
+    CHECK_EQ(keys[0], LV_KEY_HOME);
+
+    click(boot, 1000);
+    vTaskDelay(pdMS_TO_TICKS(450));
+    CHECK_EQ(keys_sent(keys, 8), 1);
+    CHECK_EQ(keys[0], LV_KEY_ESC);
+
+    // glitches on both lines go unnoticed
+    for (int i = 0; i < 10; i++) {
+        play(boot, glitch, COUNT(glitch));
+        play(user, glitch, COUNT(glitch));
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    vTaskDelay(pdMS_TO_TICKS(450));
+    CHECK_EQ(keys_sent(keys, 8), 0);
+
+    button_stats_t stats;
+    button_get_stats(&stats);
+    CHECK_EQ(stats.gestures, 3);
+    CHECK_EQ(stats.changes, 8);
+    CHECK(stats.edges > stats.changes * 3);
+    CHECK_EQ(host_isr_violations(), 0);
+    return TEST_RESULT();
+}
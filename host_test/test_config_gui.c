@@ -0,0 +1,260 @@
+/**
+ * @file      test_config_gui.c
+ * @license   MIT
+ *
+ * The control screen built from the layout table against the imperative
+ * function it replaced, kept below as it was, both on the fake LVGL. Both
+ * must give the same buttons in the same grid cells with the same captions,
+ * handlers and background colours; then each build is measured in objects,
+ * local style properties, added styles and the LVGL heap model of
+ * lvgl_fake.c, and timed. Built without the render cache so only the
+ * builders differ. Then config_gui() runs as at boot and steps through the
+ * info screens, so lvgl_config.c, screen_manager.c and info_screens.c run in
+ * the host gate.
+ */
+#include <string.h>
+#include "test_util.h"
+#include "lvgl_fake.h"
+#include "esp_timer.h"
+// control_screen_build() and the button handlers are file statics
+#include "lvgl_config.c"
+
+#define BUILDS          500
+#define BUTTONS         (sizeof(control_layout) / sizeof(control_layout[0]))
+
+/* ---- config_gui() before the layout table, but for lv_scr_load() ---- */
+
+static lv_obj_t *old_background_obj;
+
+static lv_obj_t *old_control_screen_build(void)
+{
+    static lv_coord_t col_dsc[] = {75, 74, 75, LV_GRID_TEMPLATE_LAST};
+    static lv_coord_t row_dsc[] = {60, 60, 60, 60, 60, 60, 60, 60, LV_GRID_TEMPLATE_LAST};
+
+    old_background_obj = lv_obj_create(NULL);
+    lv_obj_set_size(old_background_obj, AMOLED_WIDTH, AMOLED_HEIGHT);
+    lv_obj_set_style_bg_color(old_background_obj, lv_palette_lighten(LV_PALETTE_GREY, 3), 0);
+
+    /*Create a container with grid*/
+    lv_obj_set_style_grid_column_dsc_array(old_background_obj, col_dsc, 0);
+    lv_obj_set_style_grid_row_dsc_array(old_background_obj, row_dsc, 0);
+    lv_obj_center(old_background_obj);
+    lv_obj_set_layout(old_background_obj, LV_LAYOUT_GRID);
+
+    // create the top button on the screen
+    lv_obj_t * btn = lv_btn_create(old_background_obj);
+    lv_obj_set_size(btn, 100, 50);
+    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 1, 1,
+                         LV_GRID_ALIGN_STRETCH, 0, 1);
+    lv_obj_t * label = lv_label_create(btn);
+    lv_label_set_text(label, "Up");
+    lv_obj_add_event_cb(btn, btn_up_event_cb, LV_EVENT_ALL, NULL);
+    lv_obj_center(label);
+
+    // create the right side button
+    btn = lv_btn_create(old_background_obj);
+    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 2, 1,
+                         LV_GRID_ALIGN_STRETCH, 3, 2);
+    lv_obj_add_event_cb(btn, btn_crowd_up_event_cb, LV_EVENT_ALL, NULL);
+    label = lv_label_create(btn);
+    lv_label_set_text(label, "CRD up");
+    lv_obj_center(label);
+
+    // create the left side button
+    btn = lv_btn_create(old_background_obj);
+    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 0, 1,
+                         LV_GRID_ALIGN_STRETCH, 3, 2);
+    lv_obj_add_event_cb(btn, btn_crowd_down_event_cb, LV_EVENT_ALL, NULL);
+    label = lv_label_create(btn);
+    lv_label_set_text(label, "CRD dn");
+    lv_obj_center(label);
+
+    // create the middle button
+    btn = lv_btn_create(old_background_obj);
+    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 1, 1,
+                         LV_GRID_ALIGN_STRETCH, 3, 2);
+    lv_obj_add_event_cb(btn, btn_vac_on_event_cb, LV_EVENT_ALL, NULL);
+    label = lv_label_create(btn);
+    lv_label_set_text(label, "Vac");
+    lv_obj_center(label);
+
+    // create the bottom button
+    btn = lv_btn_create(old_background_obj);
+    lv_obj_set_size(btn, 100, 50);
+    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 1, 1,
+                         LV_GRID_ALIGN_STRETCH, 7, 1);
+    label = lv_label_create(btn);
+    lv_label_set_text(label, "Down");
+    lv_obj_add_event_cb(btn, btn_down_event_cb, LV_EVENT_ALL, NULL);
+    lv_obj_center(label);
+    return old_background_obj;
+}
+
+// The old long-press handler's background change
+static void old_vac_background(bool on)
+{
+    lv_obj_set_style_bg_color(old_background_obj, on ? lv_palette_main(LV_PALETTE_RED)
+                                                     : lv_palette_lighten(LV_PALETTE_GREY, 3), 0);
+}
+
+/* ---- measuring a build ---- */
+
+typedef struct {
+    uint32_t        heap;
+    uint32_t        objects;
+    uint32_t        local_props;
+    uint32_t        local_styles;
+    uint32_t        styles_added;
+    double          build_us;
+} build_cost_t;
+
+static uint32_t lv_mem_in_use(void)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+}
+
+static build_cost_t measure(lv_obj_t *(*build)(void))
+{
+    build_cost_t cost;
+    lv_fake_stats_t st;
+    uint32_t used = lv_mem_in_use();
+    lv_fake_reset();
+    lv_obj_t *scr = build();
+    lv_fake_get_stats(&st);
+    cost.heap = lv_mem_in_use() - used;
+    cost.objects = st.objects;
+    cost.local_props = st.local_props;
+    cost.local_styles = st.local_styles;
+    cost.styles_added = st.styles_added;
+    lv_obj_del(scr);
+    CHECK_EQ(lv_mem_in_use(), used);
+
+    uint64_t t0 = test_now_ns();
+    for (int i = 0; i < BUILDS; i++) {
+        lv_obj_del(build());
+    }
+    cost.build_us = (double)(test_now_ns() - t0) / BUILDS / 1000;
+    return cost;
+}
+
+static lv_obj_t *table_build(void)
+{
+    return control_screen_build(NULL);
+}
+
+static int32_t style_num(const lv_obj_t *obj, lv_style_prop_t prop)
+{
+    return lv_obj_get_style_prop(obj, LV_PART_MAIN, prop).num;
+}
+
+static uint16_t bg_color(const lv_obj_t *obj)
+{
+    return lv_obj_get_style_bg_color(obj, LV_PART_MAIN).full;
+}
+
+static void print_cost(const char *name, const build_cost_t *c)
+{
+    printf("%-8s %2lu objects, %4lu B LVGL heap, %2lu local props in %2lu local styles, "
+           "%2lu shared styles added, %.1f us\n", name, (unsigned long)c->objects, (unsigned long)c->heap,
+           (unsigned long)c->local_props, (unsigned long)c->local_styles, (unsigned long)c->styles_added,
+           c->build_us);
+}
+
+int main(void)
+{
+    display_init();
+    lvgl_config();
+    CHECK(lv_disp_get_default() != NULL);
+
+    /* ---- the same screen ---- */
+    lv_obj_t *old_scr = old_control_screen_build();
+    lv_obj_t *new_scr = control_screen_build(NULL);
+    CHECK_EQ(lv_obj_get_child_cnt(new_scr), BUTTONS);
+    CHECK_EQ(lv_obj_get_child_cnt(old_scr), lv_obj_get_child_cnt(new_scr));
+    static const lv_style_prop_t cell[] = {
+        LV_STYLE_GRID_CELL_COLUMN_POS, LV_STYLE_GRID_CELL_COLUMN_SPAN, LV_STYLE_GRID_CELL_X_ALIGN,
+        LV_STYLE_GRID_CELL_ROW_POS, LV_STYLE_GRID_CELL_ROW_SPAN, LV_STYLE_GRID_CELL_Y_ALIGN,
+    };
+    for (uint32_t i = 0; i < BUTTONS; i++) {
+        lv_obj_t *o = lv_obj_get_child(old_scr, i);
+        lv_obj_t *n = lv_obj_get_child(new_scr, i);
+        CHECK_EQ(n->type, LV_FAKE_BTN);
+        for (size_t p = 0; p < sizeof(cell) / sizeof(cell[0]); p++) {
+            CHECK_EQ(style_num(n, cell[p]), style_num(o, cell[p]));
+        }
+        CHECK_EQ(lv_obj_get_width(n), lv_obj_get_width(o));
+        CHECK_EQ(lv_obj_get_height(n), lv_obj_get_height(o));
+        CHECK_EQ(n->event_cnt, 1);
+        CHECK(n->events[0].cb == o->events[0].cb);
+        CHECK_EQ(n->events[0].filter, LV_EVENT_ALL);
+        CHECK_EQ(lv_obj_get_child_cnt(n), 1);
+        lv_obj_t *label = lv_obj_get_child(n, 0);
+        CHECK(strcmp(lv_label_get_text(label), lv_label_get_text(lv_obj_get_child(o, 0))) == 0);
+        CHECK_EQ(style_num(label, LV_STYLE_ALIGN), LV_ALIGN_CENTER);
+    }
+    // the cells cover the same pixels: 75/74/75 columns, 60 px rows
+    CHECK_EQ(lv_obj_get_width(lv_obj_get_child(new_scr, 0)), 74);
+    CHECK_EQ(lv_obj_get_height(lv_obj_get_child(new_scr, 1)), 120);
+
+    // background idle, with the vacuum on, and off again
+    CHECK_EQ(bg_color(new_scr), bg_color(old_scr));
+    lv_obj_add_state(new_scr, CONTROL_VAC_STATE);
+    old_vac_background(true);
+    CHECK_EQ(bg_color(new_scr), lv_palette_main(LV_PALETTE_RED).full);
+    CHECK_EQ(bg_color(new_scr), bg_color(old_scr));
+    lv_obj_clear_state(new_scr, CONTROL_VAC_STATE);
+    old_vac_background(false);
+    CHECK_EQ(bg_color(new_scr), bg_color(old_scr));
+    lv_obj_del(old_scr);
+    lv_obj_del(new_scr);
+
+    /* ---- what each build costs ---- */
+    build_cost_t old_cost = measure(old_control_screen_build);
+    build_cost_t new_cost = measure(table_build);
+    print_cost("function", &old_cost);
+    print_cost("table", &new_cost);
+    CHECK_EQ(new_cost.objects, old_cost.objects);
+    // grid cells are the only per-object styling left, one local style per button
+    CHECK_EQ(new_cost.local_styles, BUTTONS);
+    CHECK_EQ(new_cost.local_props, BUTTONS * 6);
+    CHECK(old_cost.local_styles > 2 * BUTTONS);
+    CHECK_EQ(new_cost.styles_added, 2 + BUTTONS);
+    // five shared-style slots and the group nodes cost less than the
+    // labels' local styles and text copies did
+    CHECK(new_cost.heap < old_cost.heap);
+
+    /* ---- config_gui() as at boot, then through the info screens ---- */
+    lv_fake_reset();
+    config_gui();
+    CHECK_EQ(screen_manager_active(), 0);
+    lv_obj_t *control = lv_scr_act();
+    CHECK_EQ(lv_obj_get_child_cnt(control), BUTTONS);
+    CHECK(screen_manager_key_target(JOYSTICK_KEY_UP) == lv_obj_get_child(control, 0));
+    CHECK(screen_manager_key_target(JOYSTICK_KEY_PRESS) == lv_obj_get_child(control, 3));
+    // the first button added to the keypad's group has the focus
+    CHECK(lv_obj_has_state(lv_obj_get_child(control, 0), LV_STATE_FOCUSED));
+
+    screen_manager_next();
+    lv_obj_t *joystick = lv_scr_act();
+    CHECK(joystick != control);
+    CHECK_EQ(lv_obj_get_child_cnt(joystick), 2);
+    CHECK(strcmp(lv_label_get_text(lv_obj_get_child(joystick, 0)), "Joystick") == 0);
+    screen_manager_next();
+    lv_obj_t *system = lv_scr_act();
+    CHECK(strcmp(lv_label_get_text(lv_obj_get_child(system, 0)), "System") == 0);
+    // the refresh timer filled in the body as the screen was built
+    CHECK(strncmp(lv_label_get_text(lv_obj_get_child(system, 1)), "Frames", 6) == 0);
+    lv_timer_handler();
+    screen_manager_next();
+    CHECK_EQ(screen_manager_active(), 0);
+    CHECK(lv_scr_act() == control);
+
+    screen_manager_stats_t stats;
+    screen_manager_get_stats(&stats);
+    printf("config_gui: %lu builds, %lu B resident, %lu evictions\n", (unsigned long)stats.builds,
+           (unsigned long)stats.resident_bytes, (unsigned long)stats.evictions);
+    CHECK_EQ(stats.builds, 3);
+    return TEST_RESULT();
+}
@@ -0,0 +1,72 @@
+/**
+ * @file      test_display_headless.c
+ * @license   MIT
+ *
+ * The headless backend behind the amoled_driver.h API: areas land in the
+ * framebuffer where the panel would show them, completion is reported and
+ * the PPM dump holds the image.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "test_util.h"
+#include "amoled_driver.h"
+#include "display_headless.h"
+
+int main(void)
+{
+    display_init();
+    amoled_register_flush_done_task(xTaskGetCurrentTaskHandle());
+    CHECK_EQ(display_width(), AMOLED_WIDTH);
+    CHECK_EQ(display_height(), AMOLED_HEIGHT);
+
+    // a 20x10 area with a distinct value per pixel
+    uint16_t area[20 * 10];
+    for (int i = 0; i < 20 * 10; i++) {
+        area[i] = (uint16_t)(0x1000 + i);
+    }
+    display_push_colors(30, 40, 20, 10, area);
+    CHECK_EQ(ulTaskNotifyTakeIndexed(AMOLED_FLUSH_NOTIFY_INDEX, pdTRUE, 0), 1);
+
+    const uint16_t *fb = display_headless_framebuffer();
+    int wrong = 0;
+    for (int y = 0; y < AMOLED_HEIGHT; y++) {
+        for (int x = 0; x < AMOLED_WIDTH; x++) {
+            bool inside = x >= 30 && x < 50 && y >= 40 && y < 50;
+            uint16_t want = inside ? (uint16_t)(0x1000 + (y - 40) * 20 + (x - 30)) : 0;
+            wrong += fb[y * AMOLED_WIDTH + x] != want;
+        }
+    }
+    CHECK_EQ(wrong, 0);
+
+    display_headless_stats_t stats;
+    display_headless_get_stats(&stats);
+    CHECK_EQ(stats.areas, 1);
+    CHECK_EQ(stats.pixels, 200);
+
+    // the window API fills row by row and wraps at the window edge
+    uint16_t px[6] = { 1, 2, 3, 4, 5, 6 };
+    amoled_set_window(0, 0, 2, 1);
+    amoled_push_buffer(px, 6);
+    CHECK_EQ(fb[0], 1);
+    CHECK_EQ(fb[2], 3);
+    CHECK_EQ(fb[AMOLED_WIDTH], 4);
+    CHECK_EQ(fb[AMOLED_WIDTH + 2], 6);
+
+    const char *path = "test_display_headless.ppm";
+    CHECK(display_headless_dump_ppm(path));
+    FILE *f = fopen(path, "rb");
+    CHECK(f != NULL);
+    if (f) {
+        int w = 0, h = 0, max = 0;
+        CHECK_EQ(fscanf(f, "P6 %d %d %d", &w, &h, &max), 3);
+        CHECK_EQ(w, AMOLED_WIDTH);
+        CHECK_EQ(h, AMOLED_HEIGHT);
+        fseek(f, 0, SEEK_END);
+        CHECK(ftell(f) > (long)AMOLED_WIDTH * AMOLED_HEIGHT * 3);
+        fclose(f);
+    }
+    remove(path);
+    return TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+/**
+ * @file      test_display_rotate.c
+ * @license   MIT
+ *
+ * display_rotate_copy() against a per-pixel reference for every rotation,
+ * with and without mirroring, on sizes that are not tile multiples; then a
+ * full-screen 90 degree benchmark against the per-pixel loop the driver
+ * used before the tiled kernel.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "test_util.h"
+#include "display_rotate.h"
+
+#define SCREEN_W        240
+#define SCREEN_H        536
+#define BENCH_ROUNDS    50
+
+// Source pixel shown at destination (dx, dy)
+static uint16_t reference(const uint16_t *src, int w, int h, int dx, int dy,
+                          display_rotation_t rotation, bool mirror)
+{
+    int dst_w = (rotation == DISPLAY_ROTATE_90 || rotation == DISPLAY_ROTATE_270) ? h : w;
+    if (mirror) {
+        dx = dst_w - 1 - dx;
+    }
+    int sx, sy;
+    switch (rotation) {
+    case DISPLAY_ROTATE_90:
+        sx = dy;
+        sy = h - 1 - dx;
+        break;
+    case DISPLAY_ROTATE_180:
+        sx = w - 1 - dx;
+        sy = h - 1 - dy;
+        break;
+    case DISPLAY_ROTATE_270:
+        sx = w - 1 - dy;
+        sy = dx;
+        break;
+    default:
+        sx = dx;
+        sy = dy;
+        break;
+    }
+    return src[sy * w + sx];
+}
+
+static int check_rotation(int w, int h, display_rotation_t rotation, bool mirror)
+{
+    uint16_t *src = malloc((size_t)w * h * sizeof(uint16_t));
+    uint16_t *dst = malloc((size_t)w * h * sizeof(uint16_t));
+    for (int i = 0; i < w * h; i++) {
+        src[i] = (uint16_t)(i * 2654435761u >> 16);
+    }
+    display_rotate_copy(dst, src, (uint16_t)w, (uint16_t)h, rotation, mirror);
+    bool swap = rotation == DISPLAY_ROTATE_90 || rotation == DISPLAY_ROTATE_270;
+    int dst_w = swap ? h : w;
+    int dst_h = swap ? w : h;
+    int wrong = 0;
+    for (int dy = 0; dy < dst_h; dy++) {
+        for (int dx = 0; dx < dst_w; dx++) {
+            wrong += dst[dy * dst_w + dx] != reference(src, w, h, dx, dy, rotation, mirror);
+        }
+    }
+    free(src);
+    free(dst);
+    return wrong;
+}
+
+// The loop display_push_colors() ran for every area before the tiled kernel
+static void per_pixel_rotate_90(uint16_t *dst, const uint16_t *p, uint16_t width, uint16_t hight)
+{
+    uint32_t cum = 0;
+    for (uint16_t j = 0; j < width; j++) {
+        for (uint16_t i = 0; i < hight; i++) {
+            dst[cum] = ((uint16_t)p[width * (hight - i - 1) + j]);
+            cum++;
+        }
+    }
+}
+
+int main(void)
+{
+    static const int sizes[][2] = { { 1, 1 }, { 16, 16 }, { 17, 5 }, { 33, 40 }, { 240, 40 }, { 5, 61 } };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (int r = DISPLAY_ROTATE_0; r <= DISPLAY_ROTATE_270; r++) {
+            CHECK_EQ(check_rotation(sizes[s][0], sizes[s][1], (display_rotation_t)r, false), 0);
+            CHECK_EQ(check_rotation(sizes[s][0], sizes[s][1], (display_rotation_t)r, true), 0);
+        }
+    }
+
+    uint32_t px = SCREEN_W * SCREEN_H;
+    uint16_t *src = malloc(px * sizeof(uint16_t));
+    uint16_t *tiled = malloc(px * sizeof(uint16_t));
+    uint16_t *old = malloc(px * sizeof(uint16_t));
+    for (uint32_t i = 0; i < px; i++) {
+        src[i] = (uint16_t)i;
+    }
+
+    // same output as the old loop
+    display_rotate_copy(tiled, src, SCREEN_W, SCREEN_H, DISPLAY_ROTATE_90, false);
+    per_pixel_rotate_90(old, src, SCREEN_W, SCREEN_H);
+    CHECK(memcmp(tiled, old, px * sizeof(uint16_t)) == 0);
+
+    uint64_t best_tiled = UINT64_MAX, best_old = UINT64_MAX;
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        uint64_t t0 = test_now_ns();
+        display_rotate_copy(tiled, src, SCREEN_W, SCREEN_H, DISPLAY_ROTATE_90, false);
+        uint64_t t1 = test_now_ns();
+        per_pixel_rotate_90(old, src, SCREEN_W, SCREEN_H);
+        uint64_t t2 = test_now_ns();
+        best_tiled = t1 - t0 < best_tiled ? t1 - t0 : best_tiled;
+        best_old = t2 - t1 < best_old ? t2 - t1 : best_old;
+    }
+    printf("rotate 90, %dx%d, best of %d: tiled %llu us, per-pixel %llu us (%.2fx)\n",
+           SCREEN_W, SCREEN_H, BENCH_ROUNDS, (unsigned long long)(best_tiled / 1000),
+           (unsigned long long)(best_old / 1000), (double)best_old / (double)best_tiled);
+
+    free(src);
+    free(tiled);
+    free(old);
+    return TEST_RESULT();
+}
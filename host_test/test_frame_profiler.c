@@ -0,0 +1,98 @@
+/**
+ * @file      test_frame_profiler.c
+ * @license   MIT
+ *
+ * The frame profiler's statistics: min/avg/p99/max over the last ring of
+ * samples, p99 by nearest rank so a single spike only shows in max, and the
+ * fps window. Then the cost of recording, which runs several times per
+ * area in the LVGL task, and of computing the statistics.
+ */
+#include <stdlib.h>
+#include "test_util.h"
+#include "esp_timer.h"
+#include "frame_profiler.h"
+
+#define RING_LEN        128     // PROFILER_RING_LEN
+#define BENCH_RECORDS   1000000
+#define BENCH_STATS     1000
+
+static void record_us(frame_stage_t stage, uint32_t us)
+{
+    frame_profiler_record(stage, 1000, 1000 + us);
+}
+
+int main(void)
+{
+    frame_stage_stats_t stats;
+
+    CHECK(frame_profiler_get_stats(FRAME_STAGE_RENDER, &stats));
+    CHECK_EQ(stats.samples, 0);
+
+    // 1..100 in a scrambled order
+    for (uint32_t i = 0; i < 100; i++) {
+        record_us(FRAME_STAGE_RENDER, (i * 37) % 100 + 1);
+    }
+    frame_profiler_get_stats(FRAME_STAGE_RENDER, &stats);
+    CHECK_EQ(stats.samples, 100);
+    CHECK_EQ(stats.min_us, 1);
+    CHECK_EQ(stats.max_us, 100);
+    CHECK_EQ(stats.avg_us, 50);
+    CHECK_EQ(stats.p99_us, 99);
+
+    // only the last ring of samples counts
+    for (uint32_t i = 0; i < 300; i++) {
+        record_us(FRAME_STAGE_FLUSH_CB, 1000000);
+    }
+    for (uint32_t i = 1; i <= RING_LEN; i++) {
+        record_us(FRAME_STAGE_FLUSH_CB, i);
+    }
+    frame_profiler_get_stats(FRAME_STAGE_FLUSH_CB, &stats);
+    CHECK_EQ(stats.samples, RING_LEN);
+    CHECK_EQ(stats.max_us, RING_LEN);
+    CHECK_EQ(stats.p99_us, 127);
+
+    // one late frame in a ring of steady ones is max, not p99
+    for (uint32_t i = 0; i < RING_LEN - 1; i++) {
+        record_us(FRAME_STAGE_FRAME, 16000);
+    }
+    record_us(FRAME_STAGE_FRAME, 90000);
+    frame_profiler_get_stats(FRAME_STAGE_FRAME, &stats);
+    CHECK_EQ(stats.p99_us, 16000);
+    CHECK_EQ(stats.max_us, 90000);
+    // two of them are p99
+    record_us(FRAME_STAGE_FRAME, 90000);
+    frame_profiler_get_stats(FRAME_STAGE_FRAME, &stats);
+    CHECK_EQ(stats.p99_us, 90000);
+
+    // a clock going backwards between two stamps counts as zero
+    frame_profiler_record(FRAME_STAGE_ROTATE, 2000, 1000);
+    frame_profiler_get_stats(FRAME_STAGE_ROTATE, &stats);
+    CHECK_EQ(stats.max_us, 0);
+
+    // frames of the last second only
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < 10; i++) {
+        frame_profiler_frame_done(now - 2000000);
+    }
+    for (int i = 0; i < 30; i++) {
+        frame_profiler_frame_done(now - i * 1000);
+    }
+    CHECK_EQ(frame_profiler_get_fps(), 30);
+
+    uint64_t t0 = test_now_ns();
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        frame_profiler_record((frame_stage_t)(i % FRAME_STAGE_COUNT), i, i + (i & 1023));
+    }
+    uint64_t t1 = test_now_ns();
+    for (uint32_t i = 0; i < BENCH_STATS; i++) {
+        frame_profiler_get_stats((frame_stage_t)(i % FRAME_STAGE_COUNT), &stats);
+    }
+    uint64_t t2 = test_now_ns();
+    double record_ns = (double)(t1 - t0) / BENCH_RECORDS;
+    double stats_us = (double)(t2 - t1) / BENCH_STATS / 1000.0;
+    printf("frame_profiler_record %.1f ns, frame_profiler_get_stats %.1f us\n", record_ns, stats_us);
+    // generous bounds: recording must stay negligible next to a flush
+    CHECK(record_ns < 200.0);
+    CHECK(stats_us < 500.0);
+    return TEST_RESULT();
+}
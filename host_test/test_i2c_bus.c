@@ -0,0 +1,324 @@
+/**
+ * @file      test_i2c_bus.c
+ * @license   MIT
+ *
+ * The I2C bus manager on the simulated bus, devices with their own transfer
+ * times: back-to-back reads coalesce into one transfer and a write keeps
+ * them apart, control input goes ahead of telemetry, equal priorities take
+ * turns, a saturating control device cannot starve the PMU past the aging
+ * time, and the joystick's worst-case latency under PMU load stays around
+ * one PMU transfer. The bus task is the only one on the bus throughout.
+ */
+#include <pthread.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "test_util.h"
+#include "esp_timer.h"
+#include "host_mock.h"
+#include "i2c_bus_manager.h"
+
+#define JOYSTICK_ADDR   0x20
+#define PMU_ADDR        0x34
+#define SENSOR_ADDR     0x51
+#define SLOW_ADDR       0x60    // keeps the bus task busy while work is queued
+
+#define JOYSTICK_US     100
+#define PMU_US          400
+#define SENSOR_US       200
+#define SLOW_US         20000
+#define AGE_US          20000   // I2C_BUS_AGE_US
+
+#define LOG_MAX         64
+#define SUBMITTERS      4
+#define SUBMITS         2000
+
+static i2c_bus_dev_handle_t joystick, pmu, sensor, slow;
+
+/* ---- completion order ---- */
+
+static i2c_bus_dev_handle_t done_log[LOG_MAX];
+static volatile uint32_t done_count;
+
+static void log_done(i2c_bus_txn_t *txn)
+{
+    uint32_t n = done_count;
+    if (n < LOG_MAX) {
+        done_log[n] = (i2c_bus_dev_handle_t)txn->user_ctx;
+    }
+    __atomic_store_n(&done_count, n + 1, __ATOMIC_SEQ_CST);
+}
+
+static void wait_done(uint32_t count)
+{
+    for (int i = 0; i < 2000 && __atomic_load_n(&done_count, __ATOMIC_SEQ_CST) < count; i++) {
+        vTaskDelay(1);
+    }
+}
+
+static i2c_bus_txn_t txns[LOG_MAX];
+static uint8_t bufs[LOG_MAX][16];
+static uint32_t txn_next;
+
+static esp_err_t submit(i2c_bus_dev_handle_t dev, bool write, uint8_t reg, uint8_t len)
+{
+    uint32_t n = txn_next++ % LOG_MAX;
+    txns[n] = (i2c_bus_txn_t){
+        .reg = reg,
+        .write = write,
+        .data = bufs[n],
+        .len = len,
+        .timeout_ms = 50,
+        .done_cb = log_done,
+        .user_ctx = dev,
+    };
+    return i2c_bus_submit(dev, &txns[n]);
+}
+
+// The bus task is inside a SLOW_US transfer when this returns
+static void occupy_bus(void)
+{
+    done_count = 0;
+    txn_next = 0;
+    CHECK_EQ(submit(slow, false, 0, 1), ESP_OK);
+    vTaskDelay(pdMS_TO_TICKS(2));
+}
+
+/* ---- a device that keeps its queue full from the completion callback ---- */
+
+typedef struct {
+    i2c_bus_dev_handle_t dev;
+    i2c_bus_txn_t   txn[2];
+    uint8_t         buf[2][4];
+    volatile bool   stop;
+    volatile uint32_t done;
+} hog_t;
+
+static void hog_done(i2c_bus_txn_t *txn)
+{
+    hog_t *hog = (hog_t *)txn->user_ctx;
+    hog->done++;
+    if (!hog->stop) {
+        i2c_bus_submit(hog->dev, txn);
+    }
+}
+
+static void hog_start(hog_t *hog, i2c_bus_dev_handle_t dev)
+{
+    memset(hog, 0, sizeof(*hog));
+    hog->dev = dev;
+    for (int i = 0; i < 2; i++) {
+        hog->txn[i] = (i2c_bus_txn_t){
+            .reg = 0x10,
+            .data = hog->buf[i],
+            .len = 4,
+            .timeout_ms = 50,
+            .done_cb = hog_done,
+            .user_ctx = hog,
+        };
+        i2c_bus_submit(dev, &hog->txn[i]);
+    }
+}
+
+static void hog_stop(hog_t *hog)
+{
+    hog->stop = true;
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+/* ---- tasks submitting to the same device at once ---- */
+
+typedef struct {
+    i2c_bus_txn_t   txn;
+    uint8_t         buf[1];
+    uint32_t        rejected;
+} submitter_t;
+
+static void *submitter(void *arg)
+{
+    submitter_t *sub = (submitter_t *)arg;
+    sub->txn = (i2c_bus_txn_t){ .reg = 0x00, .write = true, .data = sub->buf, .len = 1, .timeout_ms = 50 };
+    for (int i = 0; i < SUBMITS; i++) {
+        // the bus task only reads the transaction, queueing it again is fine
+        sub->rejected += i2c_bus_submit(sensor, &sub->txn) == ESP_ERR_NO_MEM;
+    }
+    return NULL;
+}
+
+static void stats_delta(i2c_bus_dev_handle_t dev, const i2c_bus_dev_stats_t *before, i2c_bus_dev_stats_t *delta)
+{
+    i2c_bus_get_stats(dev, delta);
+    delta->transactions -= before->transactions;
+    delta->transfers -= before->transfers;
+    delta->coalesced -= before->coalesced;
+    delta->aged -= before->aged;
+}
+
+int main(void)
+{
+    i2c_master_bus_handle_t bus;
+    i2c_master_bus_config_t bus_config = { 0 };
+    i2c_bus_dev_stats_t s0, s;
+
+    uint8_t *pmu_regs = host_i2c_add(PMU_ADDR);
+    for (int i = 0; i < 256; i++) {
+        pmu_regs[i] = (uint8_t)(i ^ 0xA5);
+    }
+    host_i2c_set_latency(JOYSTICK_ADDR, JOYSTICK_US);
+    host_i2c_set_latency(PMU_ADDR, PMU_US);
+    host_i2c_set_latency(SENSOR_ADDR, SENSOR_US);
+    host_i2c_set_latency(SLOW_ADDR, SLOW_US);
+    CHECK_EQ(i2c_new_master_bus(&bus_config, &bus), ESP_OK);
+    CHECK_EQ(i2c_bus_manager_init(bus), ESP_OK);
+    CHECK_EQ(i2c_bus_add_device(SLOW_ADDR, 100000, I2C_BUS_PRIO_TELEMETRY, "slow", &slow), ESP_OK);
+    CHECK_EQ(i2c_bus_add_device(PMU_ADDR, 400000, I2C_BUS_PRIO_TELEMETRY, "pmu", &pmu), ESP_OK);
+    CHECK_EQ(i2c_bus_add_device(SENSOR_ADDR, 400000, I2C_BUS_PRIO_TELEMETRY, "sensor", &sensor), ESP_OK);
+    CHECK_EQ(i2c_bus_add_device(JOYSTICK_ADDR, 400000, I2C_BUS_PRIO_CONTROL, "joystick", &joystick), ESP_OK);
+
+    // four adjacent reads queued behind a busy bus: one 16 byte transfer
+    i2c_bus_get_stats(pmu, &s0);
+    occupy_bus();
+    host_i2c_reset();
+    for (uint8_t i = 0; i < 4; i++) {
+        CHECK_EQ(submit(pmu, false, 0x40 + i * 4, 4), ESP_OK);
+    }
+    wait_done(5);
+    CHECK_EQ(host_i2c_transfers(PMU_ADDR), 1);
+    CHECK_EQ(host_i2c_bytes_read(PMU_ADDR), 16);
+    stats_delta(pmu, &s0, &s);
+    CHECK_EQ(s.transactions, 4);
+    CHECK_EQ(s.coalesced, 3);
+    bool data_ok = true;
+    for (int t = 1; t <= 4; t++) {
+        for (int i = 0; i < 4; i++) {
+            data_ok = data_ok && bufs[t][i] == (uint8_t)((txns[t].reg + i) ^ 0xA5);
+        }
+        data_ok = data_ok && txns[t].err == ESP_OK;
+    }
+    CHECK(data_ok);
+
+    // a write splits them, and the read after it sees the new value
+    occupy_bus();
+    host_i2c_reset();
+    CHECK_EQ(submit(pmu, false, 0x80, 2), ESP_OK);
+    bufs[txn_next][0] = 0x77;
+    CHECK_EQ(submit(pmu, true, 0x81, 1), ESP_OK);
+    CHECK_EQ(submit(pmu, false, 0x80, 2), ESP_OK);
+    wait_done(4);
+    CHECK_EQ(host_i2c_transfers(PMU_ADDR), 3);
+    CHECK_EQ(bufs[1][1], (uint8_t)(0x81 ^ 0xA5));
+    CHECK_EQ(bufs[3][1], 0x77);
+
+    // registers further apart than one transfer are read separately
+    occupy_bus();
+    host_i2c_reset();
+    CHECK_EQ(submit(pmu, false, 0x00, 2), ESP_OK);
+    CHECK_EQ(submit(pmu, false, 0x20, 2), ESP_OK);
+    wait_done(3);
+    CHECK_EQ(host_i2c_transfers(PMU_ADDR), 2);
+
+    // a full device queue rejects the transaction and counts it
+    i2c_bus_get_stats(sensor, &s0);
+    occupy_bus();
+    for (int i = 0; i < I2C_BUS_DEV_QUEUE_LEN; i++) {
+        CHECK_EQ(submit(sensor, true, 0x00, 1), ESP_OK);
+    }
+    CHECK_EQ(submit(sensor, true, 0x00, 1), ESP_ERR_NO_MEM);
+    wait_done(1 + I2C_BUS_DEV_QUEUE_LEN);
+    i2c_bus_get_stats(sensor, &s);
+    CHECK_EQ(s.dropped - s0.dropped, 1);
+
+    // every rejection counted when several tasks hit the full queue together
+    i2c_bus_get_stats(sensor, &s0);
+    occupy_bus();
+    for (int i = 0; i < I2C_BUS_DEV_QUEUE_LEN; i++) {
+        CHECK_EQ(submit(sensor, true, 0x00, 1), ESP_OK);
+    }
+    static submitter_t subs[SUBMITTERS];
+    pthread_t threads[SUBMITTERS];
+    for (int i = 0; i < SUBMITTERS; i++) {
+        pthread_create(&threads[i], NULL, submitter, &subs[i]);
+    }
+    uint32_t rejected = 0;
+    for (int i = 0; i < SUBMITTERS; i++) {
+        pthread_join(threads[i], NULL);
+        rejected += subs[i].rejected;
+    }
+    vTaskDelay(pdMS_TO_TICKS(SLOW_US / 1000 + 20));
+    i2c_bus_get_stats(sensor, &s);
+    printf("%d tasks submitting to a full queue: %lu rejected, %lu counted\n", SUBMITTERS,
+           (unsigned long)rejected, (unsigned long)(s.dropped - s0.dropped));
+    CHECK(rejected > 0);
+    CHECK_EQ(s.dropped - s0.dropped, rejected);
+
+    // control first, then the two telemetry devices take turns; writes so
+    // nothing coalesces
+    occupy_bus();
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ(submit(pmu, true, 0x90, 1), ESP_OK);
+        CHECK_EQ(submit(sensor, true, 0x90, 1), ESP_OK);
+    }
+    CHECK_EQ(submit(joystick, false, 0x03, 5), ESP_OK);
+    wait_done(8);
+    CHECK(done_log[0] == slow);
+    CHECK(done_log[1] == joystick);
+    uint32_t alternations = 0;
+    for (int i = 2; i < 7; i++) {
+        alternations += done_log[i] != done_log[i + 1];
+    }
+    CHECK_EQ(alternations, 5);
+
+    // the joystick saturates the bus: the PMU still gets it within the aging time
+    hog_t hog;
+    i2c_bus_get_stats(pmu, &s0);
+    hog_start(&hog, joystick);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    int64_t worst_us = 0;
+    uint32_t pmu_reads = 0;
+    int64_t end = esp_timer_get_time() + 300000;
+    while (esp_timer_get_time() < end) {
+        uint8_t v;
+        int64_t t0 = esp_timer_get_time();
+        CHECK_EQ(i2c_bus_read_reg(pmu, 0x00, &v, 1, 50), ESP_OK);
+        int64_t waited = esp_timer_get_time() - t0;
+        worst_us = waited > worst_us ? waited : worst_us;
+        pmu_reads++;
+    }
+    hog_stop(&hog);
+    stats_delta(pmu, &s0, &s);
+    printf("joystick hogging: %lu joystick transfers, %lu PMU reads, worst PMU wait %lld us\n",
+           (unsigned long)hog.done, (unsigned long)pmu_reads, (long long)worst_us);
+    CHECK(pmu_reads >= 5);
+    CHECK_EQ(s.aged, pmu_reads);
+    CHECK(worst_us < AGE_US + 10000);
+    CHECK(hog.done > pmu_reads * 10);
+
+    // the PMU saturates the bus: the joystick waits for one PMU transfer at
+    // most, timed by the bus task from submit to done
+    i2c_bus_get_stats(joystick, &s0);
+    hog_start(&hog, pmu);
+    int64_t joystick_worst = 0;
+    for (int i = 0; i < 100; i++) {
+        done_count = 0;
+        txn_next = 0;
+        CHECK_EQ(submit(joystick, false, 0x03, 5), ESP_OK);
+        wait_done(1);
+        int64_t waited = txns[0].done_us - txns[0].submit_us;
+        joystick_worst = waited > joystick_worst ? waited : joystick_worst;
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    hog_stop(&hog);
+    stats_delta(joystick, &s0, &s);
+    i2c_bus_get_stats(pmu, &s0);
+    printf("PMU hogging: %lu PMU transfers, joystick worst %lld us, PMU bus %u%%\n",
+           (unsigned long)hog.done, (long long)joystick_worst, s0.utilisation_pct);
+    CHECK_EQ(s.transactions, 100);
+    CHECK_EQ(s.aged, 0);
+    // one PMU transfer ahead of it plus its own, with room for host scheduling
+    CHECK(joystick_worst < PMU_US + JOYSTICK_US + 3000);
+    CHECK(hog.done > 100);
+
+    i2c_bus_log_stats();
+    CHECK_EQ(host_i2c_overlaps(), 0);
+    return TEST_RESULT();
+}
@@ -0,0 +1,46 @@
+/**
+ * @file      test_init_script.c
+ * @license   MIT
+ *
+ * The packed init scripts generated by gen_init_script.py decode back to the
+ * lcd_cmd_t tables they were made from: same commands, flags and parameter
+ * bytes, in the same order, with nothing left over.
+ */
+#include <string.h>
+#include "test_util.h"
+#include "initSequence.h"
+
+static void check_script(const char *name, const lcd_cmd_t *table, uint32_t entries,
+                         const uint8_t *script, uint32_t size)
+{
+    uint32_t pos = 0;
+    uint32_t i = 0;
+    while (pos + 2 <= size && i < entries) {
+        const lcd_cmd_t *cmd = &table[i++];
+        uint32_t count = script[pos + 1] & 0x1F;
+        if (((uint32_t)script[pos] << 8) != cmd->addr || script[pos + 1] != cmd->len ||
+                pos + 2 + count > size || memcmp(&script[pos + 2], cmd->param, count) != 0) {
+            fprintf(stderr, "%s: entry %u (0x%04x) differs\n", name, (unsigned)(i - 1), (unsigned)cmd->addr);
+            test_failures++;
+            return;
+        }
+        pos += 2 + count;
+    }
+    CHECK_EQ(i, entries);
+    CHECK_EQ(pos, size);
+}
+
+int main(void)
+{
+    check_script("sh8501", sh8501_cmd, SH8501_INIT_SEQUENCE_LENGHT, sh8501_script, sh8501_script_size);
+    check_script("rm67162", rm67162_cmd, RM67162_INIT_SEQUENCE_LENGHT, rm67162_script, rm67162_script_size);
+    check_script("rm690b0", rm690b0_cmd, RM690B0_INIT_SEQUENCE_LENGHT, rm690b0_script, rm690b0_script_size);
+
+    // the point of packing: the scripts are much smaller than the tables
+    uint32_t packed = sh8501_script_size + rm67162_script_size + rm690b0_script_size;
+    uint32_t table = (SH8501_INIT_SEQUENCE_LENGHT + RM67162_INIT_SEQUENCE_LENGHT +
+                      RM690B0_INIT_SEQUENCE_LENGHT) * sizeof(lcd_cmd_t);
+    printf("init scripts %u bytes, tables %u bytes\n", (unsigned)packed, (unsigned)table);
+    CHECK(packed * 4 < table);
+    return TEST_RESULT();
+}
@@ -0,0 +1,145 @@
+/**
+ * @file      test_joystick_burst.c
+ * @license   MIT
+ *
+ * The joystick's sample read against an I2C register file at 0x20, through
+ * the bus manager: one transfer of registers 0x03-0x07 per sample, both axes
+ * assembled at full resolution from their left-aligned MSB/LSB pairs with
+ * the unused low bits ignored, and the same values as reading the registers
+ * one at a time. Then the joystick task sampling on its own, still one
+ * transfer per sample.
+ */
+#include <time.h>
+#include "test_util.h"
+#include "host_mock.h"
+// joystick_read_sample() and the sample statistics are file statics
+#include "joystick_config.c"
+
+#define JOYSTICK_ADDR   0x20
+#define BUS_LATENCY_US  100     // one short transfer at 400 kHz
+#define SAMPLE_REGS     (JOYSTICK_BUTTON - JOYSTICK_X_MSB + 1)
+
+static uint8_t *regs;
+static i2c_bus_dev_handle_t dev;
+
+// What the joystick's ADC puts in the registers: the value left aligned, noise below it
+static void set_axis(uint8_t msb_reg, uint16_t value, uint8_t noise)
+{
+    uint16_t aligned = value << (16 - JOYSTICK_AXIS_BITS);
+    regs[msb_reg] = aligned >> 8;
+    regs[msb_reg + 1] = (aligned & 0xFF) | (noise & ((1 << (16 - JOYSTICK_AXIS_BITS)) - 1));
+}
+
+static void set_stick(uint16_t x, uint16_t y, bool pressed, uint8_t noise)
+{
+    set_axis(JOYSTICK_X_MSB, x, noise);
+    set_axis(JOYSTICK_Y_MSB, y, noise ^ 0x2A);
+    regs[JOYSTICK_BUTTON] = pressed ? 0 : 1;
+}
+
+// The old way, one transaction per register
+static joystick_struct_t read_each(void)
+{
+    uint8_t r[SAMPLE_REGS];
+    for (uint8_t i = 0; i < SAMPLE_REGS; i++) {
+        CHECK_EQ(i2c_bus_read_reg(dev, JOYSTICK_X_MSB + i, &r[i], 1, JOYSTICK_I2C_TIMEOUT_MS), ESP_OK);
+    }
+    return (joystick_struct_t){
+        .x = joystick_axis(r[0], r[1]),
+        .y = joystick_axis(r[2], r[3]),
+        .pressed = r[4] == 1 ? 0 : 1,
+    };
+}
+
+int main(void)
+{
+    i2c_master_bus_handle_t bus;
+    joystick_struct_t s = { 0 };
+
+    regs = host_i2c_add(JOYSTICK_ADDR);
+    regs[JOYSTICK_ID] = 0x0C;
+    regs[JOYSTICK_STATUS] = 0x5A;
+    CHECK_EQ(i2c_driver_init(&bus), ESP_OK);
+    CHECK_EQ(i2c_bus_manager_init(bus), ESP_OK);
+    CHECK_EQ(i2c_bus_add_device(JOYSTICK_ADDR, I2C_MASTER_FREQ_HZ, I2C_BUS_PRIO_CONTROL, "joystick", &dev), ESP_OK);
+    host_i2c_reset();
+
+    // one transfer of five bytes, starting at X MSB
+    set_stick(0x2AB, 0x155, false, 0x3F);
+    CHECK_EQ(joystick_read_sample(dev, &s), ESP_OK);
+    CHECK_EQ(s.x, 0x2AB);
+    CHECK_EQ(s.y, 0x155);
+    CHECK_EQ(s.pressed, 0);
+    CHECK_EQ(host_i2c_transfers(JOYSTICK_ADDR), 1);
+    CHECK_EQ(host_i2c_bytes_read(JOYSTICK_ADDR), SAMPLE_REGS);
+
+    // the button register reads 0 while pressed; anything else but 1 too
+    set_stick(0, JOYSTICK_AXIS_MAX, true, 0);
+    CHECK_EQ(joystick_read_sample(dev, &s), ESP_OK);
+    CHECK_EQ(s.x, 0);
+    CHECK_EQ(s.y, JOYSTICK_AXIS_MAX);
+    CHECK_EQ(s.pressed, 1);
+    regs[JOYSTICK_BUTTON] = 0xFF;
+    CHECK_EQ(joystick_read_sample(dev, &s), ESP_OK);
+    CHECK_EQ(s.pressed, 1);
+
+    // every value of both axes, under every pattern of the unused bits, and
+    // the same as register by register
+    host_i2c_reset();
+    uint32_t wrong = 0;
+    uint32_t differs = 0;
+    uint32_t samples = 0;
+    for (uint16_t v = 0; v <= JOYSTICK_AXIS_MAX; v++) {
+        uint16_t w = JOYSTICK_AXIS_MAX - v;
+        set_stick(v, w, v & 1, (uint8_t)(v * 13));
+        CHECK_EQ(joystick_read_sample(dev, &s), ESP_OK);
+        samples++;
+        wrong += s.x != v || s.y != w || s.pressed != (v & 1);
+        if (v % 64 == 0) {
+            joystick_struct_t e = read_each();
+            differs += e.x != s.x || e.y != s.y || e.pressed != s.pressed;
+        }
+    }
+    CHECK_EQ(wrong, 0);
+    CHECK_EQ(differs, 0);
+    uint32_t each_reads = (JOYSTICK_AXIS_MAX + 1) / 64;
+    CHECK_EQ(host_i2c_transfers(JOYSTICK_ADDR), samples + each_reads * SAMPLE_REGS);
+    CHECK_EQ(host_i2c_bytes_read(JOYSTICK_ADDR), (samples + each_reads) * SAMPLE_REGS);
+    // the registers around the sample are neither read nor written
+    CHECK_EQ(regs[JOYSTICK_ID], 0x0C);
+    CHECK_EQ(regs[JOYSTICK_STATUS], 0x5A);
+
+    // with a realistic bus time a sample costs one transfer instead of five
+    host_i2c_set_latency(JOYSTICK_ADDR, BUS_LATENCY_US);
+    uint64_t t0 = test_now_ns();
+    for (int i = 0; i < 50; i++) {
+        joystick_read_sample(dev, &s);
+    }
+    uint64_t t1 = test_now_ns();
+    for (int i = 0; i < 50; i++) {
+        read_each();
+    }
+    uint64_t t2 = test_now_ns();
+    double burst_us = (double)(t1 - t0) / 50 / 1000.0;
+    double each_us = (double)(t2 - t1) / 50 / 1000.0;
+    printf("sample read: burst %.0f us, per register %.0f us\n", burst_us, each_us);
+    CHECK(each_us > burst_us * 2);
+
+    // the task on its own: at rest it samples at the idle rate, one transfer each
+    host_i2c_set_latency(JOYSTICK_ADDR, 0);
+    set_stick(JOYSTICK_AXIS_MID, JOYSTICK_AXIS_MID, false, 0);
+    host_i2c_reset();
+    joystick_go();
+    vTaskDelay(pdMS_TO_TICKS(300));
+    joystick_sample_stats_t stats;
+    joystick_get_sample_stats(&stats);
+    uint32_t transfers = host_i2c_transfers(JOYSTICK_ADDR);
+    CHECK(stats.samples >= 3);
+    CHECK(transfers >= stats.samples && transfers <= stats.samples + 1);
+    s = joystick_get_state();
+    CHECK_EQ(s.x, JOYSTICK_AXIS_MID);
+    CHECK_EQ(s.y, JOYSTICK_AXIS_MID);
+    CHECK_EQ(s.pressed, 0);
+    CHECK_EQ(host_i2c_overlaps(), 0);
+    return TEST_RESULT();
+}
@@ -0,0 +1,201 @@
+/**
+ * @file      test_joystick_condition.c
+ * @license   MIT
+ *
+ * Joystick signal conditioning on synthetic noisy traces. At rest the
+ * deadzone keeps the output at zero; a stick hovering at the direction
+ * threshold, noisy enough to flip a bare threshold dozens of times,
+ * presses its key at most once and never releases it; a step in and out
+ * of a direction adds only a few samples of filter delay. Then reboots
+ * against NVS: a fresh calibration is stored once, the centre noise of
+ * later boots does not rewrite it, and a real drift does.
+ */
+#include <stdlib.h>
+#include "test_util.h"
+#include "host_mock.h"
+// the calibration load/save and the save policy's constants are file statics
+#include "joystick_config.c"
+
+#define HOVER_SAMPLES   4000
+#define NOISE_RAW       40      // +- raw counts, about +-9% of a half scale
+#define REBOOTS         20
+
+static uint32_t rng = 2024;
+
+static int noise(int amplitude)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return (int)((rng >> 8) % (2 * amplitude + 1)) - amplitude;
+}
+
+static uint16_t clamp_raw(int v)
+{
+    return v < 0 ? 0 : v > JOYSTICK_AXIS_MAX ? JOYSTICK_AXIS_MAX : v;
+}
+
+static joystick_struct_t step(joystick_condition_t *cond, int x, int y, bool pressed)
+{
+    joystick_struct_t s = { .x = clamp_raw(x), .y = clamp_raw(y), .pressed = pressed };
+    joystick_condition_step(cond, &s);
+    return s;
+}
+
+// Rest at (cx, cy) for the centre, then sweep every extreme so the extents are known
+static void calibrate(joystick_condition_t *cond, int cx, int cy, int jitter)
+{
+    for (int i = 0; i < JOYSTICK_CENTRE_SAMPLES; i++) {
+        step(cond, cx + noise(jitter), cy + noise(jitter), false);
+    }
+    const int corners[][2] = { { 0, cy }, { JOYSTICK_AXIS_MAX, cy }, { cx, 0 }, { cx, JOYSTICK_AXIS_MAX } };
+    for (int c = 0; c < 4; c++) {
+        for (int i = 0; i < 20; i++) {
+            step(cond, corners[c][0] + noise(jitter), corners[c][1] + noise(jitter), false);
+        }
+        for (int i = 0; i < 20; i++) {
+            step(cond, cx + noise(jitter), cy + noise(jitter), false);
+        }
+    }
+}
+
+// Raw y offset from the centre that puts ny at norm after the deadzone
+static int raw_for_ny(const joystick_condition_t *cond, int norm)
+{
+    int r = CONFIG_JOYSTICK_DEADZONE + norm * (JOYSTICK_NORM_MAX - CONFIG_JOYSTICK_DEADZONE) / JOYSTICK_NORM_MAX;
+    return r * (cond->cal.max[1] - cond->cal.centre[1]) / JOYSTICK_NORM_MAX;
+}
+
+// Samples until the up key reaches want
+static int samples_until_up(joystick_condition_t *cond, int cx, int y, bool want)
+{
+    for (int n = 1; n <= 50; n++) {
+        joystick_struct_t s = step(cond, cx, y, false);
+        if (!!(s.keys & (1 << JOYSTICK_KEY_UP)) == want) {
+            return n;
+        }
+    }
+    return 1000;
+}
+
+// The boot sequence of the task: load, learn at rest, save if the task would
+static bool boot(joystick_condition_t *cond, int cx, int cy)
+{
+    joystick_cal_load(cond);
+    for (int i = 0; i < 200; i++) {
+        step(cond, cx + noise(3), cy + noise(3), false);
+    }
+    if (cond->cal_changed && cond->centre_samples >= JOYSTICK_CENTRE_SAMPLES) {
+        joystick_cal_save(cond);
+        return true;
+    }
+    return false;
+}
+
+int main(void)
+{
+    joystick_condition_t cond;
+    const int cx = 530;     // an off-centre stick, as built
+    const int cy = 497;
+
+    /* ---- at rest: inside the deadzone, whatever the noise ---- */
+    joystick_condition_init(&cond, NULL);
+    calibrate(&cond, cx, cy, 3);
+    CHECK(abs((int)cond.cal.centre[0] - cx) <= 2);
+    CHECK(abs((int)cond.cal.centre[1] - cy) <= 2);
+    CHECK(cond.cal.min[0] <= 5 && cond.cal.max[0] >= JOYSTICK_AXIS_MAX - 5);
+    uint32_t moved = 0;
+    for (int i = 0; i < HOVER_SAMPLES; i++) {
+        joystick_struct_t s = step(&cond, cx + noise(NOISE_RAW), cy + noise(NOISE_RAW), false);
+        moved += s.nx != 0 || s.ny != 0 || s.keys != 0;
+    }
+    CHECK_EQ(moved, 0);
+
+    /* ---- hovering on the up threshold ---- */
+    int on_raw = raw_for_ny(&cond, JOYSTICK_KEY_ON);
+    int hover = cy + on_raw;
+    uint32_t bare_flips = 0;
+    bool bare = false;
+    uint32_t presses = 0;
+    uint32_t releases = 0;
+    uint8_t keys = 0;
+    for (int i = 0; i < HOVER_SAMPLES; i++) {
+        int y = hover + noise(NOISE_RAW);
+        // a bare threshold on the raw value, as the readers had
+        if ((y - cy >= on_raw) != bare) {
+            bare = !bare;
+            bare_flips++;
+        }
+        joystick_struct_t s = step(&cond, cx + noise(NOISE_RAW / 4), y, false);
+        uint8_t up = s.keys & (1 << JOYSTICK_KEY_UP);
+        presses += up && !(keys & (1 << JOYSTICK_KEY_UP));
+        releases += !up && (keys & (1 << JOYSTICK_KEY_UP));
+        keys = s.keys;
+    }
+    printf("hovering: bare threshold %lu flips, conditioned %lu presses %lu releases\n",
+           (unsigned long)bare_flips, (unsigned long)presses, (unsigned long)releases);
+    CHECK(bare_flips > 100);
+    CHECK(presses <= 1);
+    CHECK_EQ(releases, 0);
+    CHECK_EQ(keys & ~(1 << JOYSTICK_KEY_UP), 0);
+
+    /* ---- step response: delay added by the filter, in samples ---- */
+    joystick_condition_init(&cond, &cond.cal);
+    for (int i = 0; i < 50; i++) {
+        step(&cond, cx, cy, false);
+    }
+    int press_delay = samples_until_up(&cond, cx, JOYSTICK_AXIS_MAX, true);
+    int release_delay = samples_until_up(&cond, cx, cy, false);
+    int half_press_delay = samples_until_up(&cond, cx, cy + raw_for_ny(&cond, 700), true);
+    samples_until_up(&cond, cx, cy, false);
+    printf("full step: up after %d samples, released after %d; 70%% step: up after %d\n",
+           press_delay, release_delay, half_press_delay);
+    // a bare threshold sees each of these on the first sample; at 200 Hz
+    // four samples are 20 ms
+    CHECK(press_delay <= 3);
+    CHECK(release_delay <= 4);
+    CHECK(half_press_delay <= 6);
+    // the button is not filtered
+    joystick_struct_t s = step(&cond, cx, cy, true);
+    CHECK(s.keys & (1 << JOYSTICK_KEY_PRESS));
+
+    /* ---- reboots ---- */
+    host_nvs_reset();
+    // first boot: nothing stored, the learned calibration is saved once
+    CHECK(boot(&cond, cx, cy));
+    calibrate(&cond, cx, cy, 3);
+    CHECK(cond.cal_changed);
+    joystick_cal_save(&cond);
+    joystick_cal_t stored = cond.cal;
+    uint32_t writes = host_nvs_writes();
+    CHECK_EQ(writes, 2);
+
+    // later boots at rest with the usual noise, and a stick pushed a little
+    // past the stored extents: loaded, used, not written again
+    uint32_t saves = 0;
+    for (int b = 0; b < REBOOTS; b++) {
+        saves += boot(&cond, cx + noise(2), cy + noise(2));
+        CHECK_EQ(cond.saved.max[1], stored.max[1]);
+        step(&cond, cx, JOYSTICK_AXIS_MAX, false);
+        for (int i = 0; i < 20; i++) {
+            step(&cond, cx, cy, false);
+        }
+        saves += cond.cal_changed;
+    }
+    CHECK_EQ(saves, 0);
+    CHECK_EQ(host_nvs_writes(), writes);
+    // the centre learned this boot is used even when not stored
+    boot(&cond, cx + 5, cy);
+    CHECK(abs((int)cond.cal.centre[0] - (cx + 5)) <= 1);
+    CHECK_EQ(host_nvs_writes(), writes);
+
+    // the stick's centre drifted: stored again, once
+    CHECK(boot(&cond, cx + 20, cy - 15));
+    CHECK_EQ(host_nvs_writes(), writes + 1);
+    CHECK(!boot(&cond, cx + 20, cy - 15));
+    CHECK_EQ(host_nvs_writes(), writes + 1);
+    joystick_condition_t fresh;
+    joystick_cal_load(&fresh);
+    CHECK(abs((int)fresh.cal.centre[0] - (cx + 20)) <= 1);
+    CHECK(abs((int)fresh.cal.centre[1] - (cy - 15)) <= 1);
+    CHECK(!fresh.cal_changed);
+    return TEST_RESULT();
+}
@@ -0,0 +1,268 @@
+/**
+ * @file      test_joystick_keypad.c
+ * @license   MIT
+ *
+ * The joystick keypad on a trace of joystick edges, read the way LVGL 8.3
+ * reads a keypad (continue_reading loops, a paused read timer). LVGL only
+ * sees press and release transitions of the focused button, so the check
+ * is on those: every short press arrives, a new direction releases the old
+ * one first, a still-held key is pressed again, unmapped left/right switch
+ * screens without pressing anything, and a press never moves to another
+ * button while held.
+ */
+#include <string.h>
+#include "test_util.h"
+#include "lvgl_fake.h"
+#include "esp_timer.h"
+#include "joystick_config.h"
+#include "screen_manager.h"
+#include "joystick_keypad.h"
+
+#define SCREENS         2
+#define TRACE_MAX       64
+#define LOG_MAX         64
+
+/* ---- joystick edge queue and screen manager, as seen by the keypad ---- */
+
+static joystick_event_t trace[TRACE_MAX];
+static uint32_t trace_head;
+static uint32_t trace_tail;
+
+static lv_obj_t *key_targets[SCREENS][JOYSTICK_KEY_COUNT];
+static int active_screen;
+static uint32_t screen_switches;
+
+bool joystick_get_event(joystick_event_t *evt)
+{
+    if (trace_tail == trace_head) {
+        return false;
+    }
+    *evt = trace[trace_tail++ % TRACE_MAX];
+    return true;
+}
+
+lv_obj_t *screen_manager_key_target(uint8_t key)
+{
+    return key < JOYSTICK_KEY_COUNT ? key_targets[active_screen][key] : NULL;
+}
+
+void screen_manager_next(void)
+{
+    active_screen = (active_screen + 1) % SCREENS;
+    screen_switches++;
+}
+
+void screen_manager_prev(void)
+{
+    active_screen = (active_screen + SCREENS - 1) % SCREENS;
+    screen_switches++;
+}
+
+/* ---- LVGL's side ---- */
+
+static lv_indev_drv_t indev;
+static lv_timer_t *read_timer;
+static lv_indev_state_t last_state;
+static lv_obj_t *pressed_obj;
+static char log_buf[LOG_MAX][8];     // edge, target name of up to 6 characters
+static uint32_t log_count;
+static uint32_t moved_presses;      // focus changed while LVGL held a press
+
+static const char *name(lv_obj_t *obj)
+{
+    for (int s = 0; s < SCREENS; s++) {
+        for (int k = 0; k < JOYSTICK_KEY_COUNT; k++) {
+            if (key_targets[s][k] == obj) {
+                return obj->text;
+            }
+        }
+    }
+    return "?";
+}
+
+static void log_edge(char edge, lv_obj_t *obj)
+{
+    if (log_count < LOG_MAX) {
+        snprintf(log_buf[log_count++], sizeof(log_buf[0]), "%c%.6s", edge, name(obj));
+    }
+}
+
+// lv_indev.c indev_read(): read until the driver stops asking for more
+static void lvgl_read(void)
+{
+    if (read_timer->paused) {
+        return;
+    }
+    lv_indev_data_t data;
+    do {
+        memset(&data, 0, sizeof(data));
+        joystick_keypad_read(&indev, &data);
+        lv_obj_t *focused = lv_fake_focused();
+        if (data.state == LV_INDEV_STATE_PRESSED && last_state == LV_INDEV_STATE_RELEASED) {
+            pressed_obj = focused;
+            log_edge('P', focused);
+        } else if (data.state == LV_INDEV_STATE_RELEASED && last_state == LV_INDEV_STATE_PRESSED) {
+            log_edge('R', pressed_obj);
+            pressed_obj = NULL;
+        } else if (data.state == LV_INDEV_STATE_PRESSED && focused != pressed_obj) {
+            moved_presses++;
+        }
+        last_state = data.state;
+    } while (data.continue_reading);
+}
+
+// the joystick task queues edges and wakes the LVGL task, which resumes the read timer
+static void push(joystick_key_t key, bool pressed)
+{
+    trace[trace_head++ % TRACE_MAX] = (joystick_event_t){
+        .time_us = esp_timer_get_time(),
+        .key = key,
+        .pressed = pressed,
+    };
+    lv_timer_resume(read_timer);
+}
+
+static bool log_is(const char *const *expected, uint32_t count)
+{
+    bool same = log_count == count;
+    for (uint32_t i = 0; same && i < count; i++) {
+        same = strcmp(log_buf[i], expected[i]) == 0;
+    }
+    if (!same) {
+        fprintf(stderr, "log:");
+        for (uint32_t i = 0; i < log_count; i++) {
+            fprintf(stderr, " %s", log_buf[i]);
+        }
+        fprintf(stderr, "\n");
+    }
+    log_count = 0;
+    return same;
+}
+
+#define LOG_IS(...) log_is((const char *const[]){ __VA_ARGS__ }, \
+                           sizeof((const char *const[]){ __VA_ARGS__ }) / sizeof(const char *))
+
+static lv_obj_t *button(int screen, joystick_key_t key, const char *label)
+{
+    lv_obj_t *btn = lv_obj_create(NULL);
+    lv_label_set_text(btn, label);
+    key_targets[screen][key] = btn;
+    return btn;
+}
+
+int main(void)
+{
+    // screen 0: up/down/press buttons, left/right switch screens
+    button(0, JOYSTICK_KEY_UP, "A");
+    button(0, JOYSTICK_KEY_DOWN, "B");
+    button(0, JOYSTICK_KEY_PRESS, "C");
+    // screen 1: left is a button there, up goes to another one
+    button(1, JOYSTICK_KEY_LEFT, "D");
+    button(1, JOYSTICK_KEY_UP, "E");
+    read_timer = lv_timer_create(NULL, 30, NULL);
+    indev.type = LV_INDEV_TYPE_KEYPAD;
+    indev.read_timer = read_timer;
+
+    // a click shorter than the read period still reaches LVGL
+    push(JOYSTICK_KEY_UP, true);
+    push(JOYSTICK_KEY_UP, false);
+    lvgl_read();
+    CHECK(LOG_IS("PA", "RA"));
+    CHECK(read_timer->paused);
+
+    // rolling from one direction to the next in one read period
+    push(JOYSTICK_KEY_UP, true);
+    push(JOYSTICK_KEY_DOWN, true);
+    push(JOYSTICK_KEY_UP, false);
+    push(JOYSTICK_KEY_DOWN, false);
+    lvgl_read();
+    CHECK(LOG_IS("PA", "RA", "PB", "RB"));
+
+    // a tap over a held key gives the press back to the held one
+    push(JOYSTICK_KEY_DOWN, true);
+    lvgl_read();
+    push(JOYSTICK_KEY_UP, true);
+    push(JOYSTICK_KEY_UP, false);
+    lvgl_read();
+    CHECK(!read_timer->paused);
+    lvgl_read();
+    CHECK(LOG_IS("PB", "RB", "PA", "RA", "PB"));
+    push(JOYSTICK_KEY_DOWN, false);
+    lvgl_read();
+    CHECK(LOG_IS("RB"));
+    CHECK(read_timer->paused);
+
+    // right is not a button on screen 0: it switches, and does not press
+    // screen 1's left button on the way
+    push(JOYSTICK_KEY_RIGHT, true);
+    push(JOYSTICK_KEY_RIGHT, false);
+    lvgl_read();
+    CHECK_EQ(active_screen, 1);
+    CHECK_EQ(screen_switches, 1);
+    CHECK_EQ(log_count, 0);
+    push(JOYSTICK_KEY_LEFT, true);
+    push(JOYSTICK_KEY_LEFT, false);
+    lvgl_read();
+    CHECK(LOG_IS("PD", "RD"));
+    CHECK_EQ(active_screen, 1);
+
+    // the screen changes under a held key mapped on both: the press is
+    // released on the old button before the new one is pressed
+    push(JOYSTICK_KEY_UP, true);
+    lvgl_read();
+    active_screen = 0;
+    lvgl_read();
+    lvgl_read();
+    CHECK(LOG_IS("PE", "RE", "PA"));
+    push(JOYSTICK_KEY_UP, false);
+    lvgl_read();
+    CHECK(LOG_IS("RA"));
+
+    // switching screens with the stick while holding up moves the press the same way
+    push(JOYSTICK_KEY_UP, true);
+    push(JOYSTICK_KEY_RIGHT, true);
+    lvgl_read();
+    CHECK_EQ(active_screen, 1);
+    lvgl_read();
+    push(JOYSTICK_KEY_RIGHT, false);
+    push(JOYSTICK_KEY_UP, false);
+    lvgl_read();
+    CHECK(LOG_IS("PA", "RA", "PE", "RE"));
+    CHECK(read_timer->paused);
+    CHECK_EQ(moved_presses, 0);
+
+    // a long trace of random edges: presses and releases stay paired and
+    // every queued edge is consumed
+    uint32_t seed = 1;
+    uint8_t held = 0;
+    for (int i = 0; i < 2000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        joystick_key_t key = (joystick_key_t)((seed >> 16) % JOYSTICK_KEY_COUNT);
+        bool pressed = !(held & (1 << key));
+        held ^= 1 << key;
+        push(key, pressed);
+        if (((seed >> 8) & 1) || trace_head - trace_tail >= TRACE_MAX / 2) {
+            lvgl_read();
+        }
+        if (log_count > LOG_MAX / 2) {
+            log_count = 0;
+        }
+    }
+    for (joystick_key_t key = 0; key < JOYSTICK_KEY_COUNT; key++) {
+        if (held & (1 << key)) {
+            push(key, false);
+        }
+    }
+    lvgl_read();
+    lvgl_read();
+    CHECK_EQ(trace_head, trace_tail);
+    CHECK_EQ(last_state, LV_INDEV_STATE_RELEASED);
+    CHECK_EQ(moved_presses, 0);
+    CHECK(read_timer->paused);
+
+    lvgl_input_stats_t stats;
+    joystick_keypad_get_stats(&stats);
+    CHECK_EQ(stats.events, trace_head);
+    CHECK(stats.max_latency_us >= 0);
+    return TEST_RESULT();
+}
@@ -0,0 +1,188 @@
+/**
+ * @file      test_joystick_rate.c
+ * @license   MIT
+ *
+ * Adaptive joystick sampling. First joystick_next_period() on its own: the
+ * active period at once on activity, the idle delay, then doubling up to
+ * the idle period. Then the joystick task against a scripted stick in the
+ * I2C register file: idle sampling at rest, a deflection and a button
+ * press each seen within one idle period, the active rate while held, the
+ * decay after release, and the statistics that report all of it.
+ */
+#include <stdlib.h>
+#include "test_util.h"
+#include "host_mock.h"
+// joystick_next_period() and the sampling statistics are file statics
+#include "joystick_config.c"
+
+#define JOYSTICK_ADDR   0x20
+#define SAMPLES_MAX     1024
+#define SLACK_US        8000    // host timer and scheduling jitter
+
+static uint8_t *regs;
+static int64_t sample_us[SAMPLES_MAX];
+static uint32_t sample_count;
+static uint32_t last_seq;
+static uint32_t periods[16];        // sampling periods in the order the task chose them
+static uint32_t period_count;
+
+static void set_stick(uint16_t x, uint16_t y, bool pressed)
+{
+    regs[JOYSTICK_X_MSB] = (x << 6) >> 8;
+    regs[JOYSTICK_X_LSB] = (x << 6) & 0xFF;
+    regs[JOYSTICK_Y_MSB] = (y << 6) >> 8;
+    regs[JOYSTICK_Y_LSB] = (y << 6) & 0xFF;
+    regs[JOYSTICK_BUTTON] = pressed ? 0 : 1;
+}
+
+// Collect the sample times published and the periods chosen for ms milliseconds
+static void watch(uint32_t ms)
+{
+    int64_t end = esp_timer_get_time() + ms * 1000LL;
+    while (esp_timer_get_time() < end) {
+        joystick_struct_t s;
+        if (joystick_get_new_state(&last_seq, &s) && sample_count < SAMPLES_MAX) {
+            sample_us[sample_count++] = s.time_us;
+        }
+        uint32_t period = sample_stats.period_us;
+        if (period_count < 16 && (!period_count || periods[period_count - 1] != period)) {
+            periods[period_count++] = period;
+        }
+        vTaskDelay(1);
+    }
+}
+
+// First sample taken at or after t
+static uint32_t sample_after(int64_t t)
+{
+    uint32_t i = 0;
+    while (i < sample_count && sample_us[i] < t) {
+        i++;
+    }
+    return i;
+}
+
+static int cmp_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Median interval between the samples in [from, to)
+static int64_t median_interval(uint32_t from, uint32_t to)
+{
+    static int64_t d[SAMPLES_MAX];
+    uint32_t n = 0;
+    for (uint32_t i = from + 1; i < to; i++) {
+        d[n++] = sample_us[i] - sample_us[i - 1];
+    }
+    if (!n) {
+        return 0;
+    }
+    qsort(d, n, sizeof(d[0]), cmp_i64);
+    return d[n / 2];
+}
+
+// Within 20% of a period, plus a millisecond of scheduling
+static bool near(int64_t value, int64_t expected)
+{
+    return llabs(value - expected) <= expected / 5 + 1000;
+}
+
+// A movement at t is picked up by the next sample, at most one idle period later
+static int64_t detect(uint16_t x, uint16_t y, bool pressed)
+{
+    int64_t t = esp_timer_get_time();
+    set_stick(x, y, pressed);
+    watch(200);
+    uint32_t i = sample_after(t);
+    return i < sample_count ? sample_us[i] - t : INT64_MAX;
+}
+
+int main(void)
+{
+    /* ---- the rate policy ---- */
+    const uint32_t active = JOYSTICK_ACTIVE_PERIOD_US;
+    const uint32_t idle = JOYSTICK_IDLE_PERIOD_US;
+    const int64_t idle_after = CONFIG_JOYSTICK_IDLE_AFTER_MS * 1000LL;
+    CHECK_EQ(active, 5000);
+    CHECK_EQ(idle, 50000);
+    CHECK_EQ(joystick_next_period(idle, true, 0), active);
+    CHECK_EQ(joystick_next_period(active, true, idle_after * 10), active);
+    // still active rate for the idle delay after the stick comes back
+    CHECK_EQ(joystick_next_period(active, false, idle_after - 1), active);
+    uint32_t period = active;
+    uint32_t steps = 0;
+    while (period < idle && steps < 10) {
+        period = joystick_next_period(period, false, idle_after);
+        steps++;
+    }
+    CHECK_EQ(period, idle);
+    CHECK_EQ(steps, 4);     // 10, 20, 40, 50 ms
+    CHECK_EQ(joystick_next_period(idle, false, idle_after * 10), idle);
+
+    /* ---- the task on a scripted stick ---- */
+    i2c_master_bus_handle_t bus;
+    regs = host_i2c_add(JOYSTICK_ADDR);
+    set_stick(JOYSTICK_AXIS_MID, JOYSTICK_AXIS_MID, false);
+    CHECK_EQ(i2c_driver_init(&bus), ESP_OK);
+    CHECK_EQ(i2c_bus_manager_init(bus), ESP_OK);
+    joystick_go();
+
+    // at rest: the idle rate
+    watch(600);
+    uint32_t rest_end = sample_count;
+    CHECK(rest_end >= 8);
+    CHECK(near(median_interval(1, rest_end), idle));
+
+    // full left: seen within one idle period, then sampled at the active rate
+    int64_t detect_move = detect(JOYSTICK_AXIS_MAX, JOYSTICK_AXIS_MID, false);
+    CHECK(detect_move <= idle + SLACK_US);
+    uint32_t held_from = sample_count;
+    watch(300);
+    uint32_t held_to = sample_count;
+    CHECK(near(median_interval(held_from, held_to), active));
+    CHECK(held_to - held_from >= 300000 / active / 2);
+    joystick_struct_t s = joystick_get_state();
+    CHECK(s.keys & (1 << JOYSTICK_KEY_LEFT));
+
+    // released: the active rate for the idle delay, then doubling back to idle
+    int64_t released = esp_timer_get_time();
+    period_count = 0;
+    set_stick(JOYSTICK_AXIS_MID, JOYSTICK_AXIS_MID, false);
+    watch(1200);
+    uint32_t decay_from = sample_after(released);
+    CHECK(near(median_interval(decay_from, sample_after(released + idle_after - SLACK_US)), active));
+    const uint32_t decay[] = { 5000, 10000, 20000, 40000, 50000 };
+    CHECK_EQ(period_count, 5);
+    for (uint32_t i = 0; i < 5 && i < period_count; i++) {
+        CHECK_EQ(periods[i], decay[i]);
+    }
+    CHECK(near(median_interval(sample_count - 6, sample_count), idle));
+
+    // the button alone counts as activity
+    int64_t detect_press = detect(JOYSTICK_AXIS_MID, JOYSTICK_AXIS_MID, true);
+    CHECK(detect_press <= idle + SLACK_US);
+    uint32_t press_from = sample_count;
+    watch(100);
+    CHECK(near(median_interval(press_from, sample_count), active));
+    set_stick(JOYSTICK_AXIS_MID, JOYSTICK_AXIS_MID, false);
+    watch(1200);
+
+    joystick_sample_stats_t stats;
+    joystick_get_sample_stats(&stats);
+    printf("%lu samples, %lu active, %lu rate changes, detection max %lld us avg %lld us\n",
+           (unsigned long)stats.samples, (unsigned long)stats.active_samples,
+           (unsigned long)stats.rate_changes, (long long)stats.max_detect_us,
+           (long long)(stats.detections ? stats.total_detect_us / stats.detections : 0));
+    CHECK_EQ(stats.detections, 2);
+    CHECK(stats.max_detect_us <= idle + SLACK_US);
+    // 50 -> 5 ms twice, 5 -> 10 -> 20 -> 40 -> 50 ms twice
+    CHECK_EQ(stats.rate_changes, 10);
+    CHECK_EQ(stats.period_us, idle);
+    CHECK(stats.max_interval_us <= idle + SLACK_US);
+    // every sample was published
+    CHECK_EQ(joystick_get_state().seq, stats.samples);
+    return TEST_RESULT();
+}
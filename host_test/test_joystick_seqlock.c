@@ -0,0 +1,200 @@
+/**
+ * @file      test_joystick_seqlock.c
+ * @license   MIT
+ *
+ * The joystick's seqlock latch under stress. The writer publishes samples
+ * whose every field is derived from the sequence number; a reader must
+ * never see fields from two samples, nor a sequence number going
+ * backwards, and joystick_get_new_state() reports each sample to a reader
+ * at most once. Readers run from a timer signal that interrupts the writer
+ * anywhere inside joystick_publish(), which a latch must survive without
+ * waiting (one CPU is enough to hit every point of an update), then as
+ * threads racing a writer thread.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "test_util.h"
+// joystick_publish() and the latch are file statics
+#include "joystick_config.c"
+
+#define READERS         3
+#define PUBLISHES       500000
+#define PREEMPT_MS      300
+#define PREEMPT_US      20      // timer signal period
+
+static volatile bool writer_done;
+
+// A sample that can only be whole if every field agrees with seq
+static joystick_struct_t make_sample(uint32_t seq)
+{
+    uint16_t x = (seq * 7) & JOYSTICK_AXIS_MAX;
+    return (joystick_struct_t){
+        .pressed = seq & 1,
+        .x = x,
+        .y = JOYSTICK_AXIS_MAX - x,
+        .nx = (int16_t)(seq * 3),
+        .ny = (int16_t)-(int16_t)(seq * 3),
+        .keys = seq & 0x1F,
+        .seq = seq,
+        .time_us = (int64_t)seq * 1000 + 7,
+    };
+}
+
+static bool whole(const joystick_struct_t *s)
+{
+    joystick_struct_t e = make_sample(s->seq);
+    return s->pressed == e.pressed && s->x == e.x && s->y == e.y && s->nx == e.nx &&
+           s->ny == e.ny && s->keys == e.keys && s->time_us == e.time_us;
+}
+
+static uint32_t writer_first;
+
+static void *writer(void *arg)
+{
+    for (uint32_t seq = writer_first; seq < writer_first + PUBLISHES; seq++) {
+        joystick_struct_t s = make_sample(seq);
+        joystick_publish(&s);
+        // one CPU in CI: let the readers land anywhere in the update
+        if ((seq & 0x3F) == 0) {
+            sched_yield();
+        }
+    }
+    writer_done = true;
+    return NULL;
+}
+
+typedef struct {
+    uint32_t        reads;
+    uint32_t        torn;
+    uint32_t        backwards;
+    uint32_t        new_samples;
+    uint32_t        repeats;        // get_new_state() returned a sample it had already given
+} reader_t;
+
+static void *reader(void *arg)
+{
+    reader_t *r = (reader_t *)arg;
+    uint32_t last = 0;
+    uint32_t last_new = 0;
+    uint32_t prev_new = 0;
+    while (!writer_done) {
+        joystick_struct_t s = joystick_get_state();
+        r->reads++;
+        r->torn += !whole(&s);
+        r->backwards += s.seq < last;
+        last = s.seq;
+        if (joystick_get_new_state(&last_new, &s)) {
+            r->new_samples++;
+            r->torn += !whole(&s);
+            r->repeats += s.seq <= prev_new;
+            prev_new = s.seq;
+        } else {
+            r->repeats += s.seq != prev_new;
+        }
+        if ((r->reads & 0x3F) == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/* ---- a reader preempting the writer, as a higher priority task would ---- */
+
+static volatile uint32_t irq_reads;
+static volatile uint32_t irq_torn;
+static volatile uint32_t irq_backwards;
+static volatile uint32_t irq_mid_update;    // landed while published[0] was being written
+static uint32_t irq_last;
+
+static void preempt_reader(int sig)
+{
+    (void)sig;
+    irq_mid_update += atomic_load_explicit(&published_seq, memory_order_relaxed) & 1;
+    joystick_struct_t s = joystick_get_state();
+    irq_reads++;
+    irq_torn += !whole(&s);
+    irq_backwards += s.seq < irq_last;
+    irq_last = s.seq;
+}
+
+int main(void)
+{
+    // before the first sample: all zero, sequence 0, nothing new
+    joystick_struct_t s = joystick_get_state();
+    uint32_t seq = 0;
+    CHECK_EQ(s.seq, 0);
+    CHECK(!joystick_get_new_state(&seq, &s));
+
+    // single thread: the latest sample, then nothing new until the next one
+    joystick_struct_t one = make_sample(41);
+    joystick_publish(&one);
+    CHECK(joystick_get_new_state(&seq, &s));
+    CHECK_EQ(seq, 41);
+    CHECK(whole(&s));
+    CHECK(!joystick_get_new_state(&seq, &s));
+
+    // the writer interrupted at random points of its updates
+    struct sigaction sa = { .sa_handler = preempt_reader };
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGALRM, &sa, NULL);
+    struct itimerval tick = {
+        .it_interval = { .tv_usec = PREEMPT_US },
+        .it_value = { .tv_usec = PREEMPT_US },
+    };
+    setitimer(ITIMER_REAL, &tick, NULL);
+    uint32_t next = one.seq + 1;
+    uint64_t preempt_end = test_now_ns() + PREEMPT_MS * 1000000ULL;
+    while (test_now_ns() < preempt_end) {
+        for (int i = 0; i < 1000; i++, next++) {
+            joystick_struct_t w = make_sample(next);
+            joystick_publish(&w);
+        }
+    }
+    struct itimerval off = { 0 };
+    setitimer(ITIMER_REAL, &off, NULL);
+    printf("%lu preempting reads, %lu in the middle of an update\n",
+           (unsigned long)irq_reads, (unsigned long)irq_mid_update);
+    CHECK(irq_mid_update > 0);
+    CHECK_EQ(irq_torn, 0);
+    CHECK_EQ(irq_backwards, 0);
+    next = joystick_get_state().seq;
+
+    // readers on threads racing a writer thread
+    pthread_t readers[READERS];
+    reader_t stats[READERS] = { 0 };
+    pthread_t w;
+    for (int i = 0; i < READERS; i++) {
+        pthread_create(&readers[i], NULL, reader, &stats[i]);
+    }
+    writer_first = next + 1;
+    uint64_t t0 = test_now_ns();
+    pthread_create(&w, NULL, writer, NULL);
+    pthread_join(w, NULL);
+    uint64_t t1 = test_now_ns();
+    uint32_t reads = 0;
+    for (int i = 0; i < READERS; i++) {
+        pthread_join(readers[i], NULL);
+        CHECK_EQ(stats[i].torn, 0);
+        CHECK_EQ(stats[i].backwards, 0);
+        CHECK_EQ(stats[i].repeats, 0);
+        CHECK(stats[i].new_samples > 0);
+        reads += stats[i].reads;
+    }
+    s = joystick_get_state();
+    CHECK_EQ(s.seq, writer_first + PUBLISHES - 1);
+    CHECK(whole(&s));
+    CHECK(reads > 1000);
+
+    // a publish, and a read when nothing is being written, next to a 5 ms sample period
+    uint64_t t2 = test_now_ns();
+    for (uint32_t i = 0; i < 1000000; i++) {
+        s = joystick_get_state();
+    }
+    uint64_t t3 = test_now_ns();
+    printf("%u publishes against %d readers, %lu reads; publish %.1f ns, read %.1f ns\n",
+           PUBLISHES, READERS, (unsigned long)reads, (double)(t1 - t0) / PUBLISHES,
+           (double)(t3 - t2) / 1000000);
+    return TEST_RESULT();
+}
@@ -0,0 +1,121 @@
+/**
+ * @file      test_lvgl_buffers.c
+ * @license   MIT
+ *
+ * The draw buffers lvgl_config() picks, run by the LVGL task on the fake
+ * LVGL and the headless display. Built three times:
+ * test_lvgl_buffers_psram uses two full-screen PSRAM buffers,
+ * test_lvgl_buffers_stripe (CONFIG_LVGL_STRIPE_BUFFERS) uses two internal
+ * stripes of DISPLAY_STRIPE_LINES, and test_lvgl_buffers_fallback is the
+ * stripe build with the internal allocation failing, so it must fall back
+ * to PSRAM. Full-screen and small redraws go through lvgl_lock(). Each
+ * frame must render the same pixels, the stripe build in one flush per
+ * stripe and the PSRAM build in one flush. Only the PSRAM buffers count
+ * PSRAM traffic. How that traffic costs on the device (PSRAM bandwidth, SPI
+ * DMA from PSRAM) cannot be modelled here, so no timing is compared.
+ */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+#include "test_util.h"
+#include "host_mock.h"
+#include "lvgl_fake.h"
+#include "amoled_driver.h"
+#include "product_pins.h"
+#include "lvgl_config.h"
+
+#define FULL_FRAMES     3
+
+static bool stripes_expected(void)
+{
+#if CONFIG_LVGL_STRIPE_BUFFERS && !TEST_STRIPE_FALLBACK
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Invalidates an area and waits for the LVGL task to render and send it
+static bool redraw(lv_coord_t x1, lv_coord_t y1, lv_coord_t x2, lv_coord_t y2)
+{
+    lvgl_render_stats_t before;
+    CHECK(lvgl_lock(-1));
+    lvgl_get_render_stats(&before);
+    lv_area_t area = { x1, y1, x2, y2 };
+    _lv_inv_area(lv_disp_get_default(), &area);
+    lvgl_unlock();
+    for (int i = 0; i < 1000; i++) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+        lvgl_render_stats_t now;
+        CHECK(lvgl_lock(-1));
+        lvgl_get_render_stats(&now);
+        lvgl_unlock();
+        if (now.frames > before.frames) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static lv_fake_stats_t fake_stats(void)
+{
+    lv_fake_stats_t st;
+    CHECK(lvgl_lock(-1));
+    lv_fake_get_stats(&st);
+    lvgl_unlock();
+    return st;
+}
+
+int main(void)
+{
+    display_init();
+#if TEST_STRIPE_FALLBACK
+    host_heap_fail(MALLOC_CAP_INTERNAL, 1);
+#endif
+    lvgl_config();
+    lvgl_go();
+
+    lvgl_render_stats_t render;
+    lvgl_get_render_stats(&render);
+    CHECK_EQ(render.draw_buf_in_psram, !stripes_expected());
+
+    uint32_t w = display_width();
+    uint32_t h = display_height();
+    uint32_t stripes = stripes_expected() ? (h + DISPLAY_STRIPE_LINES - 1) / DISPLAY_STRIPE_LINES : 1;
+
+    /* ---- full-screen frames ---- */
+    lv_fake_stats_t start = fake_stats();
+    for (int i = 0; i < FULL_FRAMES; i++) {
+        CHECK(redraw(0, 0, (lv_coord_t)w - 1, (lv_coord_t)h - 1));
+    }
+    lv_fake_stats_t full = fake_stats();
+    lvgl_get_render_stats(&render);
+    uint32_t flushes = full.flushes - start.flushes;
+    uint64_t px = full.rendered_px - start.rendered_px;
+    CHECK_EQ(render.frames, FULL_FRAMES);
+    CHECK_EQ(render.pixels, (uint64_t)FULL_FRAMES * w * h);
+    CHECK_EQ(px, (uint64_t)FULL_FRAMES * w * h);
+    CHECK_EQ(flushes, FULL_FRAMES * stripes);
+    // two stripes: each one after the first waits for the other to be sent
+    CHECK_EQ(full.buf_waits - start.buf_waits > 0, stripes > 1);
+    CHECK_EQ(render.psram_bytes, render.draw_buf_in_psram ? px * sizeof(lv_color_t) * 2 : 0);
+    printf("%s: %lu x %lu, %lu flush(es) per frame, %lu buffer waits in %d frames, "
+           "%llu KB PSRAM traffic per frame\n",
+           render.draw_buf_in_psram ? "PSRAM buffers" : "internal stripes", (unsigned long)w,
+           (unsigned long)h, (unsigned long)(flushes / FULL_FRAMES),
+           (unsigned long)(full.buf_waits - start.buf_waits), FULL_FRAMES,
+           (unsigned long long)(render.psram_bytes / FULL_FRAMES / 1024));
+
+    /* ---- a redraw smaller than a stripe is one flush either way ---- */
+    CHECK(redraw(10, 20, 49, 20 + DISPLAY_STRIPE_LINES / 2));
+    lv_fake_stats_t small = fake_stats();
+    CHECK_EQ(small.flushes - full.flushes, 1);
+    CHECK_EQ(small.rendered_px - full.rendered_px, 40 * (DISPLAY_STRIPE_LINES / 2 + 1));
+
+    // every transfer was handed back to LVGL
+    CHECK(lvgl_lock(-1));
+    CHECK_EQ(lv_fake_flush_ready_count(), small.flushes);
+    lvgl_unlock();
+    return TEST_RESULT();
+}
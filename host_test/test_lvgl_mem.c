@@ -0,0 +1,203 @@
+/**
+ * @file      test_lvgl_mem.c
+ * @license   MIT
+ *
+ * The tiered LVGL allocator under a random LVGL-like workload: blocks never
+ * overlap and keep their contents through realloc, every tier's accounting
+ * returns to zero, arena exhaustion and heap failures fall back as
+ * documented. Then the latency of arena, SRAM and PSRAM allocations.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "test_util.h"
+#include "host_mock.h"
+// the allocator's statics, to start over with or without an arena
+#include "lvgl_mem.c"
+
+#define LIVE_MAX        512
+#define OPS             200000
+#define LAT_SAMPLES     20000
+
+typedef struct {
+    uint8_t         *ptr;
+    size_t          size;
+    uint8_t         fill;
+} live_t;
+
+static live_t live[LIVE_MAX];
+static uint32_t rng = 12345;
+
+static uint32_t next_rand(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+// Mostly small objects and styles, some labels and images, a few big buffers
+static size_t random_size(void)
+{
+    uint32_t r = next_rand() % 100;
+    if (r < 70) {
+        return 1 + next_rand() % 256;
+    }
+    if (r < 95) {
+        return 257 + next_rand() % (CONFIG_LVGL_MEM_PSRAM_THRESHOLD - 257);
+    }
+    return CONFIG_LVGL_MEM_PSRAM_THRESHOLD + next_rand() % 16384;
+}
+
+static bool intact(const live_t *l)
+{
+    for (size_t i = 0; i < l->size; i++) {
+        if (l->ptr[i] != (uint8_t)(l->fill + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void fill(live_t *l)
+{
+    for (size_t i = 0; i < l->size; i++) {
+        l->ptr[i] = (uint8_t)(l->fill + i);
+    }
+}
+
+// Forget everything, as after a reboot; the next allocation sets the arena up again
+static void reset(void)
+{
+    free(arena);
+    arena = NULL;
+    arena_tried = false;
+    memset(page_class, 0, sizeof(page_class));
+    memset(free_lists, 0, sizeof(free_lists));
+    memset(&stats, 0, sizeof(stats));
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint32_t lat[LAT_SAMPLES];
+
+// p50/p99/max of an alloc+free pair of the given size, in ns
+static void latency(const char *name, size_t size, uint32_t *p99)
+{
+    for (int i = 0; i < LAT_SAMPLES; i++) {
+        uint64_t t0 = test_now_ns();
+        void *p = lvgl_mem_alloc(size);
+        lvgl_mem_free(p);
+        lat[i] = (uint32_t)(test_now_ns() - t0);
+    }
+    qsort(lat, LAT_SAMPLES, sizeof(lat[0]), cmp_u32);
+    *p99 = lat[LAT_SAMPLES * 99 / 100];
+    printf("%-6s %5zu B: p50 %4lu ns, p99 %5lu ns, max %7lu ns\n", name, size,
+           (unsigned long)lat[LAT_SAMPLES / 2], (unsigned long)*p99, (unsigned long)lat[LAT_SAMPLES - 1]);
+}
+
+int main(void)
+{
+    lvgl_mem_stats_t s;
+
+    // no room for the arena: small requests use the heap, classes still reported
+    host_heap_fail(MALLOC_CAP_INTERNAL, 1);
+    void *p = lvgl_mem_alloc(24);
+    CHECK(p != NULL);
+    lvgl_mem_get_stats(&s);
+    CHECK_EQ(s.arena_pages, 0);
+    CHECK_EQ(s.classes[0].size, 16);
+    CHECK_EQ(s.classes[LVGL_MEM_CLASS_COUNT - 1].size, 256);
+    CHECK_EQ(s.sram_bytes, 24);
+    lvgl_mem_free(p);
+    CHECK_EQ(lvgl_mem_used(), 0);
+    reset();
+
+    // random workload against a live set
+    uint32_t corrupted = 0;
+    uint32_t failed = 0;
+    for (uint32_t op = 0; op < OPS; op++) {
+        live_t *l = &live[next_rand() % LIVE_MAX];
+        uint32_t action = next_rand() % 4;
+        if (l->ptr && action == 0) {
+            // grow or shrink, the common part must survive
+            size_t size = random_size();
+            uint8_t *np = lvgl_mem_realloc(l->ptr, size);
+            if (!np) {
+                failed++;
+                continue;
+            }
+            size_t keep = size < l->size ? size : l->size;
+            l->ptr = np;
+            l->size = keep;
+            corrupted += !intact(l);
+            l->size = size;
+            fill(l);
+        } else if (l->ptr) {
+            corrupted += !intact(l);
+            lvgl_mem_free(l->ptr);
+            l->ptr = NULL;
+        } else {
+            l->size = random_size();
+            l->ptr = lvgl_mem_alloc(l->size);
+            if (!l->ptr) {
+                failed++;
+                continue;
+            }
+            l->fill = (uint8_t)next_rand();
+            fill(l);
+        }
+        lvgl_mem_get_stats(&s);
+        CHECK(s.used_bytes <= s.peak_used_bytes);
+    }
+    lvgl_mem_get_stats(&s);
+    CHECK_EQ(corrupted, 0);
+    CHECK_EQ(failed, 0);
+    CHECK(s.fallbacks > 0);     // the live set outgrows the 32 KB arena
+    CHECK(s.psram_peak > 0);
+    CHECK(s.sram_peak > 0);
+    printf("workload: peak %lu B, arena %lu/%lu pages, %u%% free in slots, %lu fallbacks\n",
+           (unsigned long)s.peak_used_bytes, (unsigned long)s.arena_pages_used,
+           (unsigned long)s.arena_pages, s.frag_pct, (unsigned long)s.fallbacks);
+    for (int i = 0; i < LIVE_MAX; i++) {
+        if (live[i].ptr) {
+            corrupted += !intact(&live[i]);
+            lvgl_mem_free(live[i].ptr);
+            live[i].ptr = NULL;
+        }
+    }
+    lvgl_mem_get_stats(&s);
+    CHECK_EQ(corrupted, 0);
+    CHECK_EQ(s.used_bytes, 0);
+    CHECK_EQ(s.sram_bytes, 0);
+    CHECK_EQ(s.psram_bytes, 0);
+    for (int i = 0; i < LVGL_MEM_CLASS_COUNT; i++) {
+        CHECK_EQ(s.classes[i].in_use, 0);
+    }
+    // every carved slot is back in a free list
+    CHECK_EQ(s.frag_pct, 100);
+
+    // PSRAM full: large blocks go to SRAM; both full: NULL and a failure
+    host_heap_fail(MALLOC_CAP_SPIRAM, 1);
+    p = lvgl_mem_alloc(8192);
+    lvgl_mem_get_stats(&s);
+    CHECK(p != NULL);
+    CHECK_EQ(s.sram_bytes, 8192);
+    lvgl_mem_free(p);
+    host_heap_fail(MALLOC_CAP_SPIRAM | MALLOC_CAP_INTERNAL, 2);
+    CHECK(lvgl_mem_alloc(8192) == NULL);
+    lvgl_mem_get_stats(&s);
+    CHECK_EQ(s.failures, 1);
+
+    // an arena slot is a free-list pop; the heap tiers time glibc here, not
+    // the ESP-IDF heap, and are printed for comparison only
+    reset();
+    uint32_t arena_p99, sram_p99, psram_p99;
+    latency("arena", 48, &arena_p99);
+    latency("sram", 1024, &sram_p99);
+    latency("psram", 16384, &psram_p99);
+    CHECK(arena_p99 < 2000);
+    return TEST_RESULT();
+}
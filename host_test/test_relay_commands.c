@@ -0,0 +1,265 @@
+/**
+ * @file      test_relay_commands.c
+ * @license   MIT
+ *
+ * Virtual control buttons held for many input read periods, with the event
+ * sequence LVGL 8.3 sends (PRESSED, PRESSING on every read, LONG_PRESSED and
+ * its repeats, RELEASED, CLICKED) going into handlers shaped like the ones
+ * in lvgl_config.c. Each relay pin must change exactly once on the press
+ * and once on the release, with no write in between, and every repeated
+ * command must be counted as suppressed.
+ */
+#include "test_util.h"
+#include "host_mock.h"
+#include "lvgl.h"
+#include "relay_config.h"
+
+#define READ_PERIOD_MS      30      // LV_INDEV_DEF_READ_PERIOD
+#define LONG_PRESS_MS       400     // LV_INDEV_DEF_LONG_PRESS_TIME
+#define LONG_REPEAT_MS      100     // LV_INDEV_DEF_LONG_PRESS_REP_TIME
+#define HOLD_PERIODS        200     // six seconds of holding a crane button
+
+static const gpio_num_t relay_pins[] = {
+    RELAY1_GPIO, RELAY2_GPIO, RELAY3_GPIO, RELAY4_GPIO, RELAY7_GPIO, RELAY8_GPIO,
+};
+
+#define PIN_COUNT   (sizeof(relay_pins) / sizeof(relay_pins[0]))
+
+/* ---- the control screen's handlers, as in lvgl_config.c ---- */
+
+static void up_cb(lv_event_code_t code)
+{
+    if (code == LV_EVENT_PRESSING) {
+        crane_up();
+    } else if (code == LV_EVENT_PRESS_LOST || code == LV_EVENT_RELEASED) {
+        crane_stop();
+    }
+}
+
+static void down_cb(lv_event_code_t code)
+{
+    if (code == LV_EVENT_PRESSING) {
+        crane_down();
+    } else if (code == LV_EVENT_PRESS_LOST || code == LV_EVENT_RELEASED) {
+        crane_stop();
+    }
+}
+
+static void crowd_up_cb(lv_event_code_t code)
+{
+    if (code == LV_EVENT_PRESSING) {
+        crowd_up();
+    } else if (code == LV_EVENT_PRESS_LOST || code == LV_EVENT_RELEASED) {
+        crowd_stop();
+    }
+}
+
+static void crowd_down_cb(lv_event_code_t code)
+{
+    if (code == LV_EVENT_PRESSING) {
+        crowd_down();
+    } else if (code == LV_EVENT_PRESS_LOST || code == LV_EVENT_RELEASED) {
+        crowd_stop();
+    }
+}
+
+static int vac_on;
+
+static void vac_cb(lv_event_code_t code)
+{
+    if (code == LV_EVENT_LONG_PRESSED) {
+        vac_on = !vac_on;
+        if (vac_on) {
+            vacuum_on();
+        } else {
+            vacuum_off();
+        }
+    }
+}
+
+static void vac_off_cb(lv_event_code_t code)
+{
+    if (code == LV_EVENT_PRESSING) {
+        vacuum_off();
+    }
+}
+
+typedef void (*handler_t)(lv_event_code_t code);
+
+/* ---- the relay pins around a gesture ---- */
+
+typedef struct {
+    int             level[PIN_COUNT];
+    uint32_t        writes[PIN_COUNT];
+    uint32_t        transitions[PIN_COUNT];
+} pins_t;
+
+static void pins_read(pins_t *p)
+{
+    for (size_t i = 0; i < PIN_COUNT; i++) {
+        p->level[i] = host_gpio_level(relay_pins[i]);
+        p->writes[i] = host_gpio_writes(relay_pins[i]);
+        p->transitions[i] = host_gpio_transitions(relay_pins[i]);
+    }
+}
+
+// Every pin whose level differs changed once, with one write; the others were not touched
+static bool pins_one_edge(const pins_t *before, const pins_t *after)
+{
+    bool ok = true;
+    for (size_t i = 0; i < PIN_COUNT; i++) {
+        uint32_t expect = before->level[i] != after->level[i];
+        uint32_t transitions = after->transitions[i] - before->transitions[i];
+        uint32_t writes = after->writes[i] - before->writes[i];
+        if (transitions != expect || writes != expect) {
+            fprintf(stderr, "GPIO %d: %lu transitions, %lu writes, expected %lu\n", relay_pins[i],
+                    (unsigned long)transitions, (unsigned long)writes, (unsigned long)expect);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static bool pins_changed(const pins_t *before, const pins_t *after)
+{
+    for (size_t i = 0; i < PIN_COUNT; i++) {
+        if (before->level[i] != after->level[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// PRESSED, then one PRESSING per read with the long press events in between
+static void press(handler_t cb, uint32_t periods)
+{
+    cb(LV_EVENT_PRESSED);
+    uint32_t next_repeat = LONG_PRESS_MS + LONG_REPEAT_MS;
+    for (uint32_t i = 1; i <= periods; i++) {
+        uint32_t held_ms = i * READ_PERIOD_MS;
+        cb(LV_EVENT_PRESSING);
+        if (held_ms >= LONG_PRESS_MS && held_ms - READ_PERIOD_MS < LONG_PRESS_MS) {
+            cb(LV_EVENT_LONG_PRESSED);
+        } else if (held_ms >= next_repeat) {
+            cb(LV_EVENT_LONG_PRESSED_REPEAT);
+            next_repeat += LONG_REPEAT_MS;
+        }
+    }
+}
+
+static void release(handler_t cb)
+{
+    cb(LV_EVENT_RELEASED);
+    cb(LV_EVENT_CLICKED);
+}
+
+// Hold a button: one edge per pin on the press, one back on the release
+static void hold(const char *name, handler_t cb, uint32_t periods)
+{
+    pins_t idle, held, released;
+    relay_stats_t s0, s1;
+    relay_get_stats(&s0);
+    pins_read(&idle);
+    press(cb, periods);
+    pins_read(&held);
+    release(cb);
+    pins_read(&released);
+    relay_get_stats(&s1);
+
+    bool ok = pins_changed(&idle, &held) && pins_one_edge(&idle, &held) && pins_one_edge(&held, &released);
+    for (size_t i = 0; i < PIN_COUNT; i++) {
+        ok = ok && released.level[i] == idle.level[i];
+    }
+    if (!ok) {
+        fprintf(stderr, "%s held for %lu periods\n", name, (unsigned long)periods);
+    }
+    CHECK(ok);
+    // one command per PRESSING and one stop, all but the first PRESSING dropped
+    CHECK_EQ(s1.commands - s0.commands, periods + 1);
+    CHECK_EQ(s1.suppressed - s0.suppressed, periods - 1);
+}
+
+int main(void)
+{
+    relay_stats_t stats;
+    pins_t p0, p1;
+
+    // start-up drives every relay off: active-low ones high, relays 2 and 3 low
+    relay_config();
+    CHECK_EQ(host_gpio_level(RELAY1_GPIO), 1);
+    CHECK_EQ(host_gpio_level(RELAY2_GPIO), 0);
+    CHECK_EQ(host_gpio_level(RELAY3_GPIO), 0);
+    CHECK_EQ(host_gpio_level(RELAY4_GPIO), 1);
+    CHECK_EQ(host_gpio_level(RELAY7_GPIO), 1);
+    CHECK_EQ(host_gpio_level(RELAY8_GPIO), 1);
+    relay_get_stats(&stats);
+    CHECK_EQ(stats.commands, 3);
+    CHECK_EQ(stats.suppressed, 0);
+    // and a second init finds them there
+    host_gpio_reset();
+    relay_config();
+    for (size_t i = 0; i < PIN_COUNT; i++) {
+        CHECK_EQ(host_gpio_writes(relay_pins[i]), 0);
+    }
+
+    // crane up: relays 1 and 3 on
+    pins_read(&p0);
+    press(up_cb, HOLD_PERIODS);
+    CHECK_EQ(host_gpio_level(RELAY1_GPIO), 0);
+    CHECK_EQ(host_gpio_level(RELAY2_GPIO), 0);
+    CHECK_EQ(host_gpio_level(RELAY3_GPIO), 1);
+    pins_read(&p1);
+    CHECK_EQ(p1.transitions[0] - p0.transitions[0], 1);
+    CHECK_EQ(p1.transitions[2] - p0.transitions[2], 1);
+    release(up_cb);
+
+    hold("Up", up_cb, HOLD_PERIODS);
+    hold("Down", down_cb, HOLD_PERIODS);
+    hold("CRD up", crowd_up_cb, HOLD_PERIODS);
+    hold("CRD dn", crowd_down_cb, HOLD_PERIODS);
+    // a tap shorter than one read period still gets its PRESSING
+    hold("Down", down_cb, 1);
+
+    // the finger slides off the button: PRESS_LOST stops it, no RELEASED follows
+    pins_read(&p0);
+    press(crowd_down_cb, HOLD_PERIODS);
+    crowd_down_cb(LV_EVENT_PRESS_LOST);
+    pins_read(&p1);
+    CHECK(!pins_changed(&p0, &p1));
+    CHECK_EQ(p1.transitions[5] - p0.transitions[5], 2);
+    CHECK_EQ(p1.writes[5] - p0.writes[5], 2);
+    CHECK_EQ(p1.writes[4] - p0.writes[4], 0);
+
+    // the vacuum toggles on the long press only, holding on keeps it on
+    pins_read(&p0);
+    press(vac_cb, HOLD_PERIODS);
+    release(vac_cb);
+    pins_read(&p1);
+    CHECK_EQ(host_gpio_level(RELAY4_GPIO), 0);
+    CHECK(pins_one_edge(&p0, &p1));
+    // the off button held: one edge, every other PRESSING suppressed
+    relay_get_stats(&stats);
+    uint32_t suppressed = stats.suppressed;
+    pins_read(&p0);
+    press(vac_off_cb, HOLD_PERIODS);
+    release(vac_off_cb);
+    pins_read(&p1);
+    CHECK_EQ(host_gpio_level(RELAY4_GPIO), 1);
+    CHECK(pins_one_edge(&p0, &p1));
+    relay_get_stats(&stats);
+    CHECK_EQ(stats.suppressed - suppressed, HOLD_PERIODS - 1);
+
+    // the counters add up: every write was a level change
+    uint32_t writes = 0;
+    uint32_t transitions = 0;
+    for (size_t i = 0; i < PIN_COUNT; i++) {
+        writes += host_gpio_writes(relay_pins[i]);
+        transitions += host_gpio_transitions(relay_pins[i]);
+    }
+    CHECK_EQ(writes, transitions);
+    relay_get_stats(&stats);
+    printf("%lu commands, %lu suppressed, %lu relay writes\n", (unsigned long)stats.commands,
+           (unsigned long)stats.suppressed, (unsigned long)stats.gpio_writes);
+    CHECK_EQ(host_isr_violations(), 0);
+    return TEST_RESULT();
+}
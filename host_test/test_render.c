@@ -0,0 +1,38 @@
+/**
+ * @file      test_render.c
+ * @license   MIT
+ *
+ * The application renders its first screen: the control screen background
+ * fills the framebuffer and the buttons are drawn over it.
+ */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "test_util.h"
+#include "host_app.h"
+
+int main(void)
+{
+    host_app_start();
+
+    display_headless_stats_t stats = { 0 };
+    for (int i = 0; i < 200 && !stats.frames; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        display_headless_get_stats(&stats);
+    }
+    CHECK(stats.frames > 0);
+
+    CHECK(lvgl_lock(1000));
+    const uint16_t *fb = display_headless_framebuffer();
+    uint16_t background = lv_palette_lighten(LV_PALETTE_GREY, 3).full;
+    uint32_t total = (uint32_t)display_width() * display_height();
+    uint32_t on_background = 0;
+    for (uint32_t i = 0; i < total; i++) {
+        on_background += fb[i] == background;
+    }
+    lvgl_unlock();
+
+    // mostly background, with room for the five buttons
+    CHECK(on_background > total / 4);
+    CHECK(on_background < total - total / 10);
+    return TEST_RESULT();
+}
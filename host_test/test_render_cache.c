@@ -0,0 +1,111 @@
+/**
+ * @file      test_render_cache.c
+ * @license   MIT
+ *
+ * render_cache.c on the control screen, on the fake LVGL. Every button must
+ * be snapshotted in its idle look, before the keypad group focuses the first
+ * one, with its image placed just under it and sized to its grid cell. The
+ * button itself must be fully transparent while idle and opaque in each
+ * live state, alone or combined, so LVGL draws it only when it differs from
+ * the image. The snapshots are freed with the screen, and a failed
+ * allocation leaves the button drawing itself.
+ */
+#include <string.h>
+#include "test_util.h"
+#include "lvgl_fake.h"
+#include "host_mock.h"
+// control_screen_build() is a file static
+#include "lvgl_config.c"
+
+#define BUTTONS         (sizeof(control_layout) / sizeof(control_layout[0]))
+
+static const lv_state_t live[] = {
+    LV_STATE_PRESSED, LV_STATE_FOCUSED, LV_STATE_FOCUS_KEY, LV_STATE_CHECKED,
+};
+
+static lv_opa_t opa_in(lv_obj_t *obj, lv_state_t state)
+{
+    lv_state_t saved = lv_obj_get_state(obj);
+    lv_obj_clear_state(obj, saved);
+    lv_obj_add_state(obj, state);
+    lv_opa_t opa = lv_obj_get_style_opa(obj, LV_PART_MAIN);
+    lv_obj_clear_state(obj, state);
+    lv_obj_add_state(obj, saved);
+    return opa;
+}
+
+int main(void)
+{
+    display_init();
+    lvgl_config();
+
+    lv_obj_t *scr = control_screen_build(NULL);
+    CHECK_EQ(lv_obj_get_child_cnt(scr), 2 * BUTTONS);
+    render_cache_stats_t stats;
+    render_cache_get_stats(&stats);
+    CHECK_EQ(stats.entries, BUTTONS);
+    CHECK_EQ(stats.failures, 0);
+
+    uint32_t bytes = 0;
+    for (uint32_t i = 0; i < BUTTONS; i++) {
+        lv_obj_t *img = lv_obj_get_child(scr, 2 * i);
+        lv_obj_t *btn = lv_obj_get_child(scr, 2 * i + 1);
+        CHECK_EQ(img->type, LV_FAKE_IMG);
+        CHECK_EQ(btn->type, LV_FAKE_BTN);
+        CHECK(btn->group == joystick_group);
+
+        // one snapshot, idle, although the first button is focused now
+        CHECK_EQ(btn->snapshots, 1);
+        CHECK_EQ(btn->snapshot_state, LV_STATE_DEFAULT);
+        CHECK(lv_obj_has_flag(img, LV_OBJ_FLAG_IGNORE_LAYOUT));
+        const lv_img_dsc_t *dsc = (const lv_img_dsc_t *)img->img_src;
+        CHECK(dsc != NULL);
+        CHECK_EQ(dsc->header.cf, LV_IMG_CF_TRUE_COLOR_ALPHA);
+        CHECK_EQ(dsc->header.w, lv_obj_get_width(btn));
+        CHECK_EQ(dsc->header.h, lv_obj_get_height(btn));
+        CHECK_EQ(lv_obj_get_width(img), lv_obj_get_width(btn));
+        bytes += dsc->data_size;
+
+        // idle: only the image shows; each live state alone and with the others
+        CHECK_EQ(opa_in(btn, LV_STATE_DEFAULT), LV_OPA_TRANSP);
+        CHECK_EQ(opa_in(btn, LV_STATE_USER_1), LV_OPA_TRANSP);
+        for (size_t s = 0; s < sizeof(live) / sizeof(live[0]); s++) {
+            CHECK_EQ(opa_in(btn, live[s]), LV_OPA_COVER);
+            CHECK_EQ(opa_in(btn, live[s] | LV_STATE_USER_1), LV_OPA_COVER);
+            for (size_t t = s + 1; t < sizeof(live) / sizeof(live[0]); t++) {
+                CHECK_EQ(opa_in(btn, live[s] | live[t]), LV_OPA_COVER);
+            }
+        }
+    }
+    CHECK_EQ(stats.bytes, bytes);
+    // focus went to the first button after its snapshot
+    CHECK(lv_obj_has_state(lv_obj_get_child(scr, 1), LV_STATE_FOCUSED));
+    CHECK_EQ(opa_in(lv_obj_get_child(scr, 1), lv_obj_get_state(lv_obj_get_child(scr, 1))), LV_OPA_COVER);
+
+    // moving the focus redraws the buttons without taking new snapshots
+    lv_group_focus_obj(lv_obj_get_child(scr, 3));
+    CHECK_EQ(lv_obj_get_style_opa(lv_obj_get_child(scr, 1), LV_PART_MAIN), LV_OPA_TRANSP);
+    CHECK_EQ(lv_obj_get_style_opa(lv_obj_get_child(scr, 3), LV_PART_MAIN), LV_OPA_COVER);
+    CHECK_EQ(lv_obj_get_child(scr, 3)->snapshots, 1);
+
+    lv_obj_del(scr);
+    render_cache_get_stats(&stats);
+    CHECK_EQ(stats.entries, 0);
+    CHECK_EQ(stats.bytes, 0);
+
+    // no memory for one snapshot: that button keeps drawing itself
+    host_heap_fail(MALLOC_CAP_SPIRAM | MALLOC_CAP_DEFAULT, 2);
+    scr = control_screen_build(NULL);
+    render_cache_get_stats(&stats);
+    CHECK_EQ(stats.failures, 1);
+    CHECK_EQ(stats.entries, BUTTONS - 1);
+    CHECK_EQ(lv_obj_get_child_cnt(scr), 2 * BUTTONS - 1);
+    lv_obj_t *plain = lv_obj_get_child(scr, 0);
+    CHECK_EQ(plain->type, LV_FAKE_BTN);
+    CHECK_EQ(lv_obj_get_style_opa(plain, LV_PART_MAIN), LV_OPA_COVER);
+    lv_obj_del(scr);
+    render_cache_get_stats(&stats);
+    CHECK_EQ(stats.entries, 0);
+    CHECK_EQ(stats.bytes, 0);
+    return TEST_RESULT();
+}
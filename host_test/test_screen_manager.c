@@ -0,0 +1,192 @@
+/**
+ * @file      test_screen_manager.c
+ * @license   MIT
+ *
+ * screen_manager.c on the fake LVGL, whose heap model stands in for
+ * lv_mem_monitor(). Four screens of different sizes are shown in turn under
+ * a shrinking budget. Evictions must take the least recently shown screen
+ * first and never the active or the previous one. A rebuilt screen must map
+ * its keys to its new objects. The resident total must match the LVGL heap
+ * the built screens hold once async deletions have run, including after
+ * evictions, direct deletes and rebuilds.
+ */
+#include <string.h>
+#include "test_util.h"
+#include "lvgl_fake.h"
+#include "screen_manager.h"
+
+#define SCREENS         4
+#define KEY_FIRST       0
+#define KEY_LAST        1
+
+static const uint32_t label_count[SCREENS] = { 2, 4, 6, 8 };
+static lv_obj_t *built[SCREENS];
+static uint32_t build_count[SCREENS];
+static uint32_t base_used;
+
+// A screen of labels with heap-copied text; keys map to the first and last
+static lv_obj_t *labels_build(void *user_ctx)
+{
+    int index = (int)(intptr_t)user_ctx;
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_t *label = NULL;
+    for (uint32_t i = 0; i < label_count[index]; i++) {
+        label = lv_label_create(scr);
+        lv_label_set_text(label, "screen manager label");
+        if (i == 0) {
+            screen_manager_set_key_target(KEY_FIRST, label);
+        }
+    }
+    screen_manager_set_key_target(KEY_LAST, label);
+    built[index] = scr;
+    build_count[index]++;
+    return scr;
+}
+
+static uint32_t lv_mem_in_use(void)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+}
+
+static screen_manager_stats_t stats_now(void)
+{
+    screen_manager_stats_t stats;
+    screen_manager_get_stats(&stats);
+    return stats;
+}
+
+// Shows a screen and returns the LVGL heap its build took, 0 when it was resident
+static uint32_t show(int index)
+{
+    uint32_t builds = stats_now().builds;
+    uint32_t used = lv_mem_in_use();
+    screen_manager_show(index);
+    CHECK_EQ(screen_manager_active(), index);
+    CHECK(lv_scr_act() == built[index]);
+    if (stats_now().builds == builds) {
+        return 0;
+    }
+    return lv_mem_in_use() - used;
+}
+
+// The heap held by screens, once pending deletions have run, is what the
+// manager accounts as resident
+static void check_resident(void)
+{
+    lv_fake_run_async();
+    CHECK_EQ(lv_mem_in_use() - base_used, stats_now().resident_bytes);
+}
+
+static void check_keys(int index)
+{
+    CHECK(screen_manager_key_target(KEY_FIRST) == lv_obj_get_child(built[index], 0));
+    CHECK(screen_manager_key_target(KEY_LAST) == lv_obj_get_child(built[index], label_count[index] - 1));
+    CHECK(screen_manager_key_target(SCREEN_MANAGER_MAX_KEYS) == NULL);
+}
+
+int main(void)
+{
+    static lv_disp_drv_t drv;
+    lv_disp_drv_init(&drv);
+    lv_disp_drv_register(&drv);
+    for (int i = 0; i < SCREENS; i++) {
+        CHECK_EQ(screen_manager_register("labels", labels_build, (void *)(intptr_t)i), i);
+    }
+    CHECK_EQ(screen_manager_register("one too many", labels_build, NULL), -1);
+    base_used = lv_mem_in_use();
+
+    /* ---- every screen built once, nothing evicted ---- */
+    screen_manager_set_budget(UINT32_MAX);
+    uint32_t cost[SCREENS];
+    uint32_t resident = 0;
+    for (int i = 0; i < SCREENS; i++) {
+        cost[i] = show(i);
+        CHECK(cost[i] > 0);
+        resident += cost[i];
+        CHECK_EQ(stats_now().resident_bytes, resident);
+        check_keys(i);
+    }
+    // larger screens cost more, each label the same
+    CHECK(cost[0] < cost[1] && cost[1] < cost[2] && cost[2] < cost[3]);
+    CHECK_EQ(cost[3] - cost[2], cost[1] - cost[0]);
+    screen_manager_stats_t stats = stats_now();
+    CHECK_EQ(stats.builds, SCREENS);
+    CHECK_EQ(stats.evictions, 0);
+    CHECK(stats.peak_lv_mem >= lv_mem_in_use());
+    check_resident();
+
+    /* ---- least recently shown goes first, active and previous stay ---- */
+    // shown order is now 0 1 2 3; show 1 then 2, leaving 0 coldest, then 3
+    CHECK_EQ(show(1), 0);
+    CHECK_EQ(show(2), 0);
+    lv_obj_t *old0 = built[0];
+    lv_obj_t *old0_first = lv_obj_get_child(old0, 0);
+    screen_manager_set_budget(resident - 1);
+    CHECK_EQ(show(1), 0);           // active 1, previous 2
+    stats = stats_now();
+    CHECK_EQ(stats.evictions, 1);
+    CHECK_EQ(stats.resident_bytes, resident - cost[0]);
+    CHECK(old0->valid);             // deleted async, not from the show
+    check_resident();
+    CHECK(!old0->valid);
+    CHECK(!old0_first->valid);
+
+    // a budget nothing fits: everything but active and previous goes
+    screen_manager_set_budget(0);
+    lv_obj_t *old3 = built[3];
+    CHECK_EQ(show(2), 0);           // active 2, previous 1
+    stats = stats_now();
+    CHECK_EQ(stats.evictions, 2);
+    CHECK_EQ(stats.resident_bytes, cost[1] + cost[2]);
+    check_resident();
+    CHECK(!old3->valid);
+    CHECK(built[1]->valid && built[2]->valid);
+
+    /* ---- a rebuilt screen maps keys to its new objects ---- */
+    uint32_t peak = stats.peak_lv_mem;
+    // active 0, previous 2: 1 is evicted in the same show, so the rebuild
+    // is measured by the resident total rather than the heap delta
+    CHECK(show(0) > 0);
+    CHECK_EQ(build_count[0], 2);
+    CHECK(built[0] != old0);
+    check_keys(0);
+    CHECK(screen_manager_key_target(KEY_FIRST) != old0_first);
+    stats = stats_now();
+    CHECK_EQ(stats.evictions, 3);
+    CHECK_EQ(stats.resident_bytes, cost[0] + cost[2]);
+    // both screens were built when 1 was evicted
+    CHECK(stats.peak_lv_mem >= peak);
+    CHECK(stats.peak_lv_mem >= base_used + cost[0] + cost[1] + cost[2]);
+    check_resident();
+
+    /* ---- keys step through the screens ---- */
+    uint32_t key = LV_KEY_RIGHT;
+    lv_event_send(lv_scr_act(), LV_EVENT_KEY, &key);
+    CHECK_EQ(screen_manager_active(), 1);
+    check_keys(1);
+    key = LV_KEY_LEFT;
+    lv_event_send(lv_scr_act(), LV_EVENT_KEY, &key);
+    CHECK_EQ(screen_manager_active(), 0);
+    check_keys(0);
+    check_resident();
+
+    /* ---- a screen deleted from outside is refunded and rebuilt ---- */
+    screen_manager_set_budget(UINT32_MAX);
+    uint32_t before = stats_now().resident_bytes;
+    lv_obj_t *gone = built[1];
+    lv_obj_del(gone);
+    CHECK_EQ(stats_now().resident_bytes, before - cost[1]);
+    check_resident();
+    CHECK_EQ(show(1), cost[1]);
+    CHECK(built[1] != gone);
+    check_keys(1);
+    check_resident();
+
+    stats = stats_now();
+    printf("%lu builds, %lu evictions, %lu B resident, lv_mem peak %lu B\n", (unsigned long)stats.builds,
+           (unsigned long)stats.evictions, (unsigned long)stats.resident_bytes,
+           (unsigned long)stats.peak_lv_mem);
+    return TEST_RESULT();
+}
@@ -0,0 +1,141 @@
+/**
+ * @file      test_ui_queue.c
+ * @license   MIT
+ *
+ * The UI command queue with several producer threads against a draining
+ * consumer, as tasks and ISRs post to the LVGL task: nothing is lost or
+ * applied twice, each producer's commands apply in order, a full queue is
+ * reported, and commands for objects deleted after the post are skipped.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include "test_util.h"
+#include "lvgl_fake.h"
+#include "ui_queue.h"
+
+#define PRODUCERS       4
+#define POSTS           5000
+
+static lv_obj_t *targets[PRODUCERS];
+static uint32_t full_retries[PRODUCERS];
+static volatile int producers_done;
+
+// colour n to the producer's own object; retried while the queue is full
+static void *producer(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    for (uint32_t n = 1; n <= POSTS; n++) {
+        lv_color_t color = { .full = (uint16_t)n };
+        while (!ui_set_bg_color(targets[id], color)) {
+            full_retries[id]++;
+            sched_yield();
+        }
+    }
+    __atomic_add_fetch(&producers_done, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static uint32_t wakes;
+
+static void wake_cb(void *user_ctx)
+{
+    (void)user_ctx;
+    __atomic_add_fetch(&wakes, 1, __ATOMIC_RELAXED);
+}
+
+int main(void)
+{
+    ui_queue_stats_t stats;
+    ui_queue_init();
+    ui_queue_register_wake_cb(wake_cb, NULL);
+
+    // single thread: FIFO, and a full queue says so
+    lv_obj_t *label = lv_label_create(NULL);
+    CHECK(ui_set_label_text(label, "one"));
+    CHECK(ui_set_label_text(label, "two"));
+    CHECK_EQ(ui_queue_drain(), 2);
+    CHECK(strcmp(label->text, "two") == 0);
+    uint32_t accepted = 0;
+    while (ui_send_key(label, LV_KEY_ENTER)) {
+        accepted++;
+    }
+    CHECK_EQ(accepted, 16);
+    CHECK_EQ(ui_queue_drain(), 16);
+    ui_queue_get_stats(&stats);
+    CHECK_EQ(stats.dropped, 1);
+
+    // commands posted before the object was deleted are skipped, not applied
+    lv_obj_t *screen = lv_obj_create(NULL);
+    lv_obj_t *title = lv_label_create(screen);
+    CHECK(ui_set_label_text(title, "stale"));
+    CHECK(ui_load_screen(screen));
+    CHECK(ui_set_bg_color(label, lv_color_white()));
+    lv_obj_del_async(screen);
+    lv_obj_del_async(title);
+    lv_fake_run_async();
+    uint32_t loads = lv_fake_scr_loads();
+    CHECK_EQ(ui_queue_drain(), 1);
+    CHECK_EQ(lv_fake_scr_loads(), loads);
+    CHECK(title->text[0] == '\0');
+    CHECK_EQ(label->bg_color.full, lv_color_white().full);
+    ui_queue_get_stats(&stats);
+    CHECK_EQ(stats.stale, 2);
+    // a key to the active screen has no object to check
+    CHECK(ui_send_key(NULL, LV_KEY_ESC));
+    CHECK_EQ(ui_queue_drain(), 1);
+
+    // producers racing each other and the consumer
+    ui_queue_get_stats(&stats);
+    uint32_t applied_before = stats.applied;
+    uint32_t dropped_before = stats.dropped;
+    for (int i = 0; i < PRODUCERS; i++) {
+        targets[i] = lv_obj_create(NULL);
+    }
+    pthread_t threads[PRODUCERS];
+    for (int i = 0; i < PRODUCERS; i++) {
+        pthread_create(&threads[i], NULL, producer, (void *)(intptr_t)i);
+    }
+    uint16_t last[PRODUCERS] = { 0 };
+    uint32_t reorders = 0;
+    uint64_t drained = 0;
+    while (1) {
+        int done = __atomic_load_n(&producers_done, __ATOMIC_SEQ_CST);
+        uint32_t count = ui_queue_drain();
+        drained += count;
+        if (!count) {
+            sched_yield();
+        }
+        for (int i = 0; i < PRODUCERS; i++) {
+            // every command of a producer lands after its previous one
+            if (targets[i]->bg_color.full < last[i]) {
+                reorders++;
+            }
+            last[i] = targets[i]->bg_color.full;
+        }
+        if (done == PRODUCERS) {
+            drained += ui_queue_drain();
+            break;
+        }
+    }
+    for (int i = 0; i < PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    uint32_t retries = 0;
+    for (int i = 0; i < PRODUCERS; i++) {
+        CHECK_EQ(targets[i]->bg_color_sets, POSTS);
+        CHECK_EQ(targets[i]->bg_color.full, POSTS);
+        retries += full_retries[i];
+    }
+    CHECK_EQ(reorders, 0);
+    CHECK_EQ(drained, (uint64_t)PRODUCERS * POSTS);
+    ui_queue_get_stats(&stats);
+    CHECK_EQ(stats.applied - applied_before, PRODUCERS * POSTS);
+    CHECK_EQ(stats.dropped - dropped_before, retries);
+    CHECK_EQ(stats.posted, stats.applied + stats.stale);
+    CHECK_EQ(wakes, stats.posted);
+    printf("%d producers x %d commands, %lu full-queue retries\n", PRODUCERS, POSTS, (unsigned long)retries);
+    return TEST_RESULT();
+}
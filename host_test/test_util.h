@@ -0,0 +1,39 @@
+/**
+ * @file      test_util.h
+ * @license   MIT
+ *
+ * Minimal checks for the host tests: a failed CHECK reports and counts, the
+ * test's main returns TEST_RESULT().
+ */
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+static int test_failures;
+
+#define CHECK(cond) do {                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                                \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ(a, b) do {                                                 \
+        long long a_ = (long long)(a), b_ = (long long)(b);                 \
+        if (a_ != b_) {                                                     \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %lld, %s == %lld\n", \
+                    __FILE__, __LINE__, #a, a_, #b, b_);                    \
+            test_failures++;                                                \
+        }                                                                   \
+    } while (0)
+
+#define TEST_RESULT() (test_failures ? (fprintf(stderr, "%d check(s) failed\n", test_failures), 1) : 0)
+
+// Nanoseconds of CPU-independent wall time, for the benchmarks
+static inline uint64_t test_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -10,23 +10,93 @@
 #include <driver/spi_master.h>
 #include <sys/cdefs.h>
 #include "driver/gpio.h"
+#include "hal/gpio_ll.h"
 #include "product_pins.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "amoled_driver.h"
+#include "display_rotate.h"
+#include "frame_profiler.h"
 #include <stdlib.h>
 #include <string.h>
 
-#if defined(CONFIG_LILYGO_T_AMOLED_LITE_147) || \
+#if !defined(CONFIG_DISPLAY_HEADLESS) && \
+    (defined(CONFIG_LILYGO_T_AMOLED_LITE_147) || \
     defined(CONFIG_LILYGO_T_DISPLAY_S3_AMOLED) || \
     defined(CONFIG_LILYGO_T_DISPLAY_S3_AMOLED_TOUCH) || \
-    defined(CONFIG_LILYGO_T4_S3_241)
+    defined(CONFIG_LILYGO_T4_S3_241))
 
 #define SEND_BUF_SIZE           (16384)
 #define DEFAULT_SPI_HANDLER     (SPI3_HOST)
+#define SPI_QUEUE_SIZE          (17)
+
+#define MADCTL_MY               (0x80)
+#define MADCTL_MX               (0x40)
+#define MADCTL_MV               (0x20)
+
+#if CONFIG_AMOLED_HW_ROTATION && AMOLED_HAS_MADCTL
+#define USE_HW_ROTATION         (1)
+#else
+#define USE_HW_ROTATION         (0)
+#endif
+
+// Queued transactions carry these in spi_transaction_t::user
+#define TRANS_CS_ASSERT         (1 << 0)    // pull CS low before the transaction
+#define TRANS_CS_RELEASE        (1 << 1)    // release CS after the transaction
+#define TRANS_FLUSH_DONE        (1 << 2)    // last chunk of a frame
+
+#define WINDOW_INVALID          (0xFFFFFFFF)
+
+#define TE_TIMEOUT_MS           (50)
+#define TE_SEED_FRAMES          (3)
 
 static const char *TAG = "AMOLED";
 static uint16_t *pBuffer = NULL;
 static spi_device_handle_t spi = NULL;
 static uint8_t _brightness;
+static display_rotation_t _rotation = (display_rotation_t)AMOLED_DEFAULT_ROTATION;
+static bool _mirror = false;
+
+static TaskHandle_t flush_done_task = NULL;
+// When the last area finished; written before the give, one area in flight at a time
+static volatile int64_t flush_done_us = 0;
+
+#if CONFIG_AMOLED_QUEUED_DMA
+static spi_transaction_ext_t trans_pool[SPI_QUEUE_SIZE];
+static uint32_t trans_next = 0;
+static uint32_t trans_in_flight = 0;
+#endif
+
+// Last column/row bounds sent to the panel, packed as (start << 16) | end
+static uint32_t caset_cache = WINDOW_INVALID;
+static uint32_t raset_cache = WINDOW_INVALID;
+static uint32_t window_cmd_sent = 0;
+static uint32_t window_cmd_skipped = 0;
+
+#if CONFIG_AMOLED_DELTA_FLUSH
+#define DELTA_MAX_BANDS         (8)
+static uint16_t *shadow = NULL;
+// per row, the columns [known_x0, known_x1] the shadow knows the panel shows
+static uint16_t *known_x0 = NULL;
+static uint16_t *known_x1 = NULL;
+static uint32_t delta_px_sent = 0;
+static uint32_t delta_px_skipped = 0;
+#endif
+
+#if CONFIG_AMOLED_TE_SYNC
+static SemaphoreHandle_t te_sem = NULL;
+static volatile int64_t te_last_us = 0;
+static volatile uint32_t te_period_us = 0;
+static volatile uint32_t te_count = 0;
+static volatile uint32_t te_frame_start = 0;
+static volatile uint32_t te_missed = 0;
+static volatile uint32_t te_at_flush_done = 0;     // te_count when the last area finished
+#endif
 
 #ifndef LOW
 #define LOW 0
@@ -46,6 +116,18 @@ void amoled_write_cmd(uint32_t cmd, uint8_t *pdat, uint32_t lenght);
 
 static bool __init_qspi_bus();
 
+static bool __apply_rotation();
+
+static void __init_te();
+
+static void __play_init_script(const uint8_t *script, uint32_t size);
+
+#if CONFIG_AMOLED_DELTA_FLUSH
+static void __init_shadow();
+
+static void __shadow_forget();
+#endif
+
 #define delay(ms)   vTaskDelay(ms / portTICK_PERIOD_MS)
 
 static void pinMode(uint32_t gpio, uint8_t mode)
@@ -64,30 +146,68 @@ void digitalWrite(uint32_t gpio, uint8_t level)
     gpio_set_level((gpio_num_t )gpio, level);
 }
 
-static void inline setCS()
+// CS is also driven from the SPI ISR, which with CONFIG_SPI_MASTER_ISR_IN_IRAM
+// must not reach flash: gpio_set_level() is only in IRAM with
+// CONFIG_GPIO_CTRL_FUNC_IN_IRAM, the LL register write is always inlined.
+FORCE_INLINE_ATTR void setCS()
 {
-    digitalWrite(BOARD_DISP_CS, LOW);
+    gpio_ll_set_level(&GPIO, BOARD_DISP_CS, LOW);
 }
 
-static void inline clrCS()
+FORCE_INLINE_ATTR void clrCS()
 {
-    digitalWrite(BOARD_DISP_CS, HIGH);
+    gpio_ll_set_level(&GPIO, BOARD_DISP_CS, HIGH);
 }
 
-void display_init()
+// An area finished outside the ISR: no transfer, or the queue failed
+static void __flush_done()
 {
-    __init_qspi_bus();
+    flush_done_us = esp_timer_get_time();
+#if CONFIG_AMOLED_TE_SYNC
+    te_at_flush_done = te_count;
+#endif
+    if (flush_done_task) {
+        xTaskNotifyGiveIndexed(flush_done_task, AMOLED_FLUSH_NOTIFY_INDEX);
+    }
 }
 
-static bool __init_qspi_bus()
+// The transaction callbacks run in ISR context for every transaction, polling
+// ones included; those leave user NULL and drive CS themselves.
+static void IRAM_ATTR amoled_pre_trans_cb(spi_transaction_t *t)
 {
-#if CONFIG_LILYGO_T_AMOLED_LITE_147
-    pBuffer = (uint16_t *)heap_caps_malloc(AMOLED_WIDTH * AMOLED_HEIGHT * sizeof(uint16_t), MALLOC_CAP_DMA);
-    if (!pBuffer) {
-        ESP_LOGE(TAG, "ERROR:No memory use .."); return false;
+    uint32_t flags = (uint32_t)(uintptr_t)t->user;
+    if (flags & TRANS_CS_ASSERT) {
+        setCS();
+    }
+}
+
+static void IRAM_ATTR amoled_post_trans_cb(spi_transaction_t *t)
+{
+    uint32_t flags = (uint32_t)(uintptr_t)t->user;
+    if (flags & TRANS_CS_RELEASE) {
+        clrCS();
     }
+    if ((flags & TRANS_FLUSH_DONE) && flush_done_task) {
+        // esp_timer_get_time() is in IRAM; the task may only run much later
+        flush_done_us = esp_timer_get_time();
+#if CONFIG_AMOLED_TE_SYNC
+        te_at_flush_done = te_count;
 #endif
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR(flush_done_task, AMOLED_FLUSH_NOTIFY_INDEX, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+void display_init()
+{
+    __init_qspi_bus();
+}
 
+static bool __init_qspi_bus()
+{
 #if defined(CONFIG_LILYGO_T_AMOLED_LITE_147)
     ESP_LOGI(TAG, "============LILYGO_T_AMOLED_LITE_147============");
 #elif defined(CONFIG_LILYGO_T_DISPLAY_S3_AMOLED)
@@ -115,7 +235,7 @@ static bool __init_qspi_bus()
     pinMode(BOARD_DISP_CS, OUTPUT);
 
     if (BOARD_DISP_TE != -1) {
-        //
+        pinMode(BOARD_DISP_TE, INPUT);
     }
 
     if (AMOLED_EN_PIN != -1) {
@@ -152,7 +272,9 @@ static bool __init_qspi_bus()
         .clock_speed_hz = DEFAULT_SCK_SPEED,
         .spics_io_num = -1,
         .flags = SPI_DEVICE_HALFDUPLEX,
-        .queue_size = 17,
+        .queue_size = SPI_QUEUE_SIZE,
+        .pre_cb = amoled_pre_trans_cb,
+        .post_cb = amoled_post_trans_cb,
     };
     esp_err_t ret = spi_bus_initialize(DEFAULT_SPI_HANDLER, &buscfg, SPI_DMA_CH_AUTO);
     if (ret != ESP_OK) {
@@ -165,22 +287,195 @@ static bool __init_qspi_bus()
         return false;
     }
     // prevent initialization failure
+    int64_t init_start = esp_timer_get_time();
     int retry = 2;
     while (retry--) {
-        const lcd_cmd_t *t = AMOLED_INIT_CMD;
-        for (uint32_t i = 0; i < AMOLED_INIT_CMD_LEN; i++) {
-            amoled_write_cmd(t[i].addr, (uint8_t *)t[i].param, t[i].len & 0x1F);
-            if (t[i].len & 0x80) {
-                delay(120);
-            }
-            if (t[i].len & 0x20) {
-                delay(10);
-            }
+        __play_init_script(AMOLED_INIT_SCRIPT, AMOLED_INIT_SCRIPT_SIZE);
+    }
+    ESP_LOGI(TAG, "Init script %lu bytes, %lld us",
+             (unsigned long)AMOLED_INIT_SCRIPT_SIZE, (long long)(esp_timer_get_time() - init_start));
+    if (!__apply_rotation()) {
+        return false;
+    }
+    __init_te();
+#if CONFIG_AMOLED_DELTA_FLUSH
+    __init_shadow();
+#endif
+    return true;
+}
+
+#if CONFIG_AMOLED_TE_SYNC
+// Rising TE edge: the panel has started a new scan from the first line
+static void IRAM_ATTR te_isr_handler(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+    if (te_last_us) {
+        uint32_t period = (uint32_t)(now - te_last_us);
+        // moving average over 8 frames
+        te_period_us = te_period_us ? te_period_us - (te_period_us >> 3) + (period >> 3) : period;
+    }
+    te_last_us = now;
+    te_count++;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(te_sem, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+#endif
+
+static void __init_te()
+{
+#if CONFIG_AMOLED_TE_SYNC
+    if (BOARD_DISP_TE == -1) {
+        return;
+    }
+    te_sem = xSemaphoreCreateBinary();
+    assert(te_sem);
+    // TE output on, vblank only
+    uint8_t mode = 0x00;
+    amoled_write_cmd(0x3500, &mode, 1);
+
+    gpio_set_intr_type((gpio_num_t)BOARD_DISP_TE, GPIO_INTR_POSEDGE);
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "gpio_install_isr_service fail!");
+        return;
+    }
+    gpio_isr_handler_add((gpio_num_t)BOARD_DISP_TE, te_isr_handler, NULL);
+
+    // seed the period measurement so LVGL can follow the panel refresh rate
+    for (int i = 0; i < TE_SEED_FRAMES; i++) {
+        if (xSemaphoreTake(te_sem, pdMS_TO_TICKS(TE_TIMEOUT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "No TE signal, frame pacing disabled");
+            gpio_isr_handler_remove((gpio_num_t)BOARD_DISP_TE);
+            vSemaphoreDelete(te_sem);
+            te_sem = NULL;
+            return;
+        }
+    }
+    ESP_LOGI(TAG, "TE period %lu us", (unsigned long)te_period_us);
+#endif
+}
+
+void display_wait_vblank()
+{
+#if CONFIG_AMOLED_TE_SYNC
+    if (!te_sem) {
+        return;
+    }
+    // drop a stale edge and wait for the next one
+    xSemaphoreTake(te_sem, 0);
+    TickType_t timeout = pdMS_TO_TICKS(TE_TIMEOUT_MS);
+    if (timeout == 0) {
+        timeout = 1;
+    }
+    if (xSemaphoreTake(te_sem, timeout) != pdTRUE) {
+        te_missed++;
+    }
+#endif
+}
+
+void display_frame_begin()
+{
+#if CONFIG_AMOLED_TE_SYNC
+    te_frame_start = te_count;
+#endif
+}
+
+void display_frame_end()
+{
+#if CONFIG_AMOLED_TE_SYNC
+    // the transfer ran into the next scan: that frame may have torn
+    if (te_sem && te_at_flush_done != te_frame_start) {
+        te_missed++;
+    }
+#endif
+}
+
+uint32_t display_frame_period_us()
+{
+#if CONFIG_AMOLED_TE_SYNC
+    return te_period_us;
+#else
+    return 0;
+#endif
+}
+
+void display_get_te_stats(display_te_stats_t *stats)
+{
+#if CONFIG_AMOLED_TE_SYNC
+    stats->frame_period_us = te_period_us;
+    stats->vblank_count = te_count;
+    stats->missed_vblank = te_missed;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+// Program MADCTL for the current rotation, or prepare the software fallback
+static bool __apply_rotation()
+{
+#if USE_HW_ROTATION
+    // every rotation is reached from the panel default by flipping these bits
+    static const uint8_t madctl_rotation[] = {
+        0x00,
+        MADCTL_MX | MADCTL_MV,
+        MADCTL_MX | MADCTL_MY,
+        MADCTL_MY | MADCTL_MV,
+    };
+    uint8_t madctl = AMOLED_MADCTL_DEFAULT ^ madctl_rotation[_rotation];
+    caset_cache = WINDOW_INVALID;
+    raset_cache = WINDOW_INVALID;
+    if (_mirror) {
+        madctl ^= MADCTL_MX;
+    }
+    amoled_write_cmd(0x3600, &madctl, 1);
+#else
+    if (_rotation == DISPLAY_ROTATE_0 && !_mirror) {
+        return true;
+    }
+    if (!pBuffer) {
+        pBuffer = (uint16_t *)heap_caps_malloc(AMOLED_WIDTH * AMOLED_HEIGHT * sizeof(uint16_t), MALLOC_CAP_DMA);
+        if (!pBuffer) {
+            ESP_LOGE(TAG, "ERROR:No memory use .."); return false;
         }
     }
+#endif
     return true;
 }
 
+bool display_set_rotation(display_rotation_t rotation, bool mirror)
+{
+    amoled_wait_idle();
+    _rotation = rotation;
+    _mirror = mirror;
+#if CONFIG_AMOLED_DELTA_FLUSH
+    __shadow_forget();
+#endif
+    return __apply_rotation();
+}
+
+display_rotation_t display_get_rotation()
+{
+    return _rotation;
+}
+
+static bool __swap_xy()
+{
+    return _rotation == DISPLAY_ROTATE_90 || _rotation == DISPLAY_ROTATE_270;
+}
+
+uint16_t display_width()
+{
+    return __swap_xy() ? AMOLED_HEIGHT : AMOLED_WIDTH;
+}
+
+uint16_t display_height()
+{
+    return __swap_xy() ? AMOLED_WIDTH : AMOLED_HEIGHT;
+}
+
 uint16_t  amoled_width()
 {
     return AMOLED_WIDTH;
@@ -191,8 +486,35 @@ uint16_t  amoled_height()
     return AMOLED_HEIGHT;
 }
 
+void amoled_register_flush_done_task(TaskHandle_t task)
+{
+    flush_done_task = task;
+}
+
+int64_t display_flush_done_us()
+{
+    return flush_done_us;
+}
+
+// Block until every queued pixel transaction has been collected
+void amoled_wait_idle()
+{
+#if CONFIG_AMOLED_QUEUED_DMA
+    spi_transaction_t *rtrans;
+    while (trans_in_flight) {
+        if (spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY) != ESP_OK) {
+            ESP_LOGE(TAG, "spi_device_get_trans_result fail!");
+            break;
+        }
+        trans_in_flight--;
+    }
+#endif
+}
+
 void amoled_write_cmd(uint32_t cmd, uint8_t *pdat, uint32_t lenght)
 {
+    // polling transactions must not overtake a frame still on the wire
+    amoled_wait_idle();
     setCS();
     spi_transaction_t t;
     memset(&t, 0, sizeof(t));
@@ -257,6 +579,18 @@ void amoled_set_window(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
     for (uint32_t i = 0; i < 3; i++) {
         amoled_write_cmd(t[i].addr, t[i].param, t[i].len);
     }
+    caset_cache = WINDOW_INVALID;
+    raset_cache = WINDOW_INVALID;
+#if CONFIG_AMOLED_DELTA_FLUSH
+    // pixels pushed through this window bypass the shadow
+    __shadow_forget();
+#endif
+}
+
+void amoled_get_window_stats(uint32_t *sent, uint32_t *skipped)
+{
+    *sent = window_cmd_sent;
+    *skipped = window_cmd_skipped;
 }
 
 // Push (aka write pixel) colours to the TFT (use amoled_set_window() first)
@@ -266,6 +600,7 @@ void amoled_push_buffer(uint16_t *data, uint32_t len)
     uint16_t *p = data;
     assert(p);
     assert(spi);
+    amoled_wait_idle();
     setCS();
     do {
         size_t chunk_size = len;
@@ -294,28 +629,394 @@ void amoled_push_buffer(uint16_t *data, uint32_t len)
     clrCS();
 }
 
+#if CONFIG_AMOLED_QUEUED_DMA
+static spi_transaction_ext_t *__next_trans()
+{
+    spi_transaction_t *rtrans;
+    // transactions complete in order, so the oldest slot is free once collected
+    if (trans_in_flight == SPI_QUEUE_SIZE) {
+        spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY);
+        trans_in_flight--;
+    }
+    spi_transaction_ext_t *t = &trans_pool[trans_next];
+    trans_next = (trans_next + 1) % SPI_QUEUE_SIZE;
+    memset(t, 0, sizeof(*t));
+    return t;
+}
+
+static bool __queue_trans(spi_transaction_ext_t *t, uint32_t flags)
+{
+    t->base.user = (void *)(uintptr_t)flags;
+    if (spi_device_queue_trans(spi, (spi_transaction_t *)t, portMAX_DELAY) != ESP_OK) {
+        ESP_LOGE(TAG, "spi_device_queue_trans fail!");
+        return false;
+    }
+    trans_in_flight++;
+    return true;
+}
+
+// Queue a register write with its own CS cycle. Up to 4 parameter bytes are
+// copied into the transaction, longer ones must outlive it.
+static bool __queue_cmd(uint32_t cmd, const uint8_t *pdat, uint32_t lenght)
+{
+    spi_transaction_ext_t *t = __next_trans();
+    t->base.flags = SPI_TRANS_MULTILINE_CMD | SPI_TRANS_MULTILINE_ADDR;
+    t->base.cmd = 0x02;
+    t->base.addr = cmd;
+    if (lenght <= 4) {
+        t->base.flags |= SPI_TRANS_USE_TXDATA;
+        memcpy(t->base.tx_data, pdat, lenght);
+    } else {
+        t->base.tx_buffer = pdat;
+    }
+    t->base.length = 8 * lenght;
+    return __queue_trans(t, TRANS_CS_ASSERT | TRANS_CS_RELEASE);
+}
+
+// Queue every chunk of the pixel block behind any pending commands and return
+// immediately. CS is driven from the ISR, which also notifies the flush-done
+// task after the last chunk when flush_done is set.
+static void __queue_pixels(uint16_t *data, uint32_t len, bool flush_done)
+{
+    bool first_send = true;
+    uint16_t *p = data;
+    assert(p);
+    assert(spi);
+    do {
+        size_t chunk_size = len;
+        uint32_t flags = 0;
+        spi_transaction_ext_t *t = __next_trans();
+        if (first_send) {
+            t->base.flags = SPI_TRANS_MODE_QIO;
+            t->base.cmd = 0x32 ;
+            t->base.addr = 0x002C00;
+            flags |= TRANS_CS_ASSERT;
+            first_send = 0;
+        } else {
+            t->base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+            t->command_bits = 0;
+            t->address_bits = 0;
+            t->dummy_bits = 0;
+        }
+        if (chunk_size > SEND_BUF_SIZE) {
+            chunk_size = SEND_BUF_SIZE;
+        }
+        t->base.tx_buffer = p;
+        t->base.length = chunk_size * 16;
+        len -= chunk_size;
+        p += chunk_size;
+        if (!len) {
+            flags |= TRANS_CS_RELEASE;
+            if (flush_done) {
+                flags |= TRANS_FLUSH_DONE;
+            }
+        }
+        if (!__queue_trans(t, flags)) {
+            clrCS();
+            if (flush_done) {
+                __flush_done();
+            }
+            return;
+        }
+    } while (len > 0);
+}
+
+void amoled_push_buffer_queued(uint16_t *data, uint32_t len)
+{
+    __queue_pixels(data, len, true);
+}
+#endif
+
+// Replay a packed init script (see gen_init_script.py). Commands between
+// delays are queued back-to-back; the queue is drained before each delay.
+static void __play_init_script(const uint8_t *script, uint32_t size)
+{
+    uint32_t pos = 0;
+    while (pos + 2 <= size) {
+        uint32_t cmd = (uint32_t)script[pos] << 8;
+        uint8_t flags = script[pos + 1];
+        uint32_t count = flags & 0x1F;
+        const uint8_t *param = &script[pos + 2];
+        pos += 2 + count;
+#if CONFIG_AMOLED_QUEUED_DMA
+        __queue_cmd(cmd, param, count);
+#else
+        amoled_write_cmd(cmd, (uint8_t *)param, count);
+#endif
+        if (flags & (0x80 | 0x20)) {
+            amoled_wait_idle();
+        }
+        if (flags & 0x80) {
+            delay(120);
+        }
+        if (flags & 0x20) {
+            delay(10);
+        }
+    }
+    amoled_wait_idle();
+}
+
+static void __send_window_cmd(uint32_t cmd, uint32_t range)
+{
+    uint8_t param[4] = {
+        (uint8_t)((range >> 24) & 0xFF),
+        (uint8_t)((range >> 16) & 0xFF),
+        (uint8_t)((range >> 8) & 0xFF),
+        (uint8_t)(range & 0xFF)
+    };
+#if CONFIG_AMOLED_QUEUED_DMA
+    __queue_cmd(cmd, param, sizeof(param));
+#else
+    amoled_write_cmd(cmd, param, sizeof(param));
+#endif
+    window_cmd_sent++;
+}
+
+// Like amoled_set_window(), but only sends the bounds that changed since the
+// last flush and leaves RAMWR to the first pixel chunk. In queued mode the
+// commands go out back-to-back with the pixels that follow.
+static void display_set_window(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
+{
+#if CONFIG_LILYGO_T4_S3_241
+    xs += 16;
+    xe += 16;
+#endif
+    uint32_t caset = ((uint32_t)xs << 16) | xe;
+    uint32_t raset = ((uint32_t)ys << 16) | ye;
+    if (caset != caset_cache) {
+        __send_window_cmd(0x2A00, caset);
+        caset_cache = caset;
+    } else {
+        window_cmd_skipped++;
+    }
+    if (raset != raset_cache) {
+        __send_window_cmd(0x2B00, raset);
+        raset_cache = raset;
+    } else {
+        window_cmd_skipped++;
+    }
+}
+
+static void display_push_pixels(uint16_t *data, uint32_t len, bool flush_done)
+{
+#if CONFIG_AMOLED_QUEUED_DMA
+    __queue_pixels(data, len, flush_done);
+#else
+    amoled_push_buffer(data, len);
+    if (flush_done) {
+        __flush_done();
+    }
+#endif
+}
+
+#if CONFIG_AMOLED_DELTA_FLUSH
+typedef struct {
+    uint16_t y0, y1;        // rows, relative to the flushed area
+    uint16_t x0, x1;        // union of the changed spans of those rows
+} delta_band_t;
+
+#define SHADOW_ROWS             (AMOLED_WIDTH > AMOLED_HEIGHT ? AMOLED_WIDTH : AMOLED_HEIGHT)
+
+static void __init_shadow()
+{
+    shadow = (uint16_t *)heap_caps_calloc(AMOLED_WIDTH * AMOLED_HEIGHT, sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    known_x0 = (uint16_t *)heap_caps_malloc(SHADOW_ROWS * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    known_x1 = (uint16_t *)heap_caps_malloc(SHADOW_ROWS * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    if (!shadow || !known_x0 || !known_x1) {
+        ESP_LOGE(TAG, "No memory for the delta shadow framebuffer, delta flush disabled");
+        heap_caps_free(shadow);
+        heap_caps_free(known_x0);
+        heap_caps_free(known_x1);
+        shadow = NULL;
+        return;
+    }
+    __shadow_forget();
+}
+
+// The panel content is unknown, e.g. after a rotation
+static void __shadow_forget()
+{
+    if (!shadow) {
+        return;
+    }
+    for (uint32_t row = 0; row < SHADOW_ROWS; row++) {
+        known_x0[row] = UINT16_MAX;
+        known_x1[row] = 0;
+    }
+}
+
+// Record an area sent in full. A row keeps one known column span: the area
+// extends it when they touch, and replaces it when wider.
+static void __shadow_store(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, const uint16_t *data)
+{
+    uint16_t stride = display_width();
+    uint16_t x0 = x;
+    uint16_t x1 = x + width - 1;
+    for (uint16_t row = 0; row < hight; row++) {
+        uint32_t r = y + row;
+        memcpy(shadow + r * stride + x, data + (uint32_t)row * width, width * sizeof(uint16_t));
+        bool empty = known_x0[r] > known_x1[r];
+        if (!empty && x0 <= known_x1[r] + 1 && x1 + 1 >= known_x0[r]) {
+            known_x0[r] = x0 < known_x0[r] ? x0 : known_x0[r];
+            known_x1[r] = x1 > known_x1[r] ? x1 : known_x1[r];
+        } else if (empty || width > known_x1[r] - known_x0[r] + 1) {
+            known_x0[r] = x0;
+            known_x1[r] = x1;
+        }
+    }
+}
+
+// Send only the rows and columns of an area that differ from what the panel
+// already shows. Returns false when the whole area should be sent instead;
+// the shadow framebuffer is up to date either way.
+static bool display_push_delta(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data)
+{
+    uint16_t stride = display_width();
+    uint32_t area_px = (uint32_t)width * hight;
+
+    if (!shadow) {
+        return false;
+    }
+    // compare only against pixels an earlier area has put on the panel
+    for (uint16_t row = 0; row < hight; row++) {
+        if (known_x0[y + row] > x || known_x1[y + row] < x + width - 1) {
+            __shadow_store(x, y, width, hight, data);
+            return false;
+        }
+    }
+
+    delta_band_t bands[DELTA_MAX_BANDS];
+    uint32_t band_cnt = 0;
+    bool overflow = false;
+    for (uint16_t row = 0; row < hight; row++) {
+        uint16_t *src = data + (uint32_t)row * width;
+        uint16_t *dst = shadow + (uint32_t)(y + row) * stride + x;
+        // memcmp is the vectorised fast path for unchanged rows
+        if (memcmp(src, dst, width * sizeof(uint16_t)) == 0) {
+            continue;
+        }
+        uint16_t l = 0;
+        uint16_t r = width - 1;
+        while (src[l] == dst[l]) {
+            l++;
+        }
+        while (src[r] == dst[r]) {
+            r--;
+        }
+        memcpy(dst + l, src + l, (r - l + 1) * sizeof(uint16_t));
+
+        if (band_cnt && bands[band_cnt - 1].y1 + 1 == row) {
+            delta_band_t *b = &bands[band_cnt - 1];
+            b->y1 = row;
+            b->x0 = l < b->x0 ? l : b->x0;
+            b->x1 = r > b->x1 ? r : b->x1;
+        } else if (band_cnt < DELTA_MAX_BANDS) {
+            bands[band_cnt++] = (delta_band_t) {
+                row, row, l, r
+            };
+        } else {
+            overflow = true;
+        }
+    }
+    if (overflow) {
+        return false;
+    }
+
+    uint32_t changed_px = 0;
+    for (uint32_t i = 0; i < band_cnt; i++) {
+        changed_px += (uint32_t)(bands[i].x1 - bands[i].x0 + 1) * (bands[i].y1 - bands[i].y0 + 1);
+    }
+    if (changed_px * 100 > area_px * CONFIG_AMOLED_DELTA_FULL_PERCENT) {
+        return false;
+    }
+
+    delta_px_skipped += area_px - changed_px;
+    delta_px_sent += changed_px;
+    if (band_cnt == 0) {
+        __flush_done();
+        return true;
+    }
+    for (uint32_t i = 0; i < band_cnt; i++) {
+        const delta_band_t *b = &bands[i];
+        uint16_t bw = b->x1 - b->x0 + 1;
+        uint16_t bh = b->y1 - b->y0 + 1;
+        // pack the band in place at the start of its own rows; LVGL redraws
+        // this buffer before using it again and earlier bands are untouched
+        uint16_t *out = data + (uint32_t)b->y0 * width;
+        if (bw != width) {
+            for (uint16_t r = 0; r < bh; r++) {
+                memmove(out + (uint32_t)r * bw, data + (uint32_t)(b->y0 + r) * width + b->x0, bw * sizeof(uint16_t));
+            }
+        }
+        display_set_window(x + b->x0, y + b->y0, x + b->x1, y + b->y1);
+        display_push_pixels(out, (uint32_t)bw * bh, i == band_cnt - 1);
+    }
+    return true;
+}
+#endif
+
+void amoled_get_delta_stats(uint32_t *px_sent, uint32_t *px_skipped)
+{
+#if CONFIG_AMOLED_DELTA_FLUSH
+    *px_sent = delta_px_sent;
+    *px_skipped = delta_px_skipped;
+#else
+    *px_sent = 0;
+    *px_skipped = 0;
+#endif
+}
+
 void display_push_colors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data)
 {
 
-    if (pBuffer) {
+    if (!USE_HW_ROTATION && (_rotation != DISPLAY_ROTATE_0 || _mirror)) {
         assert(pBuffer);
-        uint16_t _x = AMOLED_WIDTH - (y + hight);
-        uint16_t _y = x;
-        uint16_t _h = width;
-        uint16_t _w = hight;
-        uint16_t *p = data;
-        uint32_t cum = 0;
-        for (uint16_t j = 0; j < width; j++) {
-            for (uint16_t i = 0; i < hight; i++) {
-                pBuffer[cum] = ((uint16_t)p[width * (hight - i - 1) + j]);
-                cum++;
-            }
+        // pBuffer may still be feeding the previous transfer
+        amoled_wait_idle();
+        uint16_t _x, _y, _w, _h;
+        switch (_rotation) {
+        case DISPLAY_ROTATE_90:
+            _x = AMOLED_WIDTH - (y + hight);
+            _y = x;
+            _w = hight;
+            _h = width;
+            break;
+        case DISPLAY_ROTATE_180:
+            _x = AMOLED_WIDTH - (x + width);
+            _y = AMOLED_HEIGHT - (y + hight);
+            _w = width;
+            _h = hight;
+            break;
+        case DISPLAY_ROTATE_270:
+            _x = y;
+            _y = AMOLED_HEIGHT - (x + width);
+            _w = hight;
+            _h = width;
+            break;
+        default:
+            _x = x;
+            _y = y;
+            _w = width;
+            _h = hight;
+            break;
         }
-        amoled_set_window(_x, _y, _x + _w - 1, _y + _h - 1);
-        amoled_push_buffer(pBuffer, width * hight);
+        if (_mirror) {
+            _x = AMOLED_WIDTH - (_x + _w);
+        }
+        int64_t rotate_start = frame_profiler_now();
+        display_rotate_copy(pBuffer, data, width, hight, _rotation, _mirror);
+        frame_profiler_record(FRAME_STAGE_ROTATE, rotate_start, frame_profiler_now());
+        display_set_window(_x, _y, _x + _w - 1, _y + _h - 1);
+        display_push_pixels(pBuffer, width * hight, true);
     } else {
-        amoled_set_window(x, y, x + width - 1, y + hight - 1);
-        amoled_push_buffer(data, width * hight);
+#if CONFIG_AMOLED_DELTA_FLUSH
+        if (display_push_delta(x, y, width, hight, data)) {
+            return;
+        }
+        delta_px_sent += (uint32_t)width * hight;
+#endif
+        display_set_window(x, y, x + width - 1, y + hight - 1);
+        display_push_pixels(data, width * hight, true);
     }
 }
 
@@ -6,28 +6,104 @@
  * @date      2024-01-07
  *
  */
-
+#pragma once
 #include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "product_pins.h"
+#include "display_rotate.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Task notification index given once per area by display_push_colors()
+#define AMOLED_FLUSH_NOTIFY_INDEX   1
+
+#if AMOLED_FLUSH_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES
+#error "Set CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES to 2 or more for the flush-done notification"
+#endif
+
+typedef struct {
+    uint32_t        frame_period_us;    // measured TE period, 0 without TE
+    uint32_t        vblank_count;       // TE edges seen
+    uint32_t        missed_vblank;      // frames that timed out or ran past the next TE
+} display_te_stats_t;
+
 void display_init();
 
 uint16_t  amoled_width();
 
 uint16_t  amoled_height();
 
+/**
+ * @brief Rotate the panel. Uses the panel MADCTL register when the board
+ *        supports it, otherwise rotates each area into a DMA bounce buffer.
+ */
+bool display_set_rotation(display_rotation_t rotation, bool mirror);
+
+display_rotation_t display_get_rotation();
+
+/**
+ * @brief Frame pacing against the panel TE line. display_wait_vblank() blocks
+ *        until the next vblank, at most 50 ms (counted as missed); call it
+ *        before a refresh without holding the LVGL lock.
+ *        display_frame_begin() marks the start of the refresh when its first
+ *        area is flushed, and display_frame_end() is called once the
+ *        flush-done notification for the last area was taken; a frame whose
+ *        last area finished after the next TE is counted as missed. All are
+ *        no-ops on boards without TE or with CONFIG_AMOLED_TE_SYNC disabled.
+ */
+void display_wait_vblank();
+
+void display_frame_begin();
+
+void display_frame_end();
+
+uint32_t display_frame_period_us();
+
+void display_get_te_stats(display_te_stats_t *stats);
+
+// Logical resolution after rotation, as seen by LVGL
+uint16_t display_width();
+
+uint16_t display_height();
+
 void amoled_set_brightness(uint8_t level);
 
 uint8_t amoled_get_brightness();
 
 void amoled_set_window(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye);
 
+// Column/row address commands sent vs. skipped as unchanged by display_push_colors()
+void amoled_get_window_stats(uint32_t *sent, uint32_t *skipped);
+
+// Pixels sent vs. skipped as unchanged with CONFIG_AMOLED_DELTA_FLUSH
+void amoled_get_delta_stats(uint32_t *px_sent, uint32_t *px_skipped);
+
 void amoled_push_buffer(uint16_t *data, uint32_t len);
 
+void amoled_push_buffer_queued(uint16_t *data, uint32_t len);
+
+void amoled_wait_idle();
+
+/**
+ * @brief Register the task notified on AMOLED_FLUSH_NOTIFY_INDEX once
+ *        display_push_colors() has finished with its source buffer, one give
+ *        per area. With CONFIG_AMOLED_QUEUED_DMA the give comes from the SPI
+ *        post-transaction ISR, which does nothing else; the task takes it with
+ *        ulTaskNotifyTakeIndexed() and does the bookkeeping.
+ */
+void amoled_register_flush_done_task(TaskHandle_t task);
+
+/**
+ * @brief esp_timer time at which the last area finished, taken in the ISR
+ *        before the notification is given. Read it after taking the
+ *        notification: the task may run long after the transfer ended.
+ */
+int64_t display_flush_done_us();
+
 void display_push_colors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data);
 
 #ifdef __cplusplus
@@ -0,0 +1,144 @@
+/**
+ * @file      area_planner.c
+ * @license   MIT
+ *
+ */
+
+#include <string.h>
+#include "lvgl.h"
+#include "product_pins.h"
+#include "area_planner.h"
+
+// Cost model: a flushed area costs a fixed window setup overhead plus its
+// pixels. Both are expressed in pixel transfer times so they can be compared.
+#ifndef DISPLAY_AREA_OVERHEAD_US
+#define DISPLAY_AREA_OVERHEAD_US    (20)
+#endif
+
+#ifdef DEFAULT_SCK_SPEED
+// QSPI moves 4 bits per clock, 4 clocks per RGB565 pixel
+#define PIXELS_PER_US               (DEFAULT_SCK_SPEED / 4 / 1000000)
+#else
+#define PIXELS_PER_US               (10)
+#endif
+
+#define AREA_OVERHEAD_PX            (DISPLAY_AREA_OVERHEAD_US * PIXELS_PER_US)
+// share of the overhead spent on the column address command
+#define CASET_OVERHEAD_PX           (AREA_OVERHEAD_PX / 4)
+
+static area_planner_stats_t planner_stats;
+
+static void area_union(lv_area_t *res, const lv_area_t *a, const lv_area_t *b)
+{
+    res->x1 = LV_MIN(a->x1, b->x1);
+    res->y1 = LV_MIN(a->y1, b->y1);
+    res->x2 = LV_MAX(a->x2, b->x2);
+    res->y2 = LV_MAX(a->y2, b->y2);
+}
+
+// Areas swallowed by a grown one would only be drawn twice
+static void area_absorb(lv_disp_t *disp, uint16_t grown)
+{
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (i != grown && !disp->inv_area_joined[i] &&
+                _lv_area_is_in(&disp->inv_areas[i], &disp->inv_areas[grown], 0)) {
+            disp->inv_area_joined[i] = 1;
+        }
+    }
+}
+
+// Merge the pair that saves the most, until no merge pays off
+static void area_plan_merges(lv_disp_t *disp)
+{
+    while (1) {
+        uint32_t best_gain = 0;
+        uint16_t best_i = 0, best_j = 0;
+        lv_area_t best;
+        for (uint16_t i = 0; i < disp->inv_p; i++) {
+            if (disp->inv_area_joined[i]) {
+                continue;
+            }
+            const lv_area_t *a = &disp->inv_areas[i];
+            for (uint16_t j = i + 1; j < disp->inv_p; j++) {
+                if (disp->inv_area_joined[j]) {
+                    continue;
+                }
+                const lv_area_t *b = &disp->inv_areas[j];
+                lv_area_t merged;
+                area_union(&merged, a, b);
+                uint32_t separate_cost = 2 * AREA_OVERHEAD_PX + lv_area_get_size(a) + lv_area_get_size(b);
+                uint32_t merged_cost = AREA_OVERHEAD_PX + lv_area_get_size(&merged);
+                if (merged_cost < separate_cost && separate_cost - merged_cost > best_gain) {
+                    best_gain = separate_cost - merged_cost;
+                    best_i = i;
+                    best_j = j;
+                    best = merged;
+                }
+            }
+        }
+        if (!best_gain) {
+            return;
+        }
+        // LVGL's own join would have made this merge: overlapping and
+        // smaller together, so nothing is saved over it
+        const lv_area_t *a = &disp->inv_areas[best_i];
+        const lv_area_t *b = &disp->inv_areas[best_j];
+        bool lvgl_joins = _lv_area_is_on(a, b) &&
+                          lv_area_get_size(&best) < lv_area_get_size(a) + lv_area_get_size(b);
+        if (!lvgl_joins) {
+            planner_stats.merged++;
+            planner_stats.saved_px += best_gain;
+        }
+        disp->inv_areas[best_i] = best;
+        disp->inv_area_joined[best_j] = 1;
+        area_absorb(disp, best_i);
+    }
+}
+
+// full-width areas share column bounds, so the driver can skip CASET
+static void area_plan_widen(lv_disp_t *disp)
+{
+    lv_coord_t hor_res = disp->driver->hor_res;
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (disp->inv_area_joined[i]) {
+            continue;
+        }
+        lv_area_t *area = &disp->inv_areas[i];
+        uint32_t extra = (uint32_t)(hor_res - lv_area_get_width(area)) * lv_area_get_height(area);
+        if (extra && extra < CASET_OVERHEAD_PX) {
+            area->x1 = 0;
+            area->x2 = hor_res - 1;
+            area_absorb(disp, i);
+            planner_stats.widened++;
+            planner_stats.saved_px += CASET_OVERHEAD_PX - extra;
+        }
+    }
+}
+
+/*
+ * Runs in place of LVGL's refresh timer callback, on the areas invalidated
+ * since the last refresh. A rounder_cb would also be handed LVGL's own
+ * probe areas: get_max_row() rounds {0, 0, 0, rows - 1} to size the draw
+ * buffer stripes, and growing that one stalls the refresh.
+ */
+static void area_planner_refr_timer(lv_timer_t *timer)
+{
+    lv_disp_t *disp = (lv_disp_t *)timer->user_data;
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        planner_stats.areas += !disp->inv_area_joined[i];
+    }
+    area_plan_merges(disp);
+    area_plan_widen(disp);
+    _lv_disp_refr_timer(timer);
+}
+
+void area_planner_init(lv_disp_t *disp)
+{
+    memset(&planner_stats, 0, sizeof(planner_stats));
+    lv_timer_set_cb(_lv_disp_get_refr_timer(disp), area_planner_refr_timer);
+}
+
+void area_planner_get_stats(area_planner_stats_t *stats)
+{
+    *stats = planner_stats;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file      area_planner.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct area_planner_stats {
+    uint32_t        areas;          // invalidated areas planned
+    uint32_t        merged;         // areas grown to absorb a neighbour LVGL would not join
+    uint32_t        widened;        // areas extended to the full display width
+    uint32_t        saved_px;       // estimated transfer cost saved, in pixel times
+} area_planner_stats_t;
+
+/**
+ * @brief Hook the planner into the refresh timer of a registered display.
+ *        Before each refresh the pending invalidated areas are merged
+ *        pairwise whenever one transfer of the bounding box is cheaper than
+ *        two window setups plus both areas, and areas close to the full
+ *        width are widened to it.
+ */
+void area_planner_init(lv_disp_t *disp);
+
+void area_planner_get_stats(area_planner_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
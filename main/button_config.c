@@ -0,0 +1,225 @@
+/**
+ * @file      button_config.c
+ * @license   MIT
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+#include "product_pins.h"
+#include "ui_queue.h"
+#include "button_config.h"
+
+#define BUTTON_TASK_STACK_SIZE      (3 * 1024)
+#define BUTTON_EDGE_QUEUE_LEN       32
+
+#define BUTTON_DEBOUNCE_US          (20 * 1000)
+#define BUTTON_LONG_PRESS_US        (800 * 1000)
+#define BUTTON_DOUBLE_CLICK_US      (300 * 1000)
+
+#ifndef BOARD_BUTTON2_PIN
+#define BOARD_BUTTON2_PIN           (-1)
+#endif
+
+typedef struct button_edge {
+    int64_t         time_us;
+    uint8_t         button;
+} button_edge_t;
+
+typedef struct button {
+    int             gpio;
+    button_debounce_t db;
+    int64_t         long_press_us;  // long press deadline while held, 0 = none
+    int64_t         click_us;       // single click deadline after a release, 0 = none
+    bool            long_fired;
+} button_t;
+
+static const char *TAG = "button_config";
+
+static button_t buttons[BUTTON_COUNT] = {
+    [BUTTON_BOOT] = { .gpio = BOARD_BUTTON1_PIN },
+    [BUTTON_USER] = { .gpio = BOARD_BUTTON2_PIN },
+};
+
+// Gestures are sent as LV_EVENT_KEY to the active screen
+static const uint32_t button_keys[BUTTON_COUNT][BUTTON_GESTURE_COUNT] = {
+    [BUTTON_BOOT] = { LV_KEY_NEXT, LV_KEY_PREV, LV_KEY_ESC },
+    [BUTTON_USER] = { LV_KEY_ENTER, LV_KEY_HOME, LV_KEY_END },
+};
+
+static QueueHandle_t edge_queue;
+static button_stats_t stats;
+
+int64_t button_debounce_edge(button_debounce_t *db, int64_t time_us)
+{
+    if (!db->settling) {
+        db->settling = true;
+        db->burst_start_us = time_us;
+    }
+    db->settle_us = time_us + BUTTON_DEBOUNCE_US;
+    return db->settle_us;
+}
+
+bool button_debounce_settle(button_debounce_t *db, int level, int64_t *change_us)
+{
+    bool pressed = (level == 0);
+    db->settling = false;
+    if (pressed == db->pressed) {
+        // the burst was only bounce
+        return false;
+    }
+    db->pressed = pressed;
+    *change_us = db->burst_start_us;
+    return true;
+}
+
+static void IRAM_ATTR button_isr_handler(void *arg)
+{
+    BaseType_t need_yield = pdFALSE;
+    button_edge_t edge = {
+        .time_us = esp_timer_get_time(),
+        .button = (uint8_t)(uintptr_t)arg,
+    };
+    xQueueSendFromISR(edge_queue, &edge, &need_yield);
+    if (need_yield) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void button_deliver(button_id_t id, button_gesture_t gesture)
+{
+    static const char *names[BUTTON_GESTURE_COUNT] = { "click", "double click", "long press" };
+    ESP_LOGI(TAG, "Button %d %s", (int)id, names[gesture]);
+    stats.gestures++;
+    ui_send_key(NULL, button_keys[id][gesture]);
+}
+
+static void button_update(button_id_t id, int64_t now)
+{
+    button_t *b = &buttons[id];
+    int64_t change_us;
+
+    if (b->db.settling && now >= b->db.settle_us &&
+        button_debounce_settle(&b->db, gpio_get_level((gpio_num_t)b->gpio), &change_us)) {
+        stats.changes++;
+        if (b->db.pressed) {
+            b->long_press_us = change_us + BUTTON_LONG_PRESS_US;
+            b->long_fired = false;
+        } else {
+            b->long_press_us = 0;
+            if (b->long_fired) {
+                // the long press was already reported
+            } else if (b->click_us) {
+                b->click_us = 0;
+                button_deliver(id, BUTTON_GESTURE_DOUBLE_CLICK);
+            } else {
+                b->click_us = change_us + BUTTON_DOUBLE_CLICK_US;
+            }
+        }
+    }
+    if (b->long_press_us && now >= b->long_press_us) {
+        b->long_press_us = 0;
+        b->long_fired = true;
+        b->click_us = 0;
+        button_deliver(id, BUTTON_GESTURE_LONG_PRESS);
+    }
+    if (b->click_us && now >= b->click_us) {
+        b->click_us = 0;
+        button_deliver(id, BUTTON_GESTURE_CLICK);
+    }
+}
+
+// Earliest pending debounce or gesture deadline, 0 when idle
+static int64_t button_next_deadline(void)
+{
+    int64_t next = 0;
+    for (int id = 0; id < BUTTON_COUNT; id++) {
+        const button_t *b = &buttons[id];
+        int64_t deadlines[3] = {
+            b->db.settling ? b->db.settle_us : 0, b->long_press_us, b->click_us,
+        };
+        for (int i = 0; i < 3; i++) {
+            if (deadlines[i] && (!next || deadlines[i] < next)) {
+                next = deadlines[i];
+            }
+        }
+    }
+    return next;
+}
+
+/*
+ * Blocks on the edge queue; a timeout is only armed while a debounce or
+ * gesture deadline is pending, so the task sleeps when no button is touched.
+ */
+static void button_task(void *arg)
+{
+    ESP_LOGI(TAG, "Starting button task");
+    button_edge_t edge;
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        int64_t next = button_next_deadline();
+        if (next) {
+            int64_t remaining = next - esp_timer_get_time();
+            wait = remaining <= 0 ? 0 : pdMS_TO_TICKS(remaining / 1000) + 1;
+        }
+        if (xQueueReceive(edge_queue, &edge, wait) == pdTRUE) {
+            stats.edges++;
+            button_debounce_edge(&buttons[edge.button].db, edge.time_us);
+        }
+        int64_t now = esp_timer_get_time();
+        for (int id = 0; id < BUTTON_COUNT; id++) {
+            if (buttons[id].gpio >= 0) {
+                button_update(id, now);
+            }
+        }
+    }
+}
+
+void button_config(void)
+{
+    edge_queue = xQueueCreate(BUTTON_EDGE_QUEUE_LEN, sizeof(button_edge_t));
+    assert(edge_queue);
+
+    // the TE interrupt of the display driver may have installed the service already
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "gpio_install_isr_service fail!");
+        return;
+    }
+
+    for (int id = 0; id < BUTTON_COUNT; id++) {
+        button_t *b = &buttons[id];
+        if (b->gpio < 0) {
+            continue;
+        }
+        // buttons short the pin to ground
+        gpio_config_t io_conf = {
+            .pin_bit_mask = 1ULL << b->gpio,
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = GPIO_PULLUP_ENABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type = GPIO_INTR_ANYEDGE,
+        };
+        gpio_config(&io_conf);
+        b->db.pressed = gpio_get_level((gpio_num_t)b->gpio) == 0;
+        gpio_isr_handler_add((gpio_num_t)b->gpio, button_isr_handler, (void *)(uintptr_t)id);
+    }
+}
+
+void button_go(void)
+{
+    xTaskCreate(button_task, "BUTTON", BUTTON_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+}
+
+void button_get_stats(button_stats_t *out)
+{
+    *out = stats;
+}
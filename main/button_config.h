@@ -0,0 +1,63 @@
+/**
+ * @file      button_config.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BUTTON_BOOT = 0,            // BOARD_BUTTON1_PIN
+    BUTTON_USER,                // BOARD_BUTTON2_PIN, where fitted
+    BUTTON_COUNT,
+} button_id_t;
+
+typedef enum {
+    BUTTON_GESTURE_CLICK = 0,
+    BUTTON_GESTURE_DOUBLE_CLICK,
+    BUTTON_GESTURE_LONG_PRESS,
+    BUTTON_GESTURE_COUNT,
+} button_gesture_t;
+
+/**
+ * @brief Time-based debouncer for one active-low button. Pure state machine:
+ *        feed it edge timestamps and the level read once the line settled,
+ *        so it can be driven by recorded bounce patterns as well as the GPIO.
+ */
+typedef struct button_debounce {
+    bool            pressed;        // debounced state
+    bool            settling;       // edges seen, waiting for the line to go quiet
+    int64_t         burst_start_us; // first edge of the current bounce burst
+    int64_t         settle_us;      // last edge + debounce time
+} button_debounce_t;
+
+// Record an edge; returns the time at which the level should be sampled
+int64_t button_debounce_edge(button_debounce_t *db, int64_t time_us);
+
+/**
+ * @brief Sample the settled level (0 = pressed). Returns true when the debounced
+ *        state changed; *change_us is then the timestamp of the first edge.
+ */
+bool button_debounce_settle(button_debounce_t *db, int level, int64_t *change_us);
+
+typedef struct button_stats {
+    uint32_t        edges;          // interrupts taken
+    uint32_t        changes;        // debounced state changes
+    uint32_t        gestures;       // clicks, double clicks and long presses delivered
+} button_stats_t;
+
+void button_config(void);
+
+void button_go(void);
+
+void button_get_stats(button_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @file      display_headless.c
+ * @license   MIT
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "amoled_driver.h"
+#include "display_headless.h"
+
+#if CONFIG_DISPLAY_HEADLESS
+
+static const char *TAG = "HEADLESS";
+
+static uint16_t *framebuffer = NULL;
+static display_rotation_t _rotation = DISPLAY_ROTATE_0;
+static uint8_t _brightness = AMOLED_DEFAULT_BRIGHTNESS;
+static display_headless_stats_t stats;
+
+static TaskHandle_t flush_done_task = NULL;
+static int64_t flush_done_us = 0;
+
+// window and write position for amoled_set_window()/amoled_push_buffer()
+static uint16_t win_xs, win_ys, win_xe, win_ye;
+static uint16_t win_x, win_y;
+
+void display_init()
+{
+    framebuffer = (uint16_t *)calloc(AMOLED_WIDTH * AMOLED_HEIGHT, sizeof(uint16_t));
+    assert(framebuffer);
+    ESP_LOGI(TAG, "Headless display %dx%d", AMOLED_WIDTH, AMOLED_HEIGHT);
+}
+
+uint16_t  amoled_width()
+{
+    return AMOLED_WIDTH;
+}
+
+uint16_t  amoled_height()
+{
+    return AMOLED_HEIGHT;
+}
+
+// Only records the rotation for display_get_rotation(): the framebuffer keeps
+// the logical image, so mirror is ignored and nothing is remapped
+bool display_set_rotation(display_rotation_t rotation, bool mirror)
+{
+    _rotation = rotation;
+    return true;
+}
+
+display_rotation_t display_get_rotation()
+{
+    return _rotation;
+}
+
+uint16_t display_width()
+{
+    return (_rotation == DISPLAY_ROTATE_90 || _rotation == DISPLAY_ROTATE_270) ? AMOLED_HEIGHT : AMOLED_WIDTH;
+}
+
+uint16_t display_height()
+{
+    return (_rotation == DISPLAY_ROTATE_90 || _rotation == DISPLAY_ROTATE_270) ? AMOLED_WIDTH : AMOLED_HEIGHT;
+}
+
+void display_wait_vblank()
+{
+}
+
+void display_frame_begin()
+{
+}
+
+void display_frame_end()
+{
+    stats.frames++;
+}
+
+uint32_t display_frame_period_us()
+{
+    return 0;
+}
+
+void display_get_te_stats(display_te_stats_t *te_stats)
+{
+    memset(te_stats, 0, sizeof(*te_stats));
+}
+
+void amoled_set_brightness(uint8_t level)
+{
+    _brightness = level;
+}
+
+uint8_t amoled_get_brightness()
+{
+    return _brightness;
+}
+
+void amoled_set_window(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
+{
+    win_xs = xs;
+    win_ys = ys;
+    win_xe = xe;
+    win_ye = ye;
+    win_x = xs;
+    win_y = ys;
+}
+
+// No window commands and no delta check here: both always report zero
+void amoled_get_window_stats(uint32_t *sent, uint32_t *skipped)
+{
+    *sent = 0;
+    *skipped = 0;
+}
+
+void amoled_get_delta_stats(uint32_t *px_sent, uint32_t *px_skipped)
+{
+    *px_sent = 0;
+    *px_skipped = 0;
+}
+
+// Write pixels into the current window like the panel RAM pointer would
+void amoled_push_buffer(uint16_t *data, uint32_t len)
+{
+    uint16_t stride = display_width();
+    while (len--) {
+        if (win_y <= win_ye && win_x < stride && win_y < display_height()) {
+            framebuffer[(uint32_t)win_y * stride + win_x] = *data;
+        }
+        data++;
+        if (++win_x > win_xe) {
+            win_x = win_xs;
+            win_y++;
+        }
+    }
+}
+
+void amoled_push_buffer_queued(uint16_t *data, uint32_t len)
+{
+    amoled_push_buffer(data, len);
+    flush_done_us = esp_timer_get_time();
+    if (flush_done_task) {
+        xTaskNotifyGiveIndexed(flush_done_task, AMOLED_FLUSH_NOTIFY_INDEX);
+    }
+}
+
+void amoled_wait_idle()
+{
+}
+
+void amoled_register_flush_done_task(TaskHandle_t task)
+{
+    flush_done_task = task;
+}
+
+int64_t display_flush_done_us()
+{
+    return flush_done_us;
+}
+
+void display_push_colors(uint16_t x, uint16_t y, uint16_t width, uint16_t hight, uint16_t *data)
+{
+    int64_t start = esp_timer_get_time();
+    uint16_t stride = display_width();
+    for (uint16_t row = 0; row < hight; row++) {
+        memcpy(framebuffer + (uint32_t)(y + row) * stride + x, data + (uint32_t)row * width,
+               width * sizeof(uint16_t));
+    }
+    stats.areas++;
+    stats.pixels += (uint32_t)width * hight;
+    flush_done_us = esp_timer_get_time();
+    stats.flush_time_us += flush_done_us - start;
+    if (flush_done_task) {
+        xTaskNotifyGiveIndexed(flush_done_task, AMOLED_FLUSH_NOTIFY_INDEX);
+    }
+}
+
+const uint16_t *display_headless_framebuffer(void)
+{
+    return framebuffer;
+}
+
+void display_headless_get_stats(display_headless_stats_t *out)
+{
+    *out = stats;
+}
+
+void display_headless_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool display_headless_dump_ppm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return false;
+    }
+    uint16_t w = display_width();
+    uint16_t h = display_height();
+    fprintf(f, "P6\n%d %d\n255\n", w, h);
+    for (uint32_t i = 0; i < (uint32_t)w * h; i++) {
+        uint16_t c = framebuffer[i];
+#if CONFIG_LV_COLOR_16_SWAP
+        c = (uint16_t)((c >> 8) | (c << 8));
+#endif
+        uint8_t rgb[3] = {
+            (uint8_t)(((c >> 11) & 0x1F) << 3),
+            (uint8_t)(((c >> 5) & 0x3F) << 2),
+            (uint8_t)((c & 0x1F) << 3),
+        };
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+    fclose(f);
+    return true;
+}
+
+#endif
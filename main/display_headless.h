@@ -0,0 +1,43 @@
+/**
+ * @file      display_headless.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct display_headless_stats {
+    uint32_t        frames;
+    uint32_t        areas;
+    uint64_t        pixels;
+    uint64_t        flush_time_us;      // time spent in display_push_colors()
+} display_headless_stats_t;
+
+/**
+ * @brief In-memory framebuffer behind the amoled_driver.h API, built instead
+ *        of amoled_driver.c with CONFIG_DISPLAY_HEADLESS. The image is
+ *        display_width() x display_height() RGB565 pixels, row major.
+ *
+ *        No-ops of this backend: display_set_rotation() only records the
+ *        rotation and ignores mirror, amoled_get_window_stats() and
+ *        amoled_get_delta_stats() always report zero, and so do
+ *        display_frame_period_us() and display_get_te_stats();
+ *        display_wait_vblank() returns at once.
+ */
+const uint16_t *display_headless_framebuffer(void);
+
+void display_headless_get_stats(display_headless_stats_t *stats);
+
+void display_headless_reset_stats(void);
+
+// Write the framebuffer as a binary PPM (P6) image
+bool display_headless_dump_ppm(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file      display_rotate.c
+ * @license   MIT
+ *
+ */
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "display_rotate.h"
+
+// 16 RGB565 pixels = 32 bytes, one data cache line on the ESP32-S3
+#define ROTATE_TILE_SIZE        (16)
+
+#if CONFIG_IDF_TARGET_ESP32S3
+// Keep the inner loop out of flash: instruction fetches would otherwise
+// compete with the PSRAM draw buffer for the shared cache.
+#define ROTATE_ATTR             IRAM_ATTR
+#else
+#define ROTATE_ATTR
+#endif
+
+static inline uint16_t min_u16(uint16_t a, uint16_t b)
+{
+    return a < b ? a : b;
+}
+
+void ROTATE_ATTR display_rotate_copy(uint16_t *dst, const uint16_t *src, uint16_t width, uint16_t height,
+                                     display_rotation_t rotation, bool mirror)
+{
+    int32_t w = width;
+    int32_t h = height;
+    uint16_t dst_w = width;
+    uint16_t dst_h = height;
+    int32_t start;      // source index of destination pixel (0, 0)
+    int32_t step_x;     // source step for one destination column
+    int32_t step_y;     // source step for one destination row
+
+    switch (rotation) {
+    case DISPLAY_ROTATE_90:
+        dst_w = height;
+        dst_h = width;
+        start = w * (h - 1);
+        step_x = -w;
+        step_y = 1;
+        break;
+    case DISPLAY_ROTATE_180:
+        start = w * h - 1;
+        step_x = -1;
+        step_y = -w;
+        break;
+    case DISPLAY_ROTATE_270:
+        dst_w = height;
+        dst_h = width;
+        start = w - 1;
+        step_x = w;
+        step_y = -1;
+        break;
+    case DISPLAY_ROTATE_0:
+    default:
+        if (!mirror) {
+            memcpy(dst, src, (size_t)w * h * sizeof(uint16_t));
+            return;
+        }
+        start = 0;
+        step_x = 1;
+        step_y = w;
+        break;
+    }
+
+    if (mirror) {
+        start += (dst_w - 1) * step_x;
+        step_x = -step_x;
+    }
+
+    for (uint16_t ty = 0; ty < dst_h; ty += ROTATE_TILE_SIZE) {
+        uint16_t ty_end = min_u16(dst_h, ty + ROTATE_TILE_SIZE);
+        for (uint16_t tx = 0; tx < dst_w; tx += ROTATE_TILE_SIZE) {
+            uint16_t tx_end = min_u16(dst_w, tx + ROTATE_TILE_SIZE);
+            for (uint16_t y = ty; y < ty_end; y++) {
+                const uint16_t *s = src + start + y * step_y + tx * step_x;
+                uint16_t *d = dst + (uint32_t)y * dst_w + tx;
+                for (uint16_t x = tx; x < tx_end; x++) {
+                    *d++ = *s;
+                    s += step_x;
+                }
+            }
+        }
+    }
+}
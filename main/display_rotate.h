@@ -0,0 +1,33 @@
+/**
+ * @file      display_rotate.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    DISPLAY_ROTATE_0 = 0,
+    DISPLAY_ROTATE_90,      // clockwise
+    DISPLAY_ROTATE_180,
+    DISPLAY_ROTATE_270,
+} display_rotation_t;
+
+/**
+ * @brief Copy a width x height RGB565 area into dst, rotated and optionally
+ *        mirrored horizontally (mirroring is applied after rotation).
+ *        For 90/270 the destination is height pixels wide and width pixels tall.
+ *        The copy walks the area in square tiles so that the column-wise
+ *        reads stay inside a few cache lines of the source buffer.
+ */
+void display_rotate_copy(uint16_t *dst, const uint16_t *src, uint16_t width, uint16_t height,
+                         display_rotation_t rotation, bool mirror);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file      frame_profiler.c
+ * @license   MIT
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "lvgl.h"
+#include "frame_profiler.h"
+
+#define PROFILER_RING_LEN           128         /*!< samples per stage, power of two */
+#define PROFILER_OVERLAY_PERIOD_MS  500
+
+static const char *stage_names[FRAME_STAGE_COUNT] = {
+    "handler", "render", "flush_cb", "rotate", "transfer", "frame",
+};
+
+const char *frame_profiler_stage_name(frame_stage_t stage)
+{
+    return stage < FRAME_STAGE_COUNT ? stage_names[stage] : "?";
+}
+
+#if CONFIG_FRAME_PROFILER
+
+static const char *TAG = "frame_profiler";
+
+typedef struct stage_ring {
+    uint32_t        samples[PROFILER_RING_LEN];
+    uint32_t        count;          // total samples written, index of the next one
+} stage_ring_t;
+
+static stage_ring_t rings[FRAME_STAGE_COUNT];
+static int64_t frame_times[PROFILER_RING_LEN];
+static uint32_t frame_count;
+
+#if CONFIG_FRAME_PROFILER_OVERLAY
+static lv_obj_t *overlay_label;
+#endif
+
+void frame_profiler_record(frame_stage_t stage, int64_t start_us, int64_t end_us)
+{
+    stage_ring_t *ring = &rings[stage];
+    int64_t duration = end_us - start_us;
+    ring->samples[ring->count & (PROFILER_RING_LEN - 1)] = duration > 0 ? (uint32_t)duration : 0;
+    ring->count++;
+}
+
+void frame_profiler_frame_done(int64_t end_us)
+{
+    frame_times[frame_count & (PROFILER_RING_LEN - 1)] = end_us;
+    frame_count++;
+}
+
+bool frame_profiler_get_stats(frame_stage_t stage, frame_stage_stats_t *stats)
+{
+    uint32_t sorted[PROFILER_RING_LEN];
+    const stage_ring_t *ring = &rings[stage];
+    uint32_t n = ring->count < PROFILER_RING_LEN ? ring->count : PROFILER_RING_LEN;
+
+    memset(stats, 0, sizeof(*stats));
+    if (n == 0) {
+        return true;
+    }
+    // copy first so the writer is never held up; insertion sort is fine at this size
+    memcpy(sorted, ring->samples, n * sizeof(uint32_t));
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t v = sorted[i];
+        uint32_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+        sum += v;
+    }
+    stats->samples = n;
+    stats->min_us = sorted[0];
+    stats->max_us = sorted[n - 1];
+    stats->avg_us = (uint32_t)(sum / n);
+    // nearest rank: the smallest sample at or above 99% of them
+    stats->p99_us = sorted[(n * 99 + 99) / 100 - 1];
+    return true;
+}
+
+uint32_t frame_profiler_get_fps(void)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t n = frame_count < PROFILER_RING_LEN ? frame_count : PROFILER_RING_LEN;
+    uint32_t fps = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (now - frame_times[i] < 1000000) {
+            fps++;
+        }
+    }
+    return fps;
+}
+
+static void frame_profiler_dump_cb(lv_timer_t *timer)
+{
+    frame_stage_stats_t stats;
+    ESP_LOGI(TAG, "%lu fps, %lu frames", (unsigned long)frame_profiler_get_fps(),
+             (unsigned long)frame_count);
+    for (int stage = 0; stage < FRAME_STAGE_COUNT; stage++) {
+        frame_profiler_get_stats(stage, &stats);
+        if (stats.samples == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-8s min %5lu avg %5lu p99 %5lu max %5lu us (%lu)", stage_names[stage],
+                 (unsigned long)stats.min_us, (unsigned long)stats.avg_us,
+                 (unsigned long)stats.p99_us, (unsigned long)stats.max_us,
+                 (unsigned long)stats.samples);
+    }
+}
+
+#if CONFIG_FRAME_PROFILER_OVERLAY
+static void frame_profiler_overlay_cb(lv_timer_t *timer)
+{
+    frame_stage_stats_t render;
+    frame_stage_stats_t frame;
+    frame_profiler_get_stats(FRAME_STAGE_RENDER, &render);
+    frame_profiler_get_stats(FRAME_STAGE_FRAME, &frame);
+    lv_label_set_text_fmt(overlay_label, "%lu fps\nrender %lu us\nframe %lu/%lu us",
+                          (unsigned long)frame_profiler_get_fps(), (unsigned long)render.avg_us,
+                          (unsigned long)frame.avg_us, (unsigned long)frame.p99_us);
+}
+#endif
+
+void frame_profiler_init(void)
+{
+    if (CONFIG_FRAME_PROFILER_DUMP_MS > 0) {
+        lv_timer_create(frame_profiler_dump_cb, CONFIG_FRAME_PROFILER_DUMP_MS, NULL);
+    }
+#if CONFIG_FRAME_PROFILER_OVERLAY
+    // the top layer stays above every screen
+    overlay_label = lv_label_create(lv_layer_top());
+    lv_obj_set_style_bg_color(overlay_label, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(overlay_label, LV_OPA_60, 0);
+    lv_obj_set_style_text_color(overlay_label, lv_color_white(), 0);
+    lv_obj_align(overlay_label, LV_ALIGN_TOP_RIGHT, 0, 0);
+    lv_label_set_text(overlay_label, "");
+    lv_timer_create(frame_profiler_overlay_cb, PROFILER_OVERLAY_PERIOD_MS, NULL);
+#endif
+}
+
+#else
+
+bool frame_profiler_get_stats(frame_stage_t stage, frame_stage_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    return false;
+}
+
+uint32_t frame_profiler_get_fps(void)
+{
+    return 0;
+}
+
+#endif
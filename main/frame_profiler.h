@@ -0,0 +1,71 @@
+/**
+ * @file      frame_profiler.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    FRAME_STAGE_HANDLER = 0,    // lv_timer_handler() pass that refreshed the display
+    FRAME_STAGE_RENDER,         // LVGL drawing one area, flush waits excluded
+    FRAME_STAGE_FLUSH_CB,       // time spent inside lvgl_flush_cb()
+    FRAME_STAGE_ROTATE,         // software rotation of one area
+    FRAME_STAGE_TRANSFER,       // area handed to the driver until the SPI ISR saw it done
+    FRAME_STAGE_FRAME,          // start of the refresh until the last area was sent
+    FRAME_STAGE_COUNT,
+} frame_stage_t;
+
+typedef struct frame_stage_stats {
+    uint32_t        samples;        // samples in the window (ring length at most)
+    uint32_t        min_us;
+    uint32_t        avg_us;
+    uint32_t        p99_us;
+    uint32_t        max_us;
+} frame_stage_stats_t;
+
+#if CONFIG_FRAME_PROFILER
+static inline int64_t frame_profiler_now(void)
+{
+    return esp_timer_get_time();
+}
+
+/**
+ * @brief Add one sample to a stage's ring buffer. Each stage must have a single
+ *        writer, all of them run in the LVGL task.
+ */
+void frame_profiler_record(frame_stage_t stage, int64_t start_us, int64_t end_us);
+
+// Mark a completed frame for the frames per second counter
+void frame_profiler_frame_done(int64_t end_us);
+
+/**
+ * @brief Start the periodic serial dump and, if enabled, the on-screen
+ *        overlay. Call from LVGL context after the display is registered.
+ */
+void frame_profiler_init(void);
+#else
+static inline int64_t frame_profiler_now(void) { return 0; }
+static inline void frame_profiler_record(frame_stage_t stage, int64_t start_us, int64_t end_us) {}
+static inline void frame_profiler_frame_done(int64_t end_us) {}
+static inline void frame_profiler_init(void) {}
+#endif
+
+// Min/avg/p99/max over the last samples of a stage; false when profiling is off
+bool frame_profiler_get_stats(frame_stage_t stage, frame_stage_stats_t *stats);
+
+// Frames completed during the last second
+uint32_t frame_profiler_get_fps(void);
+
+const char *frame_profiler_stage_name(frame_stage_t stage);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+#!/usr/bin/env python
+#
+# Pack the QSPI AMOLED init tables of initSequence.c into variable-length
+# byte scripts. Each command becomes:
+#
+#   [cmd] [flags | count] [count parameter bytes]
+#
+# where cmd is the high byte of lcd_cmd_t.addr and the second byte is
+# lcd_cmd_t.len unchanged (count in bits 0-4, 0x20 = 10 ms delay,
+# 0x80 = 120 ms delay). lcd_cmd_t reserves 20 parameter bytes per entry,
+# the packed form stores only the ones that are sent.
+#
+# usage: gen_init_script.py initSequence.c init_script.c
+
+import re
+import sys
+
+TABLES = ('sh8501_cmd', 'rm67162_cmd', 'rm690b0_cmd')
+
+ENTRY_RE = re.compile(r'\{\s*([^,{}]+?)\s*,\s*\{([^}]*)\}\s*,\s*([^,{}]+?)\s*\}')
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+    return re.sub(r'//[^\n]*', '', text)
+
+
+def parse_table(source, name):
+    m = re.search(r'const\s+lcd_cmd_t\s+' + name + r'\s*\[[^\]]*\]\s*=\s*\{(.*?)\n\};', source, re.S)
+    if not m:
+        sys.exit('gen_init_script: table %s not found' % name)
+    entries = []
+    for addr, params, length in ENTRY_RE.findall(m.group(1)):
+        addr = int(addr, 0)
+        length = int(length, 0)
+        if addr & 0xFF or addr > 0xFFFF:
+            sys.exit('gen_init_script: %s: address 0x%04x cannot be packed' % (name, addr))
+        params = [p.strip() for p in params.split(',') if p.strip()]
+        count = length & 0x1F
+        # missing initializers are zero, like the lcd_cmd_t padding
+        params = (params + ['0x00'] * count)[:count]
+        entries.append((addr >> 8, length, params))
+    return entries
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('usage: gen_init_script.py initSequence.c init_script.c')
+    with open(sys.argv[1]) as f:
+        source = strip_comments(f.read())
+
+    out = ['// Generated by gen_init_script.py from initSequence.c, do not edit.',
+           '#include "initSequence.h"',
+           '']
+    for name in TABLES:
+        entries = parse_table(source, name)
+        script = name.replace('_cmd', '_script')
+        out.append('const uint8_t %s[] = {' % script)
+        for cmd, length, params in entries:
+            out.append('    0x%02x, 0x%02x,%s' % (cmd, length, ''.join(' %s,' % p for p in params)))
+        out.append('};')
+        out.append('const uint32_t %s_size = sizeof(%s);' % (script, script))
+        out.append('')
+
+    with open(sys.argv[2], 'w') as f:
+        f.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()
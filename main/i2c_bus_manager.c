@@ -0,0 +1,294 @@
+/**
+ * @file      i2c_bus_manager.c
+ * @license   MIT
+ *
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "i2c_bus_manager.h"
+
+#define I2C_BUS_TASK_STACK_SIZE     (3 * 1024)
+#define I2C_BUS_TASK_PRIORITY       (tskIDLE_PRIORITY + 2)
+#define I2C_BUS_STATS_LOG_PERIOD_US (10 * 1000 * 1000)
+#define I2C_BUS_AGE_US              (20 * 1000) // waiting this long counts as one priority level more
+
+struct i2c_bus_dev {
+    const char              *name;
+    i2c_master_dev_handle_t handle;
+    i2c_bus_prio_t          prio;
+    QueueHandle_t           queue;      // i2c_bus_txn_t *
+    int64_t                 added_us;
+    i2c_bus_dev_stats_t     stats;      // written by the bus task only
+    atomic_uint             dropped;    // counted by the submitting tasks
+};
+
+static const char *TAG = "i2c_bus";
+
+static i2c_master_bus_handle_t bus_handle;
+static TaskHandle_t bus_task_handle;
+static struct i2c_bus_dev devices[I2C_BUS_MAX_DEVICES];
+static volatile int device_count;
+static int rr_next;     // where the next scan for work starts
+
+// Priority of a device's oldest queued transaction, raised by the time it has waited; -1 when idle
+static int bus_effective_prio(struct i2c_bus_dev *dev, int64_t now)
+{
+    i2c_bus_txn_t *oldest;
+    if (xQueuePeek(dev->queue, &oldest, 0) != pdTRUE) {
+        return -1;
+    }
+    return dev->prio + (int)((now - oldest->submit_us) / I2C_BUS_AGE_US);
+}
+
+/*
+ * The device with queued work of the highest priority, after aging: every
+ * I2C_BUS_AGE_US a transaction waits lifts it one level, so telemetry still
+ * gets the bus while control input keeps it busy. Scanning starts after the
+ * device served last, so equal priorities take turns.
+ */
+static struct i2c_bus_dev *bus_pick_device(void)
+{
+    struct i2c_bus_dev *best = NULL;
+    int best_prio = -1;
+    int top_prio = -1;      // before aging
+    int count = device_count;
+    int64_t now = esp_timer_get_time();
+    for (int n = 0; n < count; n++) {
+        struct i2c_bus_dev *dev = &devices[(rr_next + n) % count];
+        int prio = bus_effective_prio(dev, now);
+        if (prio < 0) {
+            continue;
+        }
+        if ((int)dev->prio > top_prio) {
+            top_prio = dev->prio;
+        }
+        if (prio > best_prio) {
+            best = dev;
+            best_prio = prio;
+        }
+    }
+    if (best) {
+        if ((int)best->prio < top_prio) {
+            best->stats.aged++;
+        }
+        rr_next = (best - devices + 1) % count;
+    }
+    return best;
+}
+
+// Run the oldest transaction of a device, plus the reads queued behind it that fit one transfer
+static void bus_serve(struct i2c_bus_dev *dev)
+{
+    i2c_bus_txn_t *batch[I2C_BUS_DEV_QUEUE_LEN];
+    int n = 0;
+    if (xQueueReceive(dev->queue, &batch[n], 0) != pdTRUE) {
+        return;
+    }
+    n++;
+    i2c_bus_txn_t *first = batch[0];
+    uint8_t start = first->reg;
+    uint8_t end = first->reg + first->len;
+    int timeout_ms = first->timeout_ms;
+
+    i2c_bus_txn_t *next;
+    while (!first->write && n < I2C_BUS_DEV_QUEUE_LEN &&
+           xQueuePeek(dev->queue, &next, 0) == pdTRUE && !next->write &&
+           next->reg >= start && next->reg <= end &&
+           (next->reg + next->len > end ? next->reg + next->len : end) - start <= I2C_BUS_XFER_MAX) {
+        xQueueReceive(dev->queue, &next, 0);
+        batch[n++] = next;
+        if (next->reg + next->len > end) {
+            end = next->reg + next->len;
+        }
+        if (next->timeout_ms > timeout_ms) {
+            timeout_ms = next->timeout_ms;
+        }
+    }
+
+    uint8_t buf[1 + I2C_BUS_XFER_MAX];
+    esp_err_t err;
+    int64_t begin = esp_timer_get_time();
+    if (first->write) {
+        buf[0] = first->reg;
+        memcpy(&buf[1], first->data, first->len);
+        err = i2c_master_transmit(dev->handle, buf, first->len + 1, timeout_ms);
+    } else {
+        err = i2c_master_transmit_receive(dev->handle, &start, 1, buf, end - start, timeout_ms);
+    }
+    int64_t now = esp_timer_get_time();
+
+    i2c_bus_dev_stats_t *stats = &dev->stats;
+    stats->transfers++;
+    stats->coalesced += n - 1;
+    stats->busy_us += now - begin;
+    if (err != ESP_OK) {
+        stats->errors++;
+    }
+    for (int i = 0; i < n; i++) {
+        i2c_bus_txn_t *txn = batch[i];
+        if (!txn->write && err == ESP_OK) {
+            memcpy(txn->data, &buf[txn->reg - start], txn->len);
+        }
+        txn->err = err;
+        txn->done_us = now;
+        int64_t latency = now - txn->submit_us;
+        stats->transactions++;
+        stats->total_latency_us += latency;
+        if (latency > stats->max_latency_us) {
+            stats->max_latency_us = latency;
+        }
+        if (txn->done_cb) {
+            txn->done_cb(txn);
+        }
+    }
+}
+
+static void bus_task(void *arg)
+{
+    int64_t log_start = esp_timer_get_time();
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(I2C_BUS_STATS_LOG_PERIOD_US / 1000));
+        struct i2c_bus_dev *dev;
+        while ((dev = bus_pick_device()) != NULL) {
+            bus_serve(dev);
+        }
+        int64_t now = esp_timer_get_time();
+        if (now - log_start >= I2C_BUS_STATS_LOG_PERIOD_US) {
+            i2c_bus_log_stats();
+            log_start = now;
+        }
+    }
+}
+
+esp_err_t i2c_bus_manager_init(i2c_master_bus_handle_t bus)
+{
+    bus_handle = bus;
+    if (xTaskCreate(bus_task, "I2C_BUS", I2C_BUS_TASK_STACK_SIZE, NULL, I2C_BUS_TASK_PRIORITY, &bus_task_handle) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_add_device(uint16_t address, uint32_t scl_speed_hz, i2c_bus_prio_t prio,
+                             const char *name, i2c_bus_dev_handle_t *out)
+{
+    if (device_count >= I2C_BUS_MAX_DEVICES) {
+        ESP_LOGE(TAG, "No room for device %s", name);
+        return ESP_ERR_NO_MEM;
+    }
+    struct i2c_bus_dev *dev = &devices[device_count];
+    i2c_device_config_t dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = address,
+        .scl_speed_hz = scl_speed_hz
+    };
+    esp_err_t err = i2c_master_bus_add_device(bus_handle, &dev_config, &dev->handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    dev->queue = xQueueCreate(I2C_BUS_DEV_QUEUE_LEN, sizeof(i2c_bus_txn_t *));
+    if (!dev->queue) {
+        return ESP_ERR_NO_MEM;
+    }
+    dev->name = name;
+    dev->prio = prio;
+    dev->added_us = esp_timer_get_time();
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    atomic_init(&dev->dropped, 0);
+    // publish last: the bus task scans up to device_count
+    device_count++;
+    *out = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_submit(i2c_bus_dev_handle_t dev, i2c_bus_txn_t *txn)
+{
+    if (!txn->len || txn->len > I2C_BUS_XFER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    txn->submit_us = esp_timer_get_time();
+    if (xQueueSend(dev->queue, &txn, 0) != pdTRUE) {
+        atomic_fetch_add_explicit(&dev->dropped, 1, memory_order_relaxed);
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(bus_task_handle);
+    return ESP_OK;
+}
+
+static void i2c_bus_sync_done(i2c_bus_txn_t *txn)
+{
+    xSemaphoreGive((SemaphoreHandle_t)txn->user_ctx);
+}
+
+// The transaction lives on the caller's stack, so wait for it however long it queues
+static esp_err_t i2c_bus_sync(i2c_bus_dev_handle_t dev, i2c_bus_txn_t *txn)
+{
+    StaticSemaphore_t done_buf;
+    SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&done_buf);
+    txn->done_cb = i2c_bus_sync_done;
+    txn->user_ctx = done;
+    esp_err_t err = i2c_bus_submit(dev, txn);
+    if (err == ESP_OK) {
+        xSemaphoreTake(done, portMAX_DELAY);
+        err = txn->err;
+    }
+    vSemaphoreDelete(done);
+    return err;
+}
+
+esp_err_t i2c_bus_read_reg(i2c_bus_dev_handle_t dev, uint8_t reg, uint8_t *data, uint8_t len, int timeout_ms)
+{
+    i2c_bus_txn_t txn = {
+        .reg = reg,
+        .write = false,
+        .data = data,
+        .len = len,
+        .timeout_ms = timeout_ms,
+    };
+    return i2c_bus_sync(dev, &txn);
+}
+
+esp_err_t i2c_bus_write_reg(i2c_bus_dev_handle_t dev, uint8_t reg, const uint8_t *data, uint8_t len, int timeout_ms)
+{
+    i2c_bus_txn_t txn = {
+        .reg = reg,
+        .write = true,
+        .data = (uint8_t *)data,     // only read for writes
+        .len = len,
+        .timeout_ms = timeout_ms,
+    };
+    return i2c_bus_sync(dev, &txn);
+}
+
+void i2c_bus_get_stats(i2c_bus_dev_handle_t dev, i2c_bus_dev_stats_t *stats)
+{
+    *stats = dev->stats;
+    stats->dropped = atomic_load_explicit(&dev->dropped, memory_order_relaxed);
+    int64_t elapsed = esp_timer_get_time() - dev->added_us;
+    stats->utilisation_pct = elapsed > 0 ? (uint8_t)(stats->busy_us * 100 / elapsed) : 0;
+}
+
+void i2c_bus_log_stats(void)
+{
+    for (int i = 0; i < device_count; i++) {
+        i2c_bus_dev_stats_t s;
+        i2c_bus_get_stats(&devices[i], &s);
+        if (!s.transactions) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%s: %lu txns in %lu transfers (%lu coalesced), %lu errors, %lu dropped, "
+                 "%lu aged, latency avg %lld max %lld us, bus %u%%",
+                 devices[i].name, (unsigned long)s.transactions, (unsigned long)s.transfers,
+                 (unsigned long)s.coalesced, (unsigned long)s.errors, (unsigned long)s.dropped,
+                 (unsigned long)s.aged,
+                 (long long)(s.total_latency_us / s.transactions), (long long)s.max_latency_us,
+                 s.utilisation_pct);
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file      i2c_bus_manager.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/i2c_master.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define I2C_BUS_MAX_DEVICES     4
+#define I2C_BUS_DEV_QUEUE_LEN   4       // pending transactions per device
+#define I2C_BUS_XFER_MAX        16      // bytes in one (coalesced) transfer
+
+typedef enum {
+    I2C_BUS_PRIO_TELEMETRY = 0,         // PMU, sensors: may wait
+    I2C_BUS_PRIO_CONTROL,               // user input: served first
+} i2c_bus_prio_t;
+
+typedef struct i2c_bus_dev *i2c_bus_dev_handle_t;
+typedef struct i2c_bus_txn i2c_bus_txn_t;
+
+// Called from the bus task once a transaction finished
+typedef void (*i2c_bus_done_cb_t)(i2c_bus_txn_t *txn);
+
+/**
+ * @brief One register read or write. Owned by the caller until done_cb runs;
+ *        the bus manager fills in err and the timestamps.
+ */
+struct i2c_bus_txn {
+    uint8_t             reg;
+    bool                write;
+    uint8_t             *data;
+    uint8_t             len;            // at most I2C_BUS_XFER_MAX
+    int                 timeout_ms;     // bus transfer timeout
+    i2c_bus_done_cb_t   done_cb;
+    void                *user_ctx;
+    esp_err_t           err;
+    int64_t             submit_us;
+    int64_t             done_us;
+};
+
+typedef struct i2c_bus_dev_stats {
+    uint32_t        transactions;       // submitted and finished
+    uint32_t        transfers;          // bus transfers, after coalescing
+    uint32_t        coalesced;          // reads served by another read's transfer
+    uint32_t        errors;
+    uint32_t        dropped;            // rejected, queue full
+    uint32_t        aged;               // served ahead of a higher priority device after waiting
+    int64_t         max_latency_us;     // submit until done
+    int64_t         total_latency_us;
+    int64_t         busy_us;            // bus time used by this device
+    uint8_t         utilisation_pct;    // busy_us over the time since the device was added
+} i2c_bus_dev_stats_t;
+
+/**
+ * @brief Start the bus task that owns all transfers on the bus. Call it right
+ *        after the bus is created: every driver, the PMU included, adds its
+ *        device here rather than talking to the bus directly.
+ */
+esp_err_t i2c_bus_manager_init(i2c_master_bus_handle_t bus);
+
+esp_err_t i2c_bus_add_device(uint16_t address, uint32_t scl_speed_hz, i2c_bus_prio_t prio,
+                             const char *name, i2c_bus_dev_handle_t *dev);
+
+/**
+ * @brief Queue a transaction on its device. The highest priority device with
+ *        pending work is served first, devices of equal priority take turns.
+ *        A transaction gains a priority level for every 20 ms it waits, so a
+ *        busy control device cannot hold telemetry off the bus.
+ *        Reads queued back to back on one device that fall within
+ *        I2C_BUS_XFER_MAX bytes of registers are done in a single transfer.
+ * @return ESP_ERR_NO_MEM when the device queue is full
+ */
+esp_err_t i2c_bus_submit(i2c_bus_dev_handle_t dev, i2c_bus_txn_t *txn);
+
+// Blocking helpers; timeout_ms bounds the bus transfer, not the queueing
+esp_err_t i2c_bus_read_reg(i2c_bus_dev_handle_t dev, uint8_t reg, uint8_t *data, uint8_t len, int timeout_ms);
+
+esp_err_t i2c_bus_write_reg(i2c_bus_dev_handle_t dev, uint8_t reg, const uint8_t *data, uint8_t len, int timeout_ms);
+
+void i2c_bus_get_stats(i2c_bus_dev_handle_t dev, i2c_bus_dev_stats_t *stats);
+
+void i2c_bus_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
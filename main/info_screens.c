@@ -0,0 +1,111 @@
+/**
+ * @file      info_screens.c
+ * @license   MIT
+ *
+ */
+
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+#include "lvgl.h"
+#include "joystick_config.h"
+#include "lvgl_config.h"
+#include "screen_manager.h"
+#include "info_screens.h"
+#if CONFIG_LV_MEM_CUSTOM
+#include "lvgl_mem.h"
+#endif
+
+#define JOYSTICK_REFRESH_MS     100
+#define SYSTEM_REFRESH_MS       1000
+
+static void info_timer_delete_cb(lv_event_t *e)
+{
+    lv_timer_del((lv_timer_t *)lv_event_get_user_data(e));
+}
+
+// Screen with a title and one body label refreshed by a timer that lives as long as the screen
+static lv_obj_t *info_screen_create(const char *title, lv_timer_cb_t refresh_cb, uint32_t period_ms)
+{
+    lv_obj_t *screen = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(screen, lv_color_black(), 0);
+
+    lv_obj_t *label = lv_label_create(screen);
+    lv_label_set_text(label, title);
+    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+    lv_obj_align(label, LV_ALIGN_TOP_MID, 0, 10);
+
+    lv_obj_t *body = lv_label_create(screen);
+    lv_label_set_text(body, "");
+    lv_obj_set_style_text_color(body, lv_color_white(), 0);
+    lv_obj_align(body, LV_ALIGN_TOP_LEFT, 10, 50);
+
+    lv_timer_t *timer = lv_timer_create(refresh_cb, period_ms, body);
+    lv_obj_add_event_cb(screen, info_timer_delete_cb, LV_EVENT_DELETE, timer);
+    refresh_cb(timer);
+    return screen;
+}
+
+static uint32_t joystick_shown_seq;    // sample on the joystick screen
+
+static void joystick_refresh_cb(lv_timer_t *timer)
+{
+    joystick_struct_t state;
+    // redraw only for a new sample, none arrive while the joystick read fails
+    if (!joystick_get_new_state(&joystick_shown_seq, &state)) {
+        return;
+    }
+    joystick_sample_stats_t sampling;
+    joystick_get_sample_stats(&sampling);
+    lv_label_set_text_fmt((lv_obj_t *)timer->user_data,
+                          "X       %u  %d\nY       %u  %d\nButton  %u\nRate    %lu Hz\nDetect  %lu ms max",
+                          state.x, state.nx, state.y, state.ny, state.pressed,
+                          (unsigned long)(sampling.period_us ? 1000000 / sampling.period_us : 0),
+                          (unsigned long)(sampling.max_detect_us / 1000));
+}
+
+lv_obj_t *info_screen_joystick_build(void *user_ctx)
+{
+    joystick_shown_seq = UINT32_MAX;
+    return info_screen_create("Joystick", joystick_refresh_cb, JOYSTICK_REFRESH_MS);
+}
+
+static void system_refresh_cb(lv_timer_t *timer)
+{
+    lvgl_render_stats_t render;
+    lvgl_sched_stats_t sched;
+    screen_manager_stats_t screens;
+    uint32_t lv_used, lv_total;
+
+    lvgl_get_render_stats(&render);
+    lvgl_get_sched_stats(&sched);
+    screen_manager_get_stats(&screens);
+#if CONFIG_LV_MEM_CUSTOM
+    // no fixed pool: show the share of the small-object arena that is carved
+    lvgl_mem_stats_t mem;
+    lvgl_mem_get_stats(&mem);
+    lv_used = mem.used_bytes;
+    lv_total = mem.arena_pages_used * 1024;
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    lv_used = mon.total_size - mon.free_size;
+    lv_total = mon.total_size;
+#endif
+    lv_label_set_text_fmt((lv_obj_t *)timer->user_data,
+                          "Frames   %lu\nWakeups  %lu\n"
+                          "LV mem   %lu/%lu KB\nLV peak  %lu KB\nScreens  %lu KB\n"
+                          "SRAM     %u KB free\nPSRAM    %u KB free",
+                          (unsigned long)render.frames, (unsigned long)sched.wakeups,
+                          (unsigned long)(lv_used / 1024),
+                          (unsigned long)(lv_total / 1024),
+                          (unsigned long)(screens.peak_lv_mem / 1024),
+                          (unsigned long)(screens.resident_bytes / 1024),
+                          heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024,
+                          heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024);
+}
+
+lv_obj_t *info_screen_system_build(void *user_ctx)
+{
+    return info_screen_create("System", system_refresh_cb, SYSTEM_REFRESH_MS);
+}
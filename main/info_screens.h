@@ -0,0 +1,21 @@
+/**
+ * @file      info_screens.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Live joystick position and button, for checking the stick's range
+lv_obj_t *info_screen_joystick_build(void *user_ctx);
+
+// Frame rate, LVGL task load and heap usage
+lv_obj_t *info_screen_system_build(void *user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
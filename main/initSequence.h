@@ -20,17 +20,23 @@ typedef struct {
 
 #define SH8501_INIT_SEQUENCE_LENGHT             407
 extern const lcd_cmd_t sh8501_cmd[SH8501_INIT_SEQUENCE_LENGHT];
+extern const uint8_t sh8501_script[];
+extern const uint32_t sh8501_script_size;
 #define SH8501_WIDTH                            194
 #define SH8501_HEIGHT                           368
 
 
 #define RM67162_INIT_SEQUENCE_LENGHT             6
 extern const lcd_cmd_t rm67162_cmd[RM67162_INIT_SEQUENCE_LENGHT];
+extern const uint8_t rm67162_script[];
+extern const uint32_t rm67162_script_size;
 #define RM67162_WIDTH                            240
 #define RM67162_HEIGHT                           536
 
 #define RM690B0_INIT_SEQUENCE_LENGHT             13
 extern const lcd_cmd_t rm690b0_cmd[RM690B0_INIT_SEQUENCE_LENGHT];
+extern const uint8_t rm690b0_script[];
+extern const uint32_t rm690b0_script_size;
 #define RM690B0_WIDTH                            600
 #define RM690B0_HEIGHT                           450
 
@@ -7,7 +7,9 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
@@ -15,14 +17,74 @@
 #include "sdkconfig.h"
 #include "product_pins.h"
 #include "driver/i2c_master.h"
+#include "esp_timer.h"
+#include "nvs.h"
 #include "soc/clk_tree_defs.h"
 #include "i2c_driver.h"
+#include "i2c_bus_manager.h"
 #include "joystick_config.h"
 
 
 #define I2C_MASTER_FREQ_HZ          400000      /*!< I2C master clock frequency */
 
-static joystick_struct_t joystick_state;
+#define JOYSTICK_EVENT_QUEUE_LEN    32          /*!< power of two */
+#define JOYSTICK_I2C_TIMEOUT_MS     20
+
+#ifndef CONFIG_JOYSTICK_DEADZONE
+#define CONFIG_JOYSTICK_DEADZONE    120
+#endif
+#ifndef CONFIG_JOYSTICK_FILTER_SHIFT
+#define CONFIG_JOYSTICK_FILTER_SHIFT 2
+#endif
+
+// direction keys, on normalised axes: pressed from ON, released below OFF
+#define JOYSTICK_KEY_ON             500
+#define JOYSTICK_KEY_OFF            350
+
+#define JOYSTICK_CENTRE_SAMPLES     16          // samples at rest averaged into the centre
+#define JOYSTICK_CENTRE_TOLERANCE   128         // raw distance from mid-scale accepted as rest
+#define JOYSTICK_CAL_MIN_SPAN       320         // raw counts assumed between centre and each extent
+#define JOYSTICK_CAL_TOLERANCE      8           // raw drift from the stored calibration not worth saving
+#define JOYSTICK_CAL_SAVE_US        (10 * 1000 * 1000)  // limit NVS writes while extents grow
+#define JOYSTICK_NVS_NAMESPACE      "joystick"
+#define JOYSTICK_NVS_KEY            "cal"
+
+#ifndef CONFIG_JOYSTICK_ACTIVE_HZ
+#define CONFIG_JOYSTICK_ACTIVE_HZ   200
+#endif
+#ifndef CONFIG_JOYSTICK_IDLE_HZ
+#define CONFIG_JOYSTICK_IDLE_HZ     20
+#endif
+#ifndef CONFIG_JOYSTICK_IDLE_AFTER_MS
+#define CONFIG_JOYSTICK_IDLE_AFTER_MS 500
+#endif
+
+#define JOYSTICK_ACTIVE_PERIOD_US   (1000000 / CONFIG_JOYSTICK_ACTIVE_HZ)
+#define JOYSTICK_IDLE_PERIOD_US     (1000000 / CONFIG_JOYSTICK_IDLE_HZ)
+#define JOYSTICK_ACTIVE_DEADBAND    64          // off-centre distance that counts as activity
+
+static joystick_struct_t joystick_state;        // joystick task's working sample
+static joystick_condition_t conditioning;
+
+/*
+ * Published samples, a seqlock "latch": the writer bumps published_seq to odd
+ * before updating published[0] and to even before updating published[1], so
+ * readers always copy the buffer that is not being written and only retry
+ * if a whole update overtook them. Readers never wait for the writer.
+ */
+static joystick_struct_t published[2];
+static atomic_uint published_seq;
+static joystick_sample_stats_t sample_stats;
+static TaskHandle_t joystick_task_handle;
+
+// Single-producer (joystick task) / single-consumer (LVGL task) ring of edges
+static joystick_event_t event_queue[JOYSTICK_EVENT_QUEUE_LEN];
+static atomic_uint event_head;
+static atomic_uint event_tail;
+static uint32_t event_dropped;
+static uint8_t key_state;
+static joystick_event_cb_t event_cb;
+static void *event_cb_ctx;
 
 enum joystickRegisters {
   JOYSTICK_ID = 0x00,
@@ -40,54 +102,458 @@ enum joystickRegisters {
 
 static const char *TAG = "joystick_config";
 
+static void joystick_push_event(uint8_t key, uint8_t pressed, int64_t time_us)
+{
+    unsigned head = atomic_load_explicit(&event_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&event_tail, memory_order_acquire);
+    if (head - tail >= JOYSTICK_EVENT_QUEUE_LEN) {
+        event_dropped++;
+        return;
+    }
+    joystick_event_t *evt = &event_queue[head & (JOYSTICK_EVENT_QUEUE_LEN - 1)];
+    evt->time_us = time_us;
+    evt->key = key;
+    evt->pressed = pressed;
+    atomic_store_explicit(&event_head, head + 1, memory_order_release);
+}
+
+bool joystick_get_event(joystick_event_t *evt)
+{
+    unsigned tail = atomic_load_explicit(&event_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&event_head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *evt = event_queue[tail & (JOYSTICK_EVENT_QUEUE_LEN - 1)];
+    atomic_store_explicit(&event_tail, tail + 1, memory_order_release);
+    return true;
+}
+
+void joystick_register_event_cb(joystick_event_cb_t cb, void *user_ctx)
+{
+    event_cb_ctx = user_ctx;
+    event_cb = cb;
+}
+
+uint32_t joystick_get_dropped_events(void)
+{
+    return event_dropped;
+}
+
+static uint32_t joystick_isqrt(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Keep at least JOYSTICK_CAL_MIN_SPAN between the centre and each extent
+static void joystick_cal_span(joystick_cal_t *cal)
+{
+    for (int i = 0; i < 2; i++) {
+        if (cal->min[i] + JOYSTICK_CAL_MIN_SPAN > cal->centre[i]) {
+            cal->min[i] = cal->centre[i] > JOYSTICK_CAL_MIN_SPAN ? cal->centre[i] - JOYSTICK_CAL_MIN_SPAN : 0;
+        }
+        if (cal->max[i] < cal->centre[i] + JOYSTICK_CAL_MIN_SPAN) {
+            cal->max[i] = cal->centre[i] + JOYSTICK_CAL_MIN_SPAN < JOYSTICK_AXIS_MAX ?
+                          cal->centre[i] + JOYSTICK_CAL_MIN_SPAN : JOYSTICK_AXIS_MAX;
+        }
+    }
+}
+
+// A centre or extent moved further than the noise of a fresh calibration
+static bool joystick_cal_moved(const joystick_cal_t *cal, const joystick_cal_t *saved)
+{
+    for (int i = 0; i < 2; i++) {
+        if (abs((int)cal->centre[i] - saved->centre[i]) > JOYSTICK_CAL_TOLERANCE ||
+            abs((int)cal->min[i] - saved->min[i]) > JOYSTICK_CAL_TOLERANCE ||
+            abs((int)cal->max[i] - saved->max[i]) > JOYSTICK_CAL_TOLERANCE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void joystick_condition_init(joystick_condition_t *cond, const joystick_cal_t *cal)
+{
+    memset(cond, 0, sizeof(*cond));
+    if (cal) {
+        cond->cal = *cal;
+    } else {
+        for (int i = 0; i < 2; i++) {
+            cond->cal.centre[i] = JOYSTICK_AXIS_MID;
+            cond->cal.min[i] = JOYSTICK_AXIS_MID - JOYSTICK_CAL_MIN_SPAN;
+            cond->cal.max[i] = JOYSTICK_AXIS_MID + JOYSTICK_CAL_MIN_SPAN;
+        }
+        cond->cal_changed = true;
+    }
+    joystick_cal_span(&cond->cal);
+    cond->saved = cond->cal;
+}
+
+// Learn the centre again at every start, from samples taken at rest
+static void joystick_condition_centre(joystick_condition_t *cond, const joystick_struct_t *state)
+{
+    if (cond->centre_samples >= JOYSTICK_CENTRE_SAMPLES || state->pressed ||
+        abs((int)state->x - JOYSTICK_AXIS_MID) > JOYSTICK_CENTRE_TOLERANCE ||
+        abs((int)state->y - JOYSTICK_AXIS_MID) > JOYSTICK_CENTRE_TOLERANCE) {
+        return;
+    }
+    cond->centre_sum[0] += state->x;
+    cond->centre_sum[1] += state->y;
+    if (++cond->centre_samples == JOYSTICK_CENTRE_SAMPLES) {
+        // this boot's centre is used either way, stored only once it drifted
+        for (int i = 0; i < 2; i++) {
+            cond->cal.centre[i] = cond->centre_sum[i] / JOYSTICK_CENTRE_SAMPLES;
+        }
+        joystick_cal_span(&cond->cal);
+        cond->cal_changed |= joystick_cal_moved(&cond->cal, &cond->saved);
+    }
+}
+
+// Filtered raw value to +-JOYSTICK_NORM_MAX, each side scaled by its own extent
+static int32_t joystick_normalise(joystick_condition_t *cond, int axis, int32_t value)
+{
+    joystick_cal_t *cal = &cond->cal;
+    if (value < cal->min[axis] || value > cal->max[axis]) {
+        if (value < cal->min[axis]) {
+            cal->min[axis] = value;
+        } else {
+            cal->max[axis] = value;
+        }
+        cond->cal_changed |= joystick_cal_moved(cal, &cond->saved);
+    }
+    int32_t offset = value - cal->centre[axis];
+    int32_t norm = offset >= 0 ? offset * JOYSTICK_NORM_MAX / (cal->max[axis] - cal->centre[axis])
+                               : offset * JOYSTICK_NORM_MAX / (cal->centre[axis] - cal->min[axis]);
+    if (norm > JOYSTICK_NORM_MAX) {
+        return JOYSTICK_NORM_MAX;
+    }
+    return norm < -JOYSTICK_NORM_MAX ? -JOYSTICK_NORM_MAX : norm;
+}
+
+// One direction key with hysteresis; value is the axis signed towards the key
+static void joystick_key_hysteresis(uint8_t *keys, joystick_key_t key, int32_t value)
+{
+    if (value >= JOYSTICK_KEY_ON) {
+        *keys |= 1 << key;
+    } else if (value < JOYSTICK_KEY_OFF) {
+        *keys &= ~(1 << key);
+    }
+}
+
+void joystick_condition_step(joystick_condition_t *cond, joystick_struct_t *state)
+{
+    joystick_condition_centre(cond, state);
+
+    // exponential moving average: filt += (raw - filt) / 2^CONFIG_JOYSTICK_FILTER_SHIFT
+    int32_t raw[2] = { state->x, state->y };
+    int32_t norm[2];
+    for (int i = 0; i < 2; i++) {
+        if (!cond->primed) {
+            cond->filt[i] = raw[i] << 8;
+        } else {
+            cond->filt[i] += ((raw[i] << 8) - cond->filt[i]) >> CONFIG_JOYSTICK_FILTER_SHIFT;
+        }
+        norm[i] = joystick_normalise(cond, i, (cond->filt[i] + 128) >> 8);
+    }
+    cond->primed = true;
+
+    // raw x grows to the left, raw y upwards
+    int32_t nx = -norm[0];
+    int32_t ny = norm[1];
+
+    // radial deadzone, rescaled so the output still starts at 0 on its edge
+    uint32_t r = joystick_isqrt(nx * nx + ny * ny);
+    if (r <= CONFIG_JOYSTICK_DEADZONE) {
+        nx = 0;
+        ny = 0;
+    } else {
+        int32_t scaled = ((r > JOYSTICK_NORM_MAX ? JOYSTICK_NORM_MAX : r) - CONFIG_JOYSTICK_DEADZONE) *
+                         JOYSTICK_NORM_MAX / (JOYSTICK_NORM_MAX - CONFIG_JOYSTICK_DEADZONE);
+        nx = nx * scaled / (int32_t)r;
+        ny = ny * scaled / (int32_t)r;
+    }
+    state->nx = nx;
+    state->ny = ny;
+
+    joystick_key_hysteresis(&cond->keys, JOYSTICK_KEY_UP, ny);
+    joystick_key_hysteresis(&cond->keys, JOYSTICK_KEY_DOWN, -ny);
+    joystick_key_hysteresis(&cond->keys, JOYSTICK_KEY_RIGHT, nx);
+    joystick_key_hysteresis(&cond->keys, JOYSTICK_KEY_LEFT, -nx);
+    state->keys = cond->keys;
+    if (state->pressed) {
+        state->keys |= 1 << JOYSTICK_KEY_PRESS;
+    }
+}
+
+static void joystick_cal_load(joystick_condition_t *cond)
+{
+    joystick_cal_t cal;
+    size_t len = sizeof(cal);
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(JOYSTICK_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_get_blob(nvs, JOYSTICK_NVS_KEY, &cal, &len);
+        nvs_close(nvs);
+    }
+    bool valid = err == ESP_OK && len == sizeof(cal);
+    for (int i = 0; valid && i < 2; i++) {
+        valid = cal.min[i] < cal.centre[i] && cal.centre[i] < cal.max[i] && cal.max[i] <= JOYSTICK_AXIS_MAX;
+    }
+    if (valid) {
+        joystick_condition_init(cond, &cal);
+        ESP_LOGI(TAG, "Calibration loaded: x %u..%u..%u, y %u..%u..%u",
+                 cal.min[0], cal.centre[0], cal.max[0], cal.min[1], cal.centre[1], cal.max[1]);
+    } else {
+        joystick_condition_init(cond, NULL);
+        ESP_LOGI(TAG, "No stored calibration, learning it");
+    }
+}
+
+static void joystick_cal_save(joystick_condition_t *cond)
+{
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(JOYSTICK_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, JOYSTICK_NVS_KEY, &cond->cal, sizeof(cond->cal));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Saving calibration failed: %s", esp_err_to_name(err));
+        return;
+    }
+    cond->saved = cond->cal;
+    cond->cal_changed = false;
+}
+
+// Queue an event for every key that changed since the previous sample
+static void joystick_update_keys(int64_t time_us)
+{
+    uint8_t keys = joystick_state.keys;
+    uint8_t changed = keys ^ key_state;
+    for (uint8_t key = 0; key < JOYSTICK_KEY_COUNT; key++) {
+        if (changed & (1 << key)) {
+            joystick_push_event(key, (keys >> key) & 1, time_us);
+        }
+    }
+    key_state = keys;
+    if (changed && event_cb) {
+        event_cb(event_cb_ctx);
+    }
+}
+
+// The ADC value is left aligned over the MSB and LSB registers
+static inline uint16_t joystick_axis(uint8_t msb, uint8_t lsb)
+{
+    return ((msb << 8) | lsb) >> (16 - JOYSTICK_AXIS_BITS);
+}
+
+/*
+ * Registers 0x03-0x07 (X MSB/LSB, Y MSB/LSB, button) are contiguous and the
+ * joystick auto-increments its register pointer, so one transaction fetches
+ * a whole sample.
+ */
+static esp_err_t joystick_read_sample(i2c_bus_dev_handle_t dev, joystick_struct_t *state)
+{
+    uint8_t regs[JOYSTICK_BUTTON - JOYSTICK_X_MSB + 1];
+#if CONFIG_JOYSTICK_BURST_READ
+    esp_err_t err = i2c_bus_read_reg(dev, JOYSTICK_X_MSB, regs, sizeof(regs), JOYSTICK_I2C_TIMEOUT_MS);
+    if (err != ESP_OK) {
+        return err;
+    }
+#else
+    for (uint8_t i = 0; i < sizeof(regs); i++) {
+        esp_err_t err = i2c_bus_read_reg(dev, JOYSTICK_X_MSB + i, &regs[i], 1, JOYSTICK_I2C_TIMEOUT_MS);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+#endif
+    state->x = joystick_axis(regs[JOYSTICK_X_MSB - JOYSTICK_X_MSB], regs[JOYSTICK_X_LSB - JOYSTICK_X_MSB]);
+    state->y = joystick_axis(regs[JOYSTICK_Y_MSB - JOYSTICK_X_MSB], regs[JOYSTICK_Y_LSB - JOYSTICK_X_MSB]);
+    // the button register reads 1 while released
+    state->pressed = regs[JOYSTICK_BUTTON - JOYSTICK_X_MSB] == 1 ? 0 : 1;
+    return ESP_OK;
+}
+
+static void joystick_publish(const joystick_struct_t *state)
+{
+    unsigned seq = atomic_load_explicit(&published_seq, memory_order_relaxed);
+    atomic_store_explicit(&published_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    published[0] = *state;
+    atomic_thread_fence(memory_order_seq_cst);
+    atomic_store_explicit(&published_seq, seq + 2, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    published[1] = *state;
+}
+
+/*
+ * Stick off-centre or button held: sample fast. Judged on the raw sample
+ * against the calibrated centre, so the low-pass filter does not delay the
+ * switch to the active rate.
+ */
+static bool joystick_is_active(const joystick_struct_t *state)
+{
+    return state->pressed ||
+           abs((int)state->x - conditioning.cal.centre[0]) > JOYSTICK_ACTIVE_DEADBAND ||
+           abs((int)state->y - conditioning.cal.centre[1]) > JOYSTICK_ACTIVE_DEADBAND;
+}
+
+/*
+ * Sampling period for the next sample: the active rate while the stick is
+ * in use, then doubling once per sample after CONFIG_JOYSTICK_IDLE_AFTER_MS
+ * without activity until the idle rate is reached.
+ */
+static uint32_t joystick_next_period(uint32_t period_us, bool active, int64_t idle_us)
+{
+    if (active) {
+        return JOYSTICK_ACTIVE_PERIOD_US;
+    }
+    if (idle_us < CONFIG_JOYSTICK_IDLE_AFTER_MS * 1000LL || period_us >= JOYSTICK_IDLE_PERIOD_US) {
+        return period_us;
+    }
+    period_us *= 2;
+    return period_us > JOYSTICK_IDLE_PERIOD_US ? JOYSTICK_IDLE_PERIOD_US : period_us;
+}
+
+static void joystick_sample_timer_cb(void *arg)
+{
+    xTaskNotifyGive(joystick_task_handle);
+}
+
+// Sampling is paced by an esp_timer: at CONFIG_FREERTOS_HZ=100 a tick is 10 ms
 static void joystick_task(void *arg)
 {
     ESP_LOGI(TAG, "Starting joystick task");
-    i2c_master_bus_handle_t *bus_handle = (i2c_master_bus_handle_t *) arg;
 
-    uint32_t task_delay_ms = 10;
     esp_err_t err = ESP_OK;
-    i2c_master_dev_handle_t dev_handle;
-    uint8_t write_data[2];
-    uint8_t read_data[2];
-
-    i2c_device_config_t dev_config = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = 0x20,
-        .scl_speed_hz = I2C_MASTER_FREQ_HZ
+    i2c_bus_dev_handle_t dev;
+    esp_timer_handle_t sample_timer;
+    uint32_t period_us = JOYSTICK_IDLE_PERIOD_US;
+    int64_t last_sample = 0;
+    int64_t last_active = 0;
+    int64_t last_save = 0;
+    bool was_active = false;
+
+    joystick_cal_load(&conditioning);
+
+    // user input: ahead of PMU and sensor traffic on the shared bus
+    ESP_ERROR_CHECK(i2c_bus_add_device(0x20, I2C_MASTER_FREQ_HZ, I2C_BUS_PRIO_CONTROL, "joystick", &dev));
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = joystick_sample_timer_cb,
+        .name = "joystick_sample",
+        .skip_unhandled_events = true,
     };
-    ESP_ERROR_CHECK(i2c_master_bus_add_device(*bus_handle, &dev_config, &dev_handle));
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &sample_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(sample_timer, period_us));
+    sample_stats.period_us = period_us;
     
     while (1) 
     {
-        write_data[0] = JOYSTICK_X_MSB;
-        i2c_master_transmit_receive(dev_handle, write_data, 1, read_data, 1, 1000);
-        joystick_state.x = read_data[0];
-        write_data[0] = JOYSTICK_Y_MSB;
-        i2c_master_transmit_receive(dev_handle, write_data, 1, read_data, 1, 1000);
-        joystick_state.y = read_data[0];
-        write_data[0] = JOYSTICK_BUTTON;
-        i2c_master_transmit_receive(dev_handle, write_data, 1, read_data, 1, 1000);
-        if (read_data[0] == 1)
-        {
-            joystick_state.pressed = 0;
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t sample_time = esp_timer_get_time();
+        int64_t interval = last_sample ? sample_time - last_sample : 0;
+        last_sample = sample_time;
+
+        esp_err_t prev_err = err;
+        err = joystick_read_sample(dev, &joystick_state);
+        if (err != ESP_OK) {
+            if (prev_err == ESP_OK) {
+                // keep the last sample rather than reporting a glitch
+                ESP_LOGW(TAG, "Joystick read failed: %s", esp_err_to_name(err));
+            }
+            continue;
+        }
+        joystick_condition_step(&conditioning, &joystick_state);
+        joystick_state.seq++;
+        joystick_state.time_us = sample_time;
+        joystick_publish(&joystick_state);
+        joystick_update_keys(sample_time);
+
+        bool active = joystick_is_active(&joystick_state);
+        sample_stats.samples++;
+        if (interval > sample_stats.max_interval_us) {
+            sample_stats.max_interval_us = interval;
+        }
+        if (active) {
+            sample_stats.active_samples++;
+            last_active = sample_time;
+            if (!was_active) {
+                // the stick moved at most one interval before this sample saw it
+                sample_stats.detections++;
+                sample_stats.total_detect_us += interval;
+                if (interval > sample_stats.max_detect_us) {
+                    sample_stats.max_detect_us = interval;
+                }
+            }
+        }
+        was_active = active;
+
+        uint32_t next = joystick_next_period(period_us, active, sample_time - last_active);
+        if (next != period_us) {
+            period_us = next;
+            esp_timer_restart(sample_timer, period_us);
+            sample_stats.rate_changes++;
+            sample_stats.period_us = period_us;
         }
-        else
-        {
-            joystick_state.pressed = 1;
+
+        // persist a changed calibration once the stick is back at rest
+        if (conditioning.cal_changed && !active &&
+            conditioning.centre_samples >= JOYSTICK_CENTRE_SAMPLES &&
+            sample_time - last_save >= JOYSTICK_CAL_SAVE_US) {
+            joystick_cal_save(&conditioning);
+            last_save = sample_time;
         }
-        
-        vTaskDelay(task_delay_ms);
     }
 }
 
 joystick_struct_t joystick_get_state(void)
 {
-    return joystick_state;
+    joystick_struct_t state;
+    unsigned seq;
+    do {
+        seq = atomic_load_explicit(&published_seq, memory_order_acquire);
+        state = published[seq & 1];
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&published_seq, memory_order_relaxed) != seq);
+    return state;
+}
+
+bool joystick_get_new_state(uint32_t *last_seq, joystick_struct_t *state)
+{
+    *state = joystick_get_state();
+    if (state->seq == *last_seq) {
+        return false;
+    }
+    *last_seq = state->seq;
+    return true;
 }
 
 
-void joystick_go(i2c_master_bus_handle_t *bus)
+void joystick_get_sample_stats(joystick_sample_stats_t *stats)
+{
+    *stats = sample_stats;
+}
+
+void joystick_go(void)
 {
-    xTaskCreate(joystick_task, "JOYSTICK", 4*1024, bus, tskIDLE_PRIORITY + 1, NULL);
+    xTaskCreate(joystick_task, "JOYSTICK", 4*1024, NULL, tskIDLE_PRIORITY + 1, &joystick_task_handle);
 }
\ No newline at end of file
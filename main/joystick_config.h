@@ -6,6 +6,7 @@
  *
  */
 #pragma once
+#include <stdbool.h>
 #include "esp_err.h"
 #include "driver/i2c_master.h"
 
@@ -13,16 +14,108 @@
 extern "C" {
 #endif
 
+#define JOYSTICK_AXIS_BITS  10
+#define JOYSTICK_AXIS_MAX   ((1 << JOYSTICK_AXIS_BITS) - 1)
+#define JOYSTICK_AXIS_MID   (1 << (JOYSTICK_AXIS_BITS - 1))
+#define JOYSTICK_NORM_MAX   1000    // full deflection of a normalised axis
+
 typedef struct joystick_struct {
     uint8_t         pressed;
-    uint8_t         x;
-    uint8_t         y;
+    uint16_t        x;              // 0..JOYSTICK_AXIS_MAX, MSB and LSB registers combined
+    uint16_t        y;
+    int16_t         nx;             // conditioned, +-JOYSTICK_NORM_MAX, right positive, 0 in the deadzone
+    int16_t         ny;             // conditioned, up positive
+    uint8_t         keys;           // joystick_key_t bits after hysteresis
+    uint32_t        seq;            // sample number, 0 until the first sample
+    int64_t         time_us;        // esp_timer time of the sample
 } joystick_struct_t;
 
-void joystick_go(i2c_master_bus_handle_t *bus);
+typedef enum {
+    JOYSTICK_KEY_UP = 0,
+    JOYSTICK_KEY_DOWN,
+    JOYSTICK_KEY_LEFT,
+    JOYSTICK_KEY_RIGHT,
+    JOYSTICK_KEY_PRESS,
+    JOYSTICK_KEY_COUNT,
+} joystick_key_t;
+
+// Raw axis values at rest and the extremes seen, persisted in NVS
+typedef struct joystick_cal {
+    uint16_t        centre[2];      // x, y
+    uint16_t        min[2];
+    uint16_t        max[2];
+} joystick_cal_t;
+
+/**
+ * @brief Signal conditioning, run once per sample. Pure state machine: feed
+ *        it raw samples so it can be driven by recorded traces as well as the
+ *        I2C reads. Each raw axis is low-pass filtered (fixed point), the
+ *        centre is learned from the first samples at rest and the extents
+ *        grow with the deflections seen. The normalised axes get a radial
+ *        deadzone, and the direction keys switch with hysteresis.
+ */
+typedef struct joystick_condition {
+    joystick_cal_t  cal;
+    int32_t         filt[2];        // filtered raw axes, Q8
+    bool            primed;         // filter seeded by a first sample
+    uint8_t         keys;           // direction keys currently on
+    uint16_t        centre_samples; // samples averaged into the centre so far
+    uint32_t        centre_sum[2];
+    joystick_cal_t  saved;          // as loaded from or last saved to NVS
+    bool            cal_changed;    // cal moved from saved by more than noise, worth an NVS write
+} joystick_condition_t;
+
+// Start from a stored calibration, or NULL for defaults
+void joystick_condition_init(joystick_condition_t *cond, const joystick_cal_t *cal);
+
+// Condition state->x/y/pressed into state->nx/ny/keys
+void joystick_condition_step(joystick_condition_t *cond, joystick_struct_t *state);
+
+typedef struct joystick_event {
+    int64_t         time_us;        // esp_timer time of the sample that saw the edge
+    uint8_t         key;            // joystick_key_t
+    uint8_t         pressed;
+} joystick_event_t;
+
+typedef void (*joystick_event_cb_t)(void *user_ctx);
+
+typedef struct joystick_sample_stats {
+    uint32_t        samples;
+    uint32_t        active_samples;     // stick off-centre or button held
+    uint32_t        rate_changes;       // sampling period switches
+    uint32_t        period_us;          // current sampling period
+    int64_t         max_interval_us;    // longest gap between two samples
+    uint32_t        detections;         // idle to active transitions
+    int64_t         max_detect_us;      // worst-case delay before a movement was sampled
+    int64_t         total_detect_us;
+} joystick_sample_stats_t;
 
+// Samples the joystick through the I2C bus manager, see i2c_bus_manager_init()
+void joystick_go(void);
+
+// Called from the joystick task after new events were queued
+void joystick_register_event_cb(joystick_event_cb_t cb, void *user_ctx);
+
+// Latest sample, consistent across fields; any task, never blocks on the joystick task
 joystick_struct_t joystick_get_state(void);
 
+/**
+ * @brief Latest sample if it is newer than *last_seq, which is then updated.
+ * @return false when nothing was sampled since the caller's last sample
+ */
+bool joystick_get_new_state(uint32_t *last_seq, joystick_struct_t *state);
+
+/**
+ * @brief Pop the oldest direction/button edge seen by the joystick task.
+ *        Single consumer: only the LVGL task may call this.
+ */
+bool joystick_get_event(joystick_event_t *evt);
+
+// Events lost because the consumer fell behind
+uint32_t joystick_get_dropped_events(void);
+
+void joystick_get_sample_stats(joystick_sample_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+/**
+ * @file      joystick_keypad.c
+ * @license   MIT
+ *
+ */
+
+#include "esp_timer.h"
+#include "lvgl.h"
+#include "joystick_config.h"
+#include "screen_manager.h"
+#include "joystick_keypad.h"
+
+static int8_t joystick_active_key = -1;     // key reported to LVGL as pressed
+static uint8_t joystick_held_keys;          // keys held according to the event stream
+static lv_obj_t *joystick_pressed_obj;      // button LVGL was last told is pressed
+
+static lvgl_input_stats_t input_stats;
+
+/*
+ * Press/release the button the active screen maps to the joystick key. A
+ * held key whose button changed with the screen is released first, LVGL
+ * would otherwise move the press to the new button; it is pressed again on
+ * the next read.
+ */
+static void joystick_keypad_report(int8_t key, lv_indev_data_t *data)
+{
+    lv_obj_t *target = key >= 0 ? screen_manager_key_target(key) : NULL;
+    if (joystick_pressed_obj && target != joystick_pressed_obj) {
+        target = NULL;
+    }
+    joystick_pressed_obj = target;
+    if (target) {
+        lv_group_focus_obj(target);
+        data->state = LV_INDEV_STATE_PRESSED;
+    } else {
+        data->state = LV_INDEV_STATE_RELEASED;
+    }
+    data->key = LV_KEY_ENTER;
+}
+
+// The held key to report: the active one while the screen still maps it
+static int8_t joystick_pick_key(void)
+{
+    if (joystick_active_key >= 0 && screen_manager_key_target(joystick_active_key)) {
+        return joystick_active_key;
+    }
+    for (int8_t key = 0; key < JOYSTICK_KEY_COUNT; key++) {
+        if ((joystick_held_keys & (1 << key)) && screen_manager_key_target(key)) {
+            return key;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Drains the joystick edge queue one event per call (continue_reading) so
+ * short presses between LVGL reads are not lost. LVGL keypads hold a single
+ * key, so a new direction first releases the active one, and releasing it
+ * re-presses any direction that is still held. Left/right presses that the
+ * active screen does not map switch screens.
+ */
+void joystick_keypad_read(lv_indev_drv_t *indev, lv_indev_data_t *data)
+{
+    static joystick_event_t pending;
+    static bool have_pending = false;
+
+    if (!have_pending && joystick_get_event(&pending)) {
+        have_pending = true;
+        int64_t latency = esp_timer_get_time() - pending.time_us;
+        input_stats.events++;
+        input_stats.total_latency_us += latency;
+        if (latency > input_stats.max_latency_us) {
+            input_stats.max_latency_us = latency;
+        }
+    }
+
+    if (have_pending) {
+        uint8_t key = pending.key;
+        if (pending.pressed && !screen_manager_key_target(key)) {
+            // not held: it must not press a button on the screen it leads to
+            if (key == JOYSTICK_KEY_LEFT) {
+                screen_manager_prev();
+            } else if (key == JOYSTICK_KEY_RIGHT) {
+                screen_manager_next();
+            }
+            have_pending = false;
+        } else if (pending.pressed) {
+            if (joystick_active_key >= 0 && joystick_active_key != key) {
+                // release the current key first, handle the press on the next call
+                joystick_active_key = -1;
+                joystick_keypad_report(-1, data);
+                data->continue_reading = true;
+                return;
+            }
+            joystick_held_keys |= 1 << key;
+            joystick_active_key = key;
+            have_pending = false;
+        } else {
+            joystick_held_keys &= ~(1 << key);
+            if (joystick_active_key == key) {
+                joystick_active_key = -1;
+            }
+            have_pending = false;
+        }
+        joystick_keypad_report(joystick_active_key, data);
+        data->continue_reading = true;
+        return;
+    }
+
+    int8_t key = joystick_pick_key();
+    if (joystick_active_key >= 0 && key != joystick_active_key) {
+        // the screen changed under a held key: release it before anything else
+        joystick_active_key = -1;
+        joystick_keypad_report(-1, data);
+        data->continue_reading = true;
+        return;
+    }
+    joystick_active_key = key;
+    joystick_keypad_report(joystick_active_key, data);
+    // nothing held: stop polling until the joystick task wakes us again
+    if (joystick_active_key < 0) {
+        lv_timer_pause(indev->read_timer);
+    }
+}
+
+void joystick_keypad_get_stats(lvgl_input_stats_t *stats)
+{
+    *stats = input_stats;
+}
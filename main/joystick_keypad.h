@@ -0,0 +1,27 @@
+/**
+ * @file      joystick_keypad.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include "lvgl.h"
+#include "lvgl_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief LVGL keypad read_cb for the joystick: presses the button the active
+ *        screen maps to each joystick key (screen_manager_key_target()), fed
+ *        by joystick_get_event(). Pauses indev->read_timer once nothing is
+ *        held; resume it when the joystick task queues events.
+ */
+void joystick_keypad_read(lv_indev_drv_t *indev, lv_indev_data_t *data);
+
+// events and latency; dropped is left to the caller
+void joystick_keypad_get_stats(lvgl_input_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
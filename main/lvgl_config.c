@@ -11,41 +11,66 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "lvgl.h"
 #include "amoled_driver.h"
 #include "product_pins.h"
 #include "esp_err.h"
 #include "esp_log.h"
 #include "product_pins.h"
-#include "driver/gpio.h"
 #include "lvgl_config.h"
 #include "joystick_config.h"
+#include "joystick_keypad.h"
 #include "relay_config.h"
 #include "sleep_config.h"
+#include "area_planner.h"
+#include "frame_profiler.h"
+#include "ui_queue.h"
+#include "screen_manager.h"
+#include "info_screens.h"
+#include "render_cache.h"
+#if CONFIG_LV_MEM_CUSTOM
+#include "lvgl_mem.h"
+#endif
+
+// LVGL time comes from esp_timer_get_time(), nothing calls lv_tick_inc()
+#if !LV_TICK_CUSTOM
+#error "Set CONFIG_LV_TICK_CUSTOM with the esp_timer_get_time() expression, see sdkconfig"
+#endif
 
-#define LVGL_TICK_PERIOD_MS 1
 #define LVGL_TASK_MAX_DELAY_MS 500
-#define LVGL_TASK_MIN_DELAY_MS 1
 #define LVGL_TASK_STACK_SIZE (4 * 1024)
 #define LVGL_TASK_PRIORITY 2
 
-#define NUM_SCREENS 4
+
+#ifndef DISPLAY_STRIPE_LINES
+#define DISPLAY_STRIPE_LINES 40
+#endif
+
+#define RENDER_STATS_LOG_FRAMES 100
+
+// control screen state that selects control_vac_style
+#define CONTROL_VAC_STATE LV_STATE_USER_1
+#define SCHED_STATS_LOG_PERIOD_US (10 * 1000 * 1000)
+
+// Task notification bits that wake the LVGL task. Finished transfers come
+// on their own index, AMOLED_FLUSH_NOTIFY_INDEX.
+#define LVGL_WAKE_TIMER     (1 << 0)    // next LVGL timer deadline reached
+#define LVGL_WAKE_INPUT     (1 << 1)    // joystick events queued
+#define LVGL_WAKE_UI        (1 << 3)    // UI command queued, or objects changed under lvgl_lock()
 
 static const char *TAG = "lvgl_config";
 
-static lv_indev_t * indev_button_up;
-static lv_indev_t * indev_button_down;
-static lv_indev_t * indev_button_left;
-static lv_indev_t * indev_button_middle;
-static lv_indev_t * indev_button_right;
+static lv_indev_t * indev_joystick;
 
-static lv_indev_drv_t indev_button_up_drv;
-static lv_indev_drv_t indev_button_down_drv;
-static lv_indev_drv_t indev_button_left_drv;
-static lv_indev_drv_t indev_button_middle_drv;
-static lv_indev_drv_t indev_button_right_drv;
+static lv_indev_drv_t indev_joystick_drv;
 
-static lv_obj_t* background_obj;
+static lv_group_t * joystick_group;
+
+static TaskHandle_t lvgl_task_handle;
+static esp_timer_handle_t lvgl_deadline_timer;
+static lvgl_sched_stats_t sched_stats;
+static lvgl_lock_stats_t lock_stats;
 
 
 static SemaphoreHandle_t lvgl_mux = NULL;
@@ -55,269 +80,388 @@ static lv_disp_draw_buf_t disp_buf; // contains internal graphic buffer(s) calle
 static lv_disp_drv_t disp_drv;      // contains callback functions
 
 static int vac_on = 0;
+static bool vac_redraw_pending = false;     // log the refresh after a vacuum toggle
+
+static lvgl_render_stats_t render_stats;
+
+static bool frame_start = true;
+static bool frame_last = false;
+
+// frame profiler timestamps, see frame_profiler.h for the stages
+static int64_t prof_pass_start;     // current lv_timer_handler() pass
+static int64_t prof_render_start;   // LVGL got its draw buffer back
+static int64_t prof_wait_us;        // flush waits since prof_render_start
+static int64_t prof_frame_start;
+static int64_t prof_area_start;
+static bool prof_pass_flushed;
 
 static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
+    int64_t entry = frame_profiler_now();
     uint32_t w = ( area->x2 - area->x1 + 1 );
     uint32_t h = ( area->y2 - area->y1 + 1 );
+    // lvgl_task() waited for the vblank before this refresh
+    if (frame_start) {
+        prof_frame_start = prof_pass_start;
+        prof_render_start = prof_pass_start;
+        display_frame_begin();
+        frame_start = false;
+    }
+    frame_profiler_record(FRAME_STAGE_RENDER, prof_render_start + prof_wait_us, entry);
+    prof_pass_flushed = true;
+    frame_last = lv_disp_flush_is_last(drv);
+    if (frame_last) {
+        frame_start = true;
+    }
+    prof_area_start = entry;
+    // lv_disp_flush_ready() is signalled by the driver once the transfer is done
     display_push_colors(area->x1, area->y1, w, h, (uint16_t *)color_map);
-    lv_disp_flush_ready( drv );
+    prof_render_start = frame_profiler_now();
+    prof_wait_us = 0;
+    frame_profiler_record(FRAME_STAGE_FLUSH_CB, entry, prof_render_start);
 }
 
-static void increase_lvgl_tick(void *arg)
+// Safe from both task and ISR context
+static void lvgl_notify(uint32_t bits)
 {
-    /* Tell LVGL how many milliseconds has elapsed */
-    lv_tick_inc(LVGL_TICK_PERIOD_MS);
+    if (!lvgl_task_handle) {
+        return;
+    }
+    if (xPortInIsrContext()) {
+        BaseType_t need_yield = pdFALSE;
+        xTaskNotifyFromISR(lvgl_task_handle, bits, eSetBits, &need_yield);
+        if (need_yield) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        xTaskNotify(lvgl_task_handle, bits, eSetBits);
+    }
 }
 
-bool lvgl_lock(int timeout_ms)
+// Take the driver's flush-done notification and hand the draw buffer back to
+// LVGL. The SPI ISR only stamps the time and gives the notification, so the
+// profiler, the frame end and lv_disp_flush_ready() all run here in the LVGL
+// task.
+static bool lvgl_flush_collect(TickType_t timeout)
 {
-    // Convert timeout in milliseconds to FreeRTOS ticks
-    // If `timeout_ms` is set to -1, the program will block until the condition is met
-    const TickType_t timeout_ticks = (timeout_ms == -1) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    return xSemaphoreTakeRecursive(lvgl_mux, timeout_ticks) == pdTRUE;
+    if (!ulTaskNotifyTakeIndexed(AMOLED_FLUSH_NOTIFY_INDEX, pdFALSE, timeout)) {
+        return false;
+    }
+    // when the transfer really ended, not when this task got to run
+    int64_t done = display_flush_done_us();
+    frame_profiler_record(FRAME_STAGE_TRANSFER, prof_area_start, done);
+    if (frame_last) {
+        frame_profiler_record(FRAME_STAGE_FRAME, prof_frame_start, done);
+        frame_profiler_frame_done(done);
+        display_frame_end();
+    }
+    lv_disp_flush_ready(&disp_drv);
+    return true;
 }
 
-void lvgl_unlock(void)
+// LVGL polls this while a draw buffer is still being sent; block until the
+// transfer completes instead of spinning on the flushing flag. The
+// notification index is separate from the wake bits, so waiting here never
+// consumes a timer, input or UI wakeup.
+static void lvgl_wait_cb(lv_disp_drv_t *drv)
 {
-    xSemaphoreGiveRecursive(lvgl_mux);
+    int64_t start = frame_profiler_now();
+    lvgl_flush_collect(1);
+    prof_wait_us += frame_profiler_now() - start;
 }
 
-static void lvgl_task(void *arg)
+// Called by LVGL after every refresh with the render+flush time and pixel count
+static void lvgl_monitor_cb(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px)
 {
-    ESP_LOGI(TAG, "Starting LVGL task");
-    uint32_t task_delay_ms = LVGL_TASK_MAX_DELAY_MS;
-    while (1) {
-        // Lock the mutex due to the LVGL APIs are not thread-safe
-        if (lvgl_lock(-1)) {
-            task_delay_ms = lv_timer_handler();
-            // Release the mutex
-            lvgl_unlock();
-        }
-        if (task_delay_ms > LVGL_TASK_MAX_DELAY_MS) {
-            task_delay_ms = LVGL_TASK_MAX_DELAY_MS;
-        } else if (task_delay_ms < LVGL_TASK_MIN_DELAY_MS) {
-            task_delay_ms = LVGL_TASK_MIN_DELAY_MS;
-        }
-        vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
+    render_stats.frames++;
+    render_stats.time_ms += time_ms;
+    render_stats.pixels += px;
+    if (vac_redraw_pending) {
+        vac_redraw_pending = false;
+        render_cache_stats_t cache;
+        render_cache_get_stats(&cache);
+        ESP_LOGI(TAG, "vacuum toggle redraw %lu ms, %lu px, %lu cached widgets",
+                 (unsigned long)time_ms, (unsigned long)px, (unsigned long)cache.entries);
+    }
+    if (render_stats.draw_buf_in_psram) {
+        // rendered once into PSRAM, read back once by the SPI DMA
+        render_stats.psram_bytes += (uint64_t)px * sizeof(lv_color_t) * 2;
+    }
+    if (render_stats.frames % RENDER_STATS_LOG_FRAMES == 0) {
+        ESP_LOGI(TAG, "frames %lu, avg %lu ms, %lu px/frame, PSRAM %llu KB",
+                 (unsigned long)render_stats.frames,
+                 (unsigned long)(render_stats.time_ms / render_stats.frames),
+                 (unsigned long)(render_stats.pixels / render_stats.frames),
+                 (unsigned long long)(render_stats.psram_bytes / 1024));
     }
 }
 
-static void button_task(void *arg)
+void lvgl_get_render_stats(lvgl_render_stats_t *stats)
 {
-    ESP_LOGI(TAG, "Starting button task");
-    uint32_t task_delay_ms = 10;
-    int but1;
-    int but2;
-    uint32_t x = 0;
-    while (1) {
-        but1 = gpio_get_level(GPIO_NUM_21);
-        but2 = gpio_get_level(GPIO_NUM_0);
-        
-        if (!but1)
-        {
-            //button_state.pressed = LV_INDEV_STATE_PRESSED;
-            //button_state.key = LV_KEY_ENTER;
-        }
-        else if (!but2)
-        {
-            //button_state.pressed = LV_INDEV_STATE_PRESSED;
-            //button_state.key = LV_KEY_NEXT;
-        }
-        else
-        {
-            //button_state.pressed = LV_INDEV_STATE_RELEASED;
-        }
-        gpio_set_level(GPIO_NUM_38, x%2);
-        x++;
-        vTaskDelay(task_delay_ms);
-    }
+    *stats = render_stats;
 }
 
-void button_config(void)
+static void lvgl_deadline_cb(void *arg)
 {
-    // configure the "button 2" GPIO pin on the T Display S3 (GPIO 21) to be a input
-    // pin with a pulldown resistor.
-    gpio_config_t io_conf;
-    io_conf.intr_type = GPIO_INTR_DISABLE;
-    io_conf.mode = GPIO_MODE_INPUT;
-    io_conf.pin_bit_mask = (1 << BOARD_BUTTON2_PIN);
-    io_conf.pull_down_en = GPIO_PULLDOWN_ENABLE;
-    io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
-    gpio_config(&io_conf);
+    lvgl_notify(LVGL_WAKE_TIMER);
 }
 
-void joystick_button_read(lv_indev_drv_t *indev, lv_indev_data_t *data)
+bool lvgl_lock(int timeout_ms)
 {
-    joystick_struct_t joystick_state = joystick_get_state();
-
-    if (joystick_state.pressed)
-    {
-        data->state = LV_INDEV_STATE_PRESSED;
-        ESP_LOGI(TAG, "VAC PRESSED");
-    }
-    else
-    {
-        data->state = LV_INDEV_STATE_RELEASED;
+    // Convert timeout in milliseconds to FreeRTOS ticks
+    // If `timeout_ms` is set to -1, the program will block until the condition is met
+    const TickType_t timeout_ticks = (timeout_ms == -1) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    int64_t start = esp_timer_get_time();
+    if (xSemaphoreTakeRecursive(lvgl_mux, 0) != pdTRUE) {
+        // contended: measure how long the caller is held up, usually by a render
+        if (xSemaphoreTakeRecursive(lvgl_mux, timeout_ticks) != pdTRUE) {
+            lock_stats.timeouts++;
+            return false;
+        }
+        int64_t waited = esp_timer_get_time() - start;
+        lock_stats.contended++;
+        lock_stats.total_wait_us += waited;
+        if (waited > lock_stats.max_wait_us) {
+            lock_stats.max_wait_us = waited;
+        }
     }
+    lock_stats.acquired++;
+    return true;
 }
 
-void button_up_read(lv_indev_drv_t *indev, lv_indev_data_t *data)
+void lvgl_unlock(void)
 {
-    joystick_struct_t joystick_state = joystick_get_state();
-
-    if (joystick_state.y > 200)
-    {
-        data->state = LV_INDEV_STATE_PRESSED;
-        ESP_LOGI(TAG, "UP");
-    }
-    else
-    {
-        data->state = LV_INDEV_STATE_RELEASED;
+    xSemaphoreGiveRecursive(lvgl_mux);
+    // let the LVGL task render whatever another task just changed
+    if (xTaskGetCurrentTaskHandle() != lvgl_task_handle) {
+        lvgl_notify(LVGL_WAKE_UI);
     }
 }
 
-void button_down_read(lv_indev_drv_t *indev, lv_indev_data_t *data)
+void lvgl_get_sched_stats(lvgl_sched_stats_t *stats)
 {
-    joystick_struct_t joystick_state = joystick_get_state();
-
-    if (joystick_state.y < 50)
-    {
-        data->state = LV_INDEV_STATE_PRESSED;
-        ESP_LOGI(TAG, "DOWN");
-    }
-    else
-    {
-        data->state = LV_INDEV_STATE_RELEASED;
-    }
+    *stats = sched_stats;
 }
 
-void button_left_read(lv_indev_drv_t *indev, lv_indev_data_t *data)
+void lvgl_get_lock_stats(lvgl_lock_stats_t *stats)
 {
-    joystick_struct_t joystick_state = joystick_get_state();
-
-    if (joystick_state.x > 200)
-    {
-        data->state = LV_INDEV_STATE_PRESSED;
-        ESP_LOGI(TAG, "LEFT");
-    }
-    else
-    {
-        data->state = LV_INDEV_STATE_RELEASED;
-    }
+    *stats = lock_stats;
 }
 
-void button_right_read(lv_indev_drv_t *indev, lv_indev_data_t *data)
+static void lvgl_log_sched_stats(int64_t now)
 {
-    joystick_struct_t joystick_state = joystick_get_state();
+    static int64_t log_start;
+    static lvgl_sched_stats_t last;
 
-    if (joystick_state.x < 50)
-    {
-        data->state = LV_INDEV_STATE_PRESSED;
-        ESP_LOGI(TAG, "RIGHT");
-    }
-    else
-    {
-        data->state = LV_INDEV_STATE_RELEASED;
+    int64_t period = now - log_start;
+    if (period < SCHED_STATS_LOG_PERIOD_US) {
+        return;
     }
+    uint32_t wakeups = sched_stats.wakeups - last.wakeups;
+    uint64_t busy_us = sched_stats.busy_us - last.busy_us;
+    ESP_LOGI(TAG, "LVGL wakeups %lu/s (timer %lu, input %lu, flush %lu, ui %lu), busy %lu.%lu%%",
+             (unsigned long)(wakeups * 1000000LL / period),
+             (unsigned long)(sched_stats.timer_wakeups - last.timer_wakeups),
+             (unsigned long)(sched_stats.input_wakeups - last.input_wakeups),
+             (unsigned long)(sched_stats.flush_wakeups - last.flush_wakeups),
+             (unsigned long)(sched_stats.ui_wakeups - last.ui_wakeups),
+             (unsigned long)(busy_us * 100 / period),
+             (unsigned long)(busy_us * 1000 / period % 10));
+    ESP_LOGI(TAG, "lvgl_lock %lu taken, %lu contended, wait max %lld us total %lld us",
+             (unsigned long)lock_stats.acquired, (unsigned long)lock_stats.contended,
+             (long long)lock_stats.max_wait_us, (long long)lock_stats.total_wait_us);
+    last = sched_stats;
+    log_start = now;
 }
 
+// Whether the next lv_timer_handler() will refresh the display: something is
+// invalidated and the refresh timer is due, or will be within a tick
+static bool lvgl_frame_due(void)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+    lv_timer_t *refr_timer = _lv_disp_get_refr_timer(disp);
+    return disp->inv_p && !refr_timer->paused && lv_tick_elaps(refr_timer->last_run) + 1 >= refr_timer->period;
+}
 
-void config_up_button(void)
+/*
+ * Runs LVGL timers, then sleeps on the task notification until the next
+ * timer deadline (one-shot esp_timer), a joystick event, a finished flush
+ * or a UI change from another task. The old fixed vTaskDelay() rounded to
+ * 0 ticks at CONFIG_FREERTOS_HZ=100 and busy-looped.
+ */
+static void lvgl_task(void *arg)
 {
-    static const lv_point_t points_array[] = {{100,30}};
+    ESP_LOGI(TAG, "Starting LVGL task");
+    amoled_register_flush_done_task(xTaskGetCurrentTaskHandle());
+    uint32_t wake_bits = 0;
+    while (1) {
+        uint32_t next_ms = LV_NO_TIMER_READY;
+        int64_t start = esp_timer_get_time();
+        // Lock the mutex due to the LVGL APIs are not thread-safe
+        if (lvgl_lock(-1)) {
+            if ((wake_bits & LVGL_WAKE_INPUT) && indev_joystick_drv.read_timer) {
+                lv_timer_resume(indev_joystick_drv.read_timer);
+                lv_timer_ready(indev_joystick_drv.read_timer);
+            }
+            // apply queued UI commands between frames
+            ui_queue_drain();
+            if (lvgl_frame_due()) {
+                // start the refresh on a panel vblank, waiting for it without
+                // the lock so other tasks are not held up by the panel
+                lvgl_unlock();
+                int64_t wait_start = esp_timer_get_time();
+                display_wait_vblank();
+                // idle time, not part of the pass or of the frame's render
+                start += esp_timer_get_time() - wait_start;
+                lvgl_lock(-1);
+            }
+            prof_pass_start = start;
+            prof_pass_flushed = false;
+            next_ms = lv_timer_handler();
+            // Release the mutex
+            lvgl_unlock();
+        }
+        // the last area of a frame is still on the wire; LVGL only waits for
+        // it when it needs the buffer again, so collect it before sleeping
+        if (disp_buf.flushing && lvgl_flush_collect(pdMS_TO_TICKS(LVGL_TASK_MAX_DELAY_MS))) {
+            sched_stats.wakeups++;
+            sched_stats.flush_wakeups++;
+        }
+        int64_t now = esp_timer_get_time();
+        if (prof_pass_flushed) {
+            frame_profiler_record(FRAME_STAGE_HANDLER, start, now);
+        }
+        sched_stats.busy_us += now - start;
+        lvgl_log_sched_stats(now);
+
+        esp_timer_stop(lvgl_deadline_timer);
+        if (next_ms == 0) {
+            wake_bits = 0;
+            taskYIELD();
+            continue;
+        }
+        if (next_ms < LVGL_TASK_MAX_DELAY_MS) {
+            esp_timer_start_once(lvgl_deadline_timer, next_ms * 1000ULL);
+        }
+        wake_bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &wake_bits, pdMS_TO_TICKS(LVGL_TASK_MAX_DELAY_MS));
 
-    lv_indev_drv_init(&indev_button_up_drv);
-    indev_button_up_drv.type = LV_INDEV_TYPE_BUTTON;
-    indev_button_up_drv.read_cb = button_up_read;
-    indev_button_up = lv_indev_drv_register(&indev_button_up_drv);
-    lv_indev_set_button_points(indev_button_up, points_array);
+        sched_stats.wakeups++;
+        if (wake_bits & LVGL_WAKE_TIMER) {
+            sched_stats.timer_wakeups++;
+        }
+        if (wake_bits & LVGL_WAKE_INPUT) {
+            sched_stats.input_wakeups++;
+        }
+        if (wake_bits & LVGL_WAKE_UI) {
+            sched_stats.ui_wakeups++;
+        }
+    }
 }
 
-void config_down_button(void)
+static void lvgl_input_event_cb(void *user_ctx)
 {
-    static const lv_point_t points_array[] = {{100,480}};
-
-    lv_indev_drv_init(&indev_button_down_drv);
-    indev_button_down_drv.type = LV_INDEV_TYPE_BUTTON;
-    indev_button_down_drv.read_cb = button_down_read;
-    indev_button_down = lv_indev_drv_register(&indev_button_down_drv);
-    lv_indev_set_button_points(indev_button_down, points_array);
+    lvgl_notify(LVGL_WAKE_INPUT);
 }
 
-void config_left_button(void)
+static void lvgl_ui_queue_cb(void *user_ctx)
 {
-    static const lv_point_t points_array[] = {{10,AMOLED_HEIGHT/2}};
+    lvgl_notify(LVGL_WAKE_UI);
+}
 
-    lv_indev_drv_init(&indev_button_left_drv);
-    indev_button_left_drv.type = LV_INDEV_TYPE_BUTTON;
-    indev_button_left_drv.read_cb = button_left_read;
-    indev_button_left = lv_indev_drv_register(&indev_button_left_drv);
-    lv_indev_set_button_points(indev_button_left, points_array);
+void lvgl_get_input_stats(lvgl_input_stats_t *stats)
+{
+    joystick_keypad_get_stats(stats);
+    stats->dropped = joystick_get_dropped_events();
 }
 
-void config_right_button(void)
+static void config_joystick_keypad(void)
 {
-    static const lv_point_t points_array[] = {{AMOLED_WIDTH-10 ,AMOLED_HEIGHT/2}};
+    joystick_group = lv_group_create();
 
-    lv_indev_drv_init(&indev_button_right_drv);
-    indev_button_right_drv.type = LV_INDEV_TYPE_BUTTON;
-    indev_button_right_drv.read_cb = button_right_read;
-    indev_button_right = lv_indev_drv_register(&indev_button_right_drv);
-    lv_indev_set_button_points(indev_button_right, points_array);
+    lv_indev_drv_init(&indev_joystick_drv);
+    indev_joystick_drv.type = LV_INDEV_TYPE_KEYPAD;
+    indev_joystick_drv.read_cb = joystick_keypad_read;
+    indev_joystick = lv_indev_drv_register(&indev_joystick_drv);
+    lv_indev_set_group(indev_joystick, joystick_group);
 }
 
-void config_middle_button(void)
+// Route a joystick key to a button; the button joins the keypad's focus group
+static void set_joystick_target(joystick_key_t key, lv_obj_t *btn)
 {
-    static const lv_point_t points_array[] = {{AMOLED_WIDTH/2 ,AMOLED_HEIGHT/2}};
-
-    lv_indev_drv_init(&indev_button_middle_drv);
-    indev_button_middle_drv.type = LV_INDEV_TYPE_BUTTON;
-    indev_button_middle_drv.read_cb = joystick_button_read;
-    indev_button_middle = lv_indev_drv_register(&indev_button_middle_drv);
-    lv_indev_set_button_points(indev_button_middle, points_array);
+    screen_manager_set_key_target(key, btn);
+    lv_group_add_obj(joystick_group, btn);
 }
 
 void lvgl_config(void)
 {
-    lv_color_t *buf1 = (lv_color_t *)heap_caps_malloc(DISPLAY_BUFFER_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
-    assert(buf1);
-
-    lv_color_t *buf2 = (lv_color_t *)heap_caps_malloc(DISPLAY_BUFFER_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
-    assert(buf2);
+    lv_color_t *buf1 = NULL;
+    lv_color_t *buf2 = NULL;
+    uint32_t buf_size = DISPLAY_BUFFER_SIZE;
+#if CONFIG_LVGL_STRIPE_BUFFERS
+    // two small stripes in internal SRAM: LVGL renders one while the other is sent
+    buf_size = display_width() * DISPLAY_STRIPE_LINES;
+    buf1 = (lv_color_t *)heap_caps_malloc(buf_size * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    buf2 = (lv_color_t *)heap_caps_malloc(buf_size * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!buf1 || !buf2) {
+        ESP_LOGW(TAG, "No internal memory for %d line stripes, using PSRAM", DISPLAY_STRIPE_LINES);
+        heap_caps_free(buf1);
+        heap_caps_free(buf2);
+        buf1 = NULL;
+        buf2 = NULL;
+        buf_size = DISPLAY_BUFFER_SIZE;
+    }
+#endif
+    if (!buf1) {
+        buf1 = (lv_color_t *)heap_caps_malloc(buf_size * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+        assert(buf1);
+
+        buf2 = (lv_color_t *)heap_caps_malloc(buf_size * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+        assert(buf2);
+        render_stats.draw_buf_in_psram = true;
+    }
+    ESP_LOGI(TAG, "Draw buffers 2 x %lu px in %s", (unsigned long)buf_size,
+             render_stats.draw_buf_in_psram ? "PSRAM" : "internal SRAM");
 
     // initialize LVGL draw buffers
-    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, DISPLAY_BUFFER_SIZE);
+    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, buf_size);
 
     ESP_LOGI(TAG, "Register display driver to LVGL");
     lv_disp_drv_init(&disp_drv);
-    disp_drv.hor_res = AMOLED_WIDTH;
-    disp_drv.ver_res = AMOLED_HEIGHT;
+    disp_drv.hor_res = display_width();
+    disp_drv.ver_res = display_height();
     disp_drv.flush_cb = lvgl_flush_cb;
     disp_drv.draw_buf = &disp_buf;
     disp_drv.full_refresh = 0;
+    disp_drv.monitor_cb = lvgl_monitor_cb;
+    disp_drv.wait_cb = lvgl_wait_cb;
     //disp_drv.sw_rotate = 1;
     //disp_drv.rotated =  LV_DISP_ROT_90;
-    lv_disp_drv_register(&disp_drv);
-    //config_keypad();
-    config_up_button();
-    config_down_button();
-    config_left_button();
-    config_right_button();
-    config_middle_button(); 
-
-    ESP_LOGI(TAG, "Install LVGL tick timer");
-    // Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = &increase_lvgl_tick,
+    lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+    area_planner_init(disp);
+    frame_profiler_init();
+    // refresh at the panel's real rate instead of LV_DISP_DEF_REFR_PERIOD
+    uint32_t frame_period_us = display_frame_period_us();
+    if (frame_period_us >= 1000) {
+        ESP_LOGI(TAG, "LVGL refresh period %lu ms from TE", (unsigned long)(frame_period_us / 1000));
+        lv_timer_set_period(_lv_disp_get_refr_timer(disp), frame_period_us / 1000);
+    }
+    config_joystick_keypad();
+    joystick_register_event_cb(lvgl_input_event_cb, NULL);
+    ui_queue_init();
+    ui_queue_register_wake_cb(lvgl_ui_queue_cb, NULL);
+
+    // LVGL reads its time from esp_timer_get_time() (CONFIG_LV_TICK_CUSTOM),
+    // so it keeps running inside lv_timer_handler(); this one-shot timer only
+    // wakes the task at the next LVGL deadline
+    const esp_timer_create_args_t lvgl_deadline_timer_args = {
+        .callback = &lvgl_deadline_cb,
         .arg = NULL,
         .dispatch_method = ESP_TIMER_TASK,
-        .name = "lvgl_tick",
-        .skip_unhandled_events = false
+        .name = "lvgl_deadline",
+        .skip_unhandled_events = true
     };
-    esp_timer_handle_t lvgl_tick_timer = NULL;
-    ESP_ERROR_CHECK(esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(lvgl_tick_timer, LVGL_TICK_PERIOD_MS * 1000));
+    ESP_ERROR_CHECK(esp_timer_create(&lvgl_deadline_timer_args, &lvgl_deadline_timer));
 
     lvgl_mux = xSemaphoreCreateRecursiveMutex();
     assert(lvgl_mux);
@@ -325,14 +469,10 @@ void lvgl_config(void)
 
 void lvgl_go(void)
 {
-    xTaskCreate(lvgl_task, "LVGL", LVGL_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+    xTaskCreate(lvgl_task, "LVGL", LVGL_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, &lvgl_task_handle);
 
 }
 
-void button_go(void)
-{
-    xTaskCreate(button_task, "BUTTON", LVGL_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
-}
 
 static void btn_down_event_cb(lv_event_t * e)
 {
@@ -421,14 +561,15 @@ static void btn_vac_on_event_cb(lv_event_t * e)
         {
             vac_on = 0;
             vacuum_off();
-            lv_obj_set_style_bg_color(background_obj, lv_palette_lighten(LV_PALETTE_GREY, 3), 0);
+            lv_obj_clear_state(lv_obj_get_screen(btn), CONTROL_VAC_STATE);
         }
         else
         {
             vac_on = 1;
             vacuum_on();
-            lv_obj_set_style_bg_color(background_obj, lv_palette_main(LV_PALETTE_RED), 0);
+            lv_obj_add_state(lv_obj_get_screen(btn), CONTROL_VAC_STATE);
         }
+        vac_redraw_pending = true;
     }
 }
 
@@ -454,67 +595,104 @@ static void btn_power_off_event_cb(lv_event_t * e)
     }
 }
 
+// One button of the control screen: grid cell, event handler and joystick key
+typedef struct control_widget {
+    const char      *text;
+    uint8_t         col;
+    uint8_t         col_span;
+    uint8_t         row;
+    uint8_t         row_span;
+    lv_event_cb_t   event_cb;
+    joystick_key_t  key;
+} control_widget_t;
+
+static const lv_coord_t control_col_dsc[] = {75, 74, 75, LV_GRID_TEMPLATE_LAST};
+static const lv_coord_t control_row_dsc[] = {60, 60, 60, 60, 60, 60, 60, 60, LV_GRID_TEMPLATE_LAST};
+
+static const control_widget_t control_layout[] = {
+    { "Up",     1, 1, 0, 1, btn_up_event_cb,         JOYSTICK_KEY_UP },
+    { "CRD up", 2, 1, 3, 2, btn_crowd_up_event_cb,   JOYSTICK_KEY_RIGHT },
+    { "CRD dn", 0, 1, 3, 2, btn_crowd_down_event_cb, JOYSTICK_KEY_LEFT },
+    { "Vac",    1, 1, 3, 2, btn_vac_on_event_cb,     JOYSTICK_KEY_PRESS },
+    { "Down",   1, 1, 7, 1, btn_down_event_cb,       JOYSTICK_KEY_DOWN },
+};
+
+// Shared by every build of the control screen instead of per-object local styles
+static lv_style_t control_screen_style;     // grid template and idle background
+static lv_style_t control_vac_style;        // background while the vacuum runs
+static lv_style_t control_label_style;      // button captions, centered
+static bool control_styles_ready = false;
+
+static void control_styles_init(void)
+{
+    lv_style_init(&control_screen_style);
+    lv_style_set_bg_color(&control_screen_style, lv_palette_lighten(LV_PALETTE_GREY, 3));
+    lv_style_set_grid_column_dsc_array(&control_screen_style, control_col_dsc);
+    lv_style_set_grid_row_dsc_array(&control_screen_style, control_row_dsc);
+    lv_style_set_layout(&control_screen_style, LV_LAYOUT_GRID);
+
+    lv_style_init(&control_vac_style);
+    lv_style_set_bg_color(&control_vac_style, lv_palette_main(LV_PALETTE_RED));
+
+    lv_style_init(&control_label_style);
+    lv_style_set_align(&control_label_style, LV_ALIGN_CENTER);
+    control_styles_ready = true;
+}
+
+// Crane, crowd and vacuum controls, driven by the joystick
+static lv_obj_t *control_screen_build(void *user_ctx)
+{
+    if (!control_styles_ready) {
+        control_styles_init();
+    }
+    lv_obj_t *background_obj = lv_obj_create(NULL);
+    lv_obj_add_style(background_obj, &control_screen_style, 0);
+    lv_obj_add_style(background_obj, &control_vac_style, CONTROL_VAC_STATE);
+    if (vac_on) {
+        lv_obj_add_state(background_obj, CONTROL_VAC_STATE);
+    }
+
+    lv_obj_t *btns[sizeof(control_layout) / sizeof(control_layout[0])];
+    for (size_t i = 0; i < sizeof(control_layout) / sizeof(control_layout[0]); i++) {
+        const control_widget_t *w = &control_layout[i];
+        lv_obj_t *btn = lv_btn_create(background_obj);
+        btns[i] = btn;
+        lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, w->col, w->col_span,
+                             LV_GRID_ALIGN_STRETCH, w->row, w->row_span);
+        lv_obj_add_event_cb(btn, w->event_cb, LV_EVENT_ALL, NULL);
+        lv_obj_t *label = lv_label_create(btn);
+        lv_label_set_text_static(label, w->text);
+        lv_obj_add_style(label, &control_label_style, 0);
+    }
+    // idle buttons become images, so a background change is a fill plus blits.
+    // Snapshot before the keypad group focuses the first one.
+    for (size_t i = 0; i < sizeof(btns) / sizeof(btns[0]); i++) {
+        render_cache_attach(btns[i]);
+        set_joystick_target(control_layout[i].key, btns[i]);
+    }
+    return background_obj;
+}
+
+/*
+ * Screens are registered by builder and created on first use, so boot only
+ * pays for the control screen. The others are reached with joystick
+ * left/right where the screen leaves them unmapped, or the BOOT button.
+ */
 void config_gui(void)
 {
-    static lv_coord_t col_dsc[] = {75, 74, 75, LV_GRID_TEMPLATE_LAST};
-    static lv_coord_t row_dsc[] = {60, 60, 60, 60, 60, 60, 60, 60, LV_GRID_TEMPLATE_LAST};
-
-    background_obj = lv_obj_create(NULL);
-    lv_obj_set_size(background_obj, AMOLED_WIDTH, AMOLED_HEIGHT);
-    lv_obj_set_style_bg_color(background_obj, lv_palette_lighten(LV_PALETTE_GREY, 3), 0);
-
-    /*Create a container with grid*/
-    lv_obj_set_style_grid_column_dsc_array(background_obj, col_dsc, 0);
-    lv_obj_set_style_grid_row_dsc_array(background_obj, row_dsc, 0);
-    lv_obj_center(background_obj);
-    lv_obj_set_layout(background_obj, LV_LAYOUT_GRID);
-
-    // create the top button on the screen
-    lv_obj_t * btn = lv_btn_create(background_obj);
-    lv_obj_set_size(btn, 100, 50);
-    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 1, 1,
-                         LV_GRID_ALIGN_STRETCH, 0, 1);
-    lv_obj_t * label = lv_label_create(btn);
-    lv_label_set_text(label, "Up");
-    lv_obj_add_event_cb(btn, btn_up_event_cb, LV_EVENT_ALL, NULL);
-    lv_obj_center(label);
-
-
-    // create the right side button
-    btn = lv_btn_create(background_obj);
-    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 2, 1,
-                         LV_GRID_ALIGN_STRETCH, 3, 2);
-    lv_obj_add_event_cb(btn, btn_crowd_up_event_cb, LV_EVENT_ALL, NULL);
-    label = lv_label_create(btn);
-    lv_label_set_text(label, "CRD up");
-    lv_obj_center(label);
-
-    // create the left side button
-    btn = lv_btn_create(background_obj);
-    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 0, 1,
-                         LV_GRID_ALIGN_STRETCH, 3, 2);
-    lv_obj_add_event_cb(btn, btn_crowd_down_event_cb, LV_EVENT_ALL, NULL);
-    label = lv_label_create(btn);
-    lv_label_set_text(label, "CRD dn");
-    lv_obj_center(label);
-
-    // create the middle button
-    btn = lv_btn_create(background_obj);
-    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 1, 1,
-                         LV_GRID_ALIGN_STRETCH, 3, 2);
-    lv_obj_add_event_cb(btn, btn_vac_on_event_cb, LV_EVENT_ALL, NULL);
-    label = lv_label_create(btn);
-    lv_label_set_text(label, "Vac");
-    lv_obj_center(label);
-
-    // create the bottom button
-    btn = lv_btn_create(background_obj);
-    lv_obj_set_size(btn, 100, 50);
-    lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, 1, 1,
-                         LV_GRID_ALIGN_STRETCH, 7, 1);
-    label = lv_label_create(btn);
-    lv_label_set_text(label, "Down");
-    lv_obj_add_event_cb(btn, btn_down_event_cb, LV_EVENT_ALL, NULL);
-    lv_obj_center(label);
-    lv_scr_load(background_obj);
+    int64_t start = esp_timer_get_time();
+
+    screen_manager_register("control", control_screen_build, NULL);
+    screen_manager_register("joystick", info_screen_joystick_build, NULL);
+    screen_manager_register("system", info_screen_system_build, NULL);
+    screen_manager_show(0);
+
+    screen_manager_stats_t stats;
+    screen_manager_get_stats(&stats);
+    ESP_LOGI(TAG, "GUI ready in %lld us, %lu bytes of LVGL heap for %lu screen(s)",
+             (long long)(esp_timer_get_time() - start), (unsigned long)stats.resident_bytes,
+             (unsigned long)stats.builds);
+#if CONFIG_LV_MEM_CUSTOM
+    lvgl_mem_log_stats();
+#endif
 }
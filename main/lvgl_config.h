@@ -6,24 +6,68 @@
  *
  */
 
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void button_config(void);
+typedef struct lvgl_render_stats {
+    uint32_t        frames;
+    uint32_t        time_ms;            // summed render + flush time reported by LVGL
+    uint64_t        pixels;
+    uint64_t        psram_bytes;        // estimated draw buffer traffic through PSRAM
+    bool            draw_buf_in_psram;
+} lvgl_render_stats_t;
+
+typedef struct lvgl_input_stats {
+    uint32_t        events;             // joystick edges delivered to LVGL
+    uint32_t        dropped;            // edges lost to a full event queue
+    int64_t         max_latency_us;     // joystick sample to LVGL read
+    int64_t         total_latency_us;
+} lvgl_input_stats_t;
+
+typedef struct lvgl_sched_stats {
+    uint32_t        wakeups;            // LVGL task wakeups, by cause below
+    uint32_t        timer_wakeups;
+    uint32_t        input_wakeups;
+    uint32_t        flush_wakeups;
+    uint32_t        ui_wakeups;
+    uint64_t        busy_us;            // time spent in lv_timer_handler()
+} lvgl_sched_stats_t;
 
-void button_go(void);
+typedef struct lvgl_lock_stats {
+    uint32_t        acquired;
+    uint32_t        contended;          // had to wait for another holder
+    uint32_t        timeouts;
+    int64_t         max_wait_us;
+    int64_t         total_wait_us;
+} lvgl_lock_stats_t;
 
 void lvgl_config(void);
 
 void lvgl_go(void);
 
+/**
+ * @brief Take the LVGL mutex. lv_timer_handler() holds it for a whole render,
+ *        so prefer ui_queue.h for simple updates from other tasks.
+ */
 bool lvgl_lock(int timeout_ms);
 
 void lvgl_unlock(void);
 
 void config_gui(void);
 
+void lvgl_get_render_stats(lvgl_render_stats_t *stats);
+
+void lvgl_get_input_stats(lvgl_input_stats_t *stats);
+
+void lvgl_get_sched_stats(lvgl_sched_stats_t *stats);
+
+void lvgl_get_lock_stats(lvgl_lock_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -19,14 +19,17 @@
 #include "driver/spi_master.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "nvs_flash.h"
 #include "lvgl.h"
 #include "amoled_driver.h"
 #include "i2c_driver.h"
+#include "i2c_bus_manager.h"
 #include "power_driver.h"
 #include "demos/lv_demos.h"
 #include "product_pins.h"
 #include "lv_examples.h"
 #include "lvgl_config.h"
+#include "button_config.h"
 #include "joystick_config.h"
 #include "relay_config.h"
 #include "sleep_config.h"
@@ -37,8 +40,18 @@ static const char *TAG = "main";
 extern "C" void app_main(void)
 {
     i2c_master_bus_handle_t i2c_bus;
+    // holds the joystick calibration
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
     ESP_LOGI(TAG, "------ Initialize I2C.");
     ESP_ERROR_CHECK(i2c_driver_init(&i2c_bus));
+    // every bus user, the PMU first, queues through the manager
+    ESP_ERROR_CHECK(i2c_bus_manager_init(i2c_bus));
 
     ESP_LOGI(TAG, "------ Initialize PMU.");
     if (!power_driver_init()) {
@@ -74,7 +87,7 @@ extern "C" void app_main(void)
 
     ESP_LOGI(TAG, "Start joystick thread");
     //i2c_drv_scan(&i2c_bus);
-    joystick_go(&i2c_bus);
+    joystick_go();
 
     ESP_LOGI(TAG, "Configure relay");
     relay_config();
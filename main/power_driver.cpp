@@ -12,11 +12,40 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "i2c_driver.h"
+#include "i2c_bus_manager.h"
 #include "product_pins.h"
 #include "driver/gpio.h"
 
 static const char *TAG = "POWER";
 
+#if CONFIG_PMU_AXP2101 || CONFIG_PMU_SY6970
+
+#define PMU_I2C_FREQ_HZ         400000
+#define PMU_I2C_TIMEOUT_MS      20
+
+static i2c_bus_dev_handle_t pmu_dev;
+
+// XPowersLib register access: queued behind user input on the shared bus, 0 on success
+static int pmu_read_reg(uint8_t addr, uint8_t reg, uint8_t *data, uint8_t len)
+{
+    return i2c_bus_read_reg(pmu_dev, reg, data, len, PMU_I2C_TIMEOUT_MS) == ESP_OK ? 0 : -1;
+}
+
+static int pmu_write_reg(uint8_t addr, uint8_t reg, uint8_t *data, uint8_t len)
+{
+    return i2c_bus_write_reg(pmu_dev, reg, data, len, PMU_I2C_TIMEOUT_MS) == ESP_OK ? 0 : -1;
+}
+
+static bool pmu_bus_add(uint8_t addr)
+{
+    if (!pmu_dev && i2c_bus_add_device(addr, PMU_I2C_FREQ_HZ, I2C_BUS_PRIO_TELEMETRY, "pmu", &pmu_dev) != ESP_OK) {
+        return false;
+    }
+    return true;
+}
+
+#endif
+
 
 #if CONFIG_PMU_AXP2101
 
@@ -27,7 +56,8 @@ XPowersAXP2101 PMU;
 
 bool power_driver_init()
 {
-    if (PMU.begin(bus_handle, AXP2101_SLAVE_ADDRESS)) {
+    if (pmu_bus_add(AXP2101_SLAVE_ADDRESS) &&
+        PMU.begin(AXP2101_SLAVE_ADDRESS, pmu_read_reg, pmu_write_reg)) {
         ESP_LOGI(TAG, "Init PMU SUCCESS!");
     } else {
         ESP_LOGE(TAG, "Init PMU FAILED!");
@@ -139,7 +169,8 @@ PowersSY6970 PMU;
 
 bool power_driver_init()
 {
-    if (PMU.begin(bus_handle, SY6970_SLAVE_ADDRESS)) {
+    if (pmu_bus_add(SY6970_SLAVE_ADDRESS) &&
+        PMU.begin(SY6970_SLAVE_ADDRESS, pmu_read_reg, pmu_write_reg)) {
         ESP_LOGI(TAG, "Init PMU SUCCESS!");
     } else {
         ESP_LOGE(TAG, "Init PMU FAILED!");
@@ -46,6 +46,17 @@
 
 #define AMOLED_INIT_CMD     sh8501_cmd
 #define AMOLED_INIT_CMD_LEN SH8501_INIT_SEQUENCE_LENGHT
+#define AMOLED_INIT_SCRIPT  sh8501_script
+#define AMOLED_INIT_SCRIPT_SIZE sh8501_script_size
+
+// Panel memory access control: the Lite panel is driven in landscape
+#define AMOLED_HAS_MADCTL       (1)
+#define AMOLED_MADCTL_DEFAULT   (0x00)
+#define AMOLED_DEFAULT_ROTATION (1)     // quarter turns clockwise
+// Window setup + CS cycle + driver time per flushed area, for the area planner
+#define DISPLAY_AREA_OVERHEAD_US    (25)
+// Lines per internal-SRAM draw stripe with CONFIG_LVGL_STRIPE_BUFFERS
+#define DISPLAY_STRIPE_LINES        (48)
 
 #define CONFIG_PMU_AXP2101  (1)
 #define BOARD_HAS_TOUCH      1
@@ -79,7 +90,15 @@
 
 #define AMOLED_INIT_CMD     rm67162_cmd
 #define AMOLED_INIT_CMD_LEN RM67162_INIT_SEQUENCE_LENGHT
+#define AMOLED_INIT_SCRIPT  rm67162_script
+#define AMOLED_INIT_SCRIPT_SIZE rm67162_script_size
 #define BOARD_HAS_TOUCH      0
+
+#define AMOLED_HAS_MADCTL       (1)
+#define AMOLED_MADCTL_DEFAULT   (0xC0)  // matches the 0x36 entry of rm67162_cmd
+#define AMOLED_DEFAULT_ROTATION (0)
+#define DISPLAY_AREA_OVERHEAD_US    (15)
+#define DISPLAY_STRIPE_LINES        (60)
 #define DISPLAY_BUFFER_SIZE  (AMOLED_WIDTH * AMOLED_HEIGHT)
 #define DISPLAY_FULLRESH     true
 
@@ -113,8 +132,16 @@
 
 #define AMOLED_INIT_CMD     rm67162_cmd
 #define AMOLED_INIT_CMD_LEN RM67162_INIT_SEQUENCE_LENGHT
+#define AMOLED_INIT_SCRIPT  rm67162_script
+#define AMOLED_INIT_SCRIPT_SIZE rm67162_script_size
 #define BOARD_HAS_TOUCH      1
 
+#define AMOLED_HAS_MADCTL       (1)
+#define AMOLED_MADCTL_DEFAULT   (0xC0)  // matches the 0x36 entry of rm67162_cmd
+#define AMOLED_DEFAULT_ROTATION (0)
+#define DISPLAY_AREA_OVERHEAD_US    (15)
+#define DISPLAY_STRIPE_LINES        (60)
+
 #define DISPLAY_BUFFER_SIZE  (AMOLED_WIDTH * AMOLED_HEIGHT)
 #define DISPLAY_FULLRESH     true
 // LILYGO 2.41 Inch AMOLED(RM690B0) S3R8
@@ -152,6 +179,15 @@
 
 #define AMOLED_INIT_CMD     rm690b0_cmd
 #define AMOLED_INIT_CMD_LEN RM690B0_INIT_SEQUENCE_LENGHT
+#define AMOLED_INIT_SCRIPT  rm690b0_script
+#define AMOLED_INIT_SCRIPT_SIZE rm690b0_script_size
+
+// The 16 column offset of this panel does not follow MADCTL, rotate in software
+#define AMOLED_HAS_MADCTL       (0)
+#define AMOLED_MADCTL_DEFAULT   (0x00)
+#define AMOLED_DEFAULT_ROTATION (0)
+#define DISPLAY_AREA_OVERHEAD_US    (15)
+#define DISPLAY_STRIPE_LINES        (32)
 
 #define CONFIG_PMU_SY6970   (1)
 
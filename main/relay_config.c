@@ -23,6 +23,51 @@
 
 
 static const char *TAG = "relay_config";
+
+// Commanded state of each actuator, unknown until the first command
+typedef enum {
+    ACTUATOR_UNKNOWN = -1,
+    ACTUATOR_STOP = 0,      // also "off" for the vacuum
+    ACTUATOR_UP,            // also "on" for the vacuum
+    ACTUATOR_DOWN,
+} actuator_state_t;
+
+static actuator_state_t crane_state = ACTUATOR_UNKNOWN;
+static actuator_state_t crowd_state = ACTUATOR_UNKNOWN;
+static actuator_state_t vacuum_state = ACTUATOR_UNKNOWN;
+
+static uint16_t relay_known;    // relays whose level has been written, bit per relay number
+static uint16_t relay_active;   // relays commanded on
+static relay_stats_t stats;
+
+// Record a command; false when it repeats the current state and must be dropped
+static bool actuator_command(actuator_state_t *state, actuator_state_t cmd)
+{
+    stats.commands++;
+    if (*state == cmd) {
+        stats.suppressed++;
+        return false;
+    }
+    *state = cmd;
+    return true;
+}
+
+// Track a relay's commanded level; false when the GPIO already has it
+static bool relay_transition(uint8_t relay, bool on)
+{
+    uint16_t bit = 1 << relay;
+    if ((relay_known & bit) && !!(relay_active & bit) == on) {
+        return false;
+    }
+    relay_known |= bit;
+    if (on) {
+        relay_active |= bit;
+    } else {
+        relay_active &= ~bit;
+    }
+    stats.gpio_writes++;
+    return true;
+}
 /**
  * @brief Configure GPIO pins for relays
  */
@@ -80,6 +125,9 @@ void relay_on(uint8_t relay)
             ESP_LOGW(TAG, "Invalid relay number: %d", relay);
             return;
     }
+    if (!relay_transition(relay, true)) {
+        return;
+    }
     
     if ((relay == 2) || (relay == 3))
     {
@@ -90,7 +138,7 @@ void relay_on(uint8_t relay)
         gpio_set_level(gpio_num, 0); // Active low for these relays
     }
 
-    ESP_LOGI(TAG, "Relay %d (GPIO %d) set to ON", relay, gpio_num);
+    ESP_LOGD(TAG, "Relay %d (GPIO %d) set to ON", relay, gpio_num);
 }
 
 void relay_off(uint8_t relay)
@@ -120,7 +168,9 @@ void relay_off(uint8_t relay)
             ESP_LOGW(TAG, "Invalid relay number: %d", relay);
             return;
     }
-
+    if (!relay_transition(relay, false)) {
+        return;
+    }
 
     if ((relay== 2) || (relay == 3))
     {
@@ -130,11 +180,14 @@ void relay_off(uint8_t relay)
     {
         gpio_set_level(gpio_num, 1); // Active low for these relays
     }
-    ESP_LOGI(TAG, "Relay %d (GPIO %d) set to OFF", relay, gpio_num);
+    ESP_LOGD(TAG, "Relay %d (GPIO %d) set to OFF", relay, gpio_num);
 }
 
 void crane_down()
 {
+    if (!actuator_command(&crane_state, ACTUATOR_DOWN)) {
+        return;
+    }
     relay_on(1);
     relay_on(2);
     relay_off(3);
@@ -144,6 +197,9 @@ void crane_down()
 
 void crane_up()
 {
+    if (!actuator_command(&crane_state, ACTUATOR_UP)) {
+        return;
+    }
     relay_on(1);
     relay_off(2);
     relay_on(3);
@@ -152,6 +208,9 @@ void crane_up()
 
 void crane_stop()
 {
+    if (!actuator_command(&crane_state, ACTUATOR_STOP)) {
+        return;
+    }
     relay_off(1);
     relay_off(2);
     relay_off(3);
@@ -160,18 +219,27 @@ void crane_stop()
 
 void vacuum_on()
 {
+    if (!actuator_command(&vacuum_state, ACTUATOR_UP)) {
+        return;
+    }
     ESP_LOGI(TAG, "Vacuum on");
      relay_on(4);
 }
 
 void vacuum_off()
-{   
+{
+    if (!actuator_command(&vacuum_state, ACTUATOR_STOP)) {
+        return;
+    }
     ESP_LOGI(TAG, "Vacuum off");
      relay_off(4);
 }   
 
 void crowd_up()
 {
+    if (!actuator_command(&crowd_state, ACTUATOR_UP)) {
+        return;
+    }
     ESP_LOGI(TAG, "Crowd up");
     relay_on(7);
     relay_off(8);    
@@ -179,6 +247,9 @@ void crowd_up()
 
 void crowd_down()
 {
+    if (!actuator_command(&crowd_state, ACTUATOR_DOWN)) {
+        return;
+    }
     ESP_LOGI(TAG, "Crowd down");
     relay_off(7);
     relay_on(8);
@@ -186,7 +257,15 @@ void crowd_down()
 
 void crowd_stop()
 {
+    if (!actuator_command(&crowd_state, ACTUATOR_STOP)) {
+        return;
+    }
     ESP_LOGI(TAG, "Crowd stop");
     relay_off(7);
     relay_off(8);
-}
\ No newline at end of file
+}
+
+void relay_get_stats(relay_stats_t *out)
+{
+    *out = stats;
+}
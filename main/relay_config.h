@@ -22,6 +22,12 @@ extern "C" {
 #define RELAY7_GPIO 45
 #define RELAY8_GPIO 46
 
+typedef struct relay_stats {
+    uint32_t        commands;       // crane/crowd/vacuum commands received
+    uint32_t        suppressed;     // commands that repeated the current state
+    uint32_t        gpio_writes;    // relay levels actually changed
+} relay_stats_t;
+
 void relay_config();
 
 void relay_on(uint8_t relay);
@@ -44,6 +50,13 @@ void crowd_down();
 
 void crowd_stop();
 
+/**
+ * @brief Actuator commands only touch the relays on a change of state, so the
+ *        button callbacks may repeat them on every LV_EVENT_PRESSING. Commands
+ *        come from the LVGL task; these counters are not synchronised.
+ */
+void relay_get_stats(relay_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
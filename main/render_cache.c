@@ -0,0 +1,91 @@
+/**
+ * @file      render_cache.c
+ * @license   MIT
+ *
+ */
+
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "lvgl.h"
+#include "render_cache.h"
+
+// keeps rounded corners and shadows correct over any background color
+#define RENDER_CACHE_CF     LV_IMG_CF_TRUE_COLOR_ALPHA
+
+typedef struct render_cache_entry {
+    lv_img_dsc_t    dsc;
+    uint32_t        size;
+    uint8_t         data[];
+} render_cache_entry_t;
+
+static render_cache_stats_t stats;
+
+#if CONFIG_RENDER_CACHE
+static const char *TAG = "render_cache";
+
+// the snapshot shows the idle look only; keypad focus sets FOCUSED and FOCUS_KEY
+static const lv_state_t live_states[] = {
+    LV_STATE_PRESSED, LV_STATE_FOCUSED, LV_STATE_FOCUS_KEY, LV_STATE_CHECKED,
+};
+
+static void render_cache_delete_cb(lv_event_t *e)
+{
+    render_cache_entry_t *entry = (render_cache_entry_t *)lv_event_get_user_data(e);
+    lv_img_cache_invalidate_src(&entry->dsc);
+    stats.entries--;
+    stats.bytes -= entry->size;
+    heap_caps_free(entry);
+}
+
+bool render_cache_attach(lv_obj_t *obj)
+{
+    lv_obj_update_layout(obj);
+    uint32_t size = lv_snapshot_buf_size_needed(obj, RENDER_CACHE_CF);
+    // outside the LVGL heap so cached screens stay within the screen budget
+    render_cache_entry_t *entry = (render_cache_entry_t *)heap_caps_malloc(sizeof(*entry) + size, MALLOC_CAP_SPIRAM);
+    if (!entry) {
+        entry = (render_cache_entry_t *)heap_caps_malloc(sizeof(*entry) + size, MALLOC_CAP_DEFAULT);
+    }
+    if (!entry) {
+        ESP_LOGW(TAG, "No memory for a %lu byte snapshot", (unsigned long)size);
+        stats.failures++;
+        return false;
+    }
+    if (lv_snapshot_take_to_buf(obj, RENDER_CACHE_CF, &entry->dsc, entry->data, size) != LV_RES_OK) {
+        heap_caps_free(entry);
+        stats.failures++;
+        return false;
+    }
+    entry->size = size;
+
+    // the snapshot includes the shadow, so center it on the object
+    lv_obj_t *img = lv_img_create(lv_obj_get_parent(obj));
+    lv_obj_add_flag(img, LV_OBJ_FLAG_IGNORE_LAYOUT);
+    lv_img_set_src(img, &entry->dsc);
+    lv_obj_align_to(img, obj, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_move_to_index(img, lv_obj_get_index(obj));
+    lv_obj_add_event_cb(img, render_cache_delete_cb, LV_EVENT_DELETE, entry);
+
+    // fully transparent objects are skipped by the refresh, children included;
+    // in the states that change its look the object draws itself again
+    lv_obj_set_style_opa(obj, LV_OPA_TRANSP, LV_STATE_DEFAULT);
+    for (size_t i = 0; i < sizeof(live_states) / sizeof(live_states[0]); i++) {
+        lv_obj_set_style_opa(obj, LV_OPA_COVER, live_states[i]);
+    }
+
+    stats.entries++;
+    stats.bytes += size;
+    return true;
+}
+#else
+bool render_cache_attach(lv_obj_t *obj)
+{
+    return false;
+}
+#endif
+
+void render_cache_get_stats(render_cache_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file      render_cache.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct render_cache_stats {
+    uint32_t        entries;        // live cached images
+    uint32_t        bytes;          // pixel memory held by them
+    uint32_t        failures;       // objects left to draw themselves
+} render_cache_stats_t;
+
+/**
+ * @brief Replace the idle rendering of a static object (e.g. a button with its
+ *        label) by a pre-rendered image. The object is snapshotted with its
+ *        shadow and alpha, the image is placed under it and the object itself
+ *        is only drawn while pressed, focused (FOCUSED, FOCUS_KEY) or checked,
+ *        so redrawing the area behind an idle one costs a fill and one blit.
+ *        Call once the object is styled and before it is focused; the image is
+ *        freed with the object's parent.
+ * @return false when the object keeps drawing itself (no memory, or the
+ *         cache is disabled)
+ */
+bool render_cache_attach(lv_obj_t *obj);
+
+void render_cache_get_stats(render_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,213 @@
+/**
+ * @file      screen_manager.c
+ * @license   MIT
+ *
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "lvgl.h"
+#include "screen_manager.h"
+#if CONFIG_LV_MEM_CUSTOM
+#include "lvgl_mem.h"
+#endif
+
+#ifndef CONFIG_SCREEN_MEM_BUDGET_KB
+#define CONFIG_SCREEN_MEM_BUDGET_KB 24
+#endif
+
+typedef struct screen_entry {
+    const char          *name;
+    screen_builder_t    builder;
+    void                *user_ctx;
+    lv_obj_t            *screen;        // NULL while not built
+    uint32_t            cost;           // LVGL heap used by the last build
+    uint32_t            last_used;      // LRU stamp
+    lv_obj_t            *key_targets[SCREEN_MANAGER_MAX_KEYS];
+} screen_entry_t;
+
+static const char *TAG = "screen_manager";
+
+static screen_entry_t screens[SCREEN_MANAGER_MAX_SCREENS];
+static int screen_count;
+static int active = -1;
+static int previous = -1;
+static int building = -1;
+static uint32_t use_clock;
+static uint32_t budget = CONFIG_SCREEN_MEM_BUDGET_KB * 1024;
+static screen_manager_stats_t stats;
+
+static uint32_t lv_mem_used(void)
+{
+#if CONFIG_LV_MEM_CUSTOM
+    // lv_mem_monitor() reports nothing with a custom allocator
+    lvgl_mem_stats_t mem;
+    lvgl_mem_get_stats(&mem);
+    stats.peak_lv_mem = mem.peak_used_bytes;
+    return mem.used_bytes;
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    if (mon.max_used > stats.peak_lv_mem) {
+        stats.peak_lv_mem = mon.max_used;
+    }
+    return mon.total_size - mon.free_size;
+#endif
+}
+
+static void screen_delete_cb(lv_event_t *e)
+{
+    screen_entry_t *entry = (screen_entry_t *)lv_event_get_user_data(e);
+    stats.resident_bytes -= entry->cost;
+    entry->screen = NULL;
+    memset(entry->key_targets, 0, sizeof(entry->key_targets));
+}
+
+// Keys sent to a screen (e.g. by the GPIO buttons) step through the screens
+static void screen_key_cb(lv_event_t *e)
+{
+    uint32_t key = *(uint32_t *)lv_event_get_param(e);
+    if (key == LV_KEY_NEXT || key == LV_KEY_RIGHT) {
+        screen_manager_next();
+    } else if (key == LV_KEY_PREV || key == LV_KEY_LEFT) {
+        screen_manager_prev();
+    }
+}
+
+int screen_manager_register(const char *name, screen_builder_t builder, void *user_ctx)
+{
+    if (screen_count >= SCREEN_MANAGER_MAX_SCREENS) {
+        ESP_LOGE(TAG, "No room for screen %s", name);
+        return -1;
+    }
+    screen_entry_t *entry = &screens[screen_count];
+    memset(entry, 0, sizeof(*entry));
+    entry->name = name;
+    entry->builder = builder;
+    entry->user_ctx = user_ctx;
+    return screen_count++;
+}
+
+void screen_manager_set_budget(uint32_t bytes)
+{
+    budget = bytes;
+}
+
+static bool screen_build(int index)
+{
+    screen_entry_t *entry = &screens[index];
+    int64_t start = esp_timer_get_time();
+    uint32_t used = lv_mem_used();
+
+    building = index;
+    entry->screen = entry->builder(entry->user_ctx);
+    building = -1;
+    if (!entry->screen) {
+        ESP_LOGE(TAG, "Building %s failed", entry->name);
+        return false;
+    }
+    lv_obj_add_event_cb(entry->screen, screen_delete_cb, LV_EVENT_DELETE, entry);
+    lv_obj_add_event_cb(entry->screen, screen_key_cb, LV_EVENT_KEY, NULL);
+
+    int64_t elapsed = esp_timer_get_time() - start;
+    uint32_t now_used = lv_mem_used();
+    entry->cost = now_used > used ? now_used - used : 0;
+    stats.builds++;
+    stats.build_time_us += elapsed;
+    stats.resident_bytes += entry->cost;
+    ESP_LOGI(TAG, "Built %s in %lld us, %lu bytes (resident %lu, lv_mem peak %lu)",
+             entry->name, (long long)elapsed, (unsigned long)entry->cost,
+             (unsigned long)stats.resident_bytes, (unsigned long)stats.peak_lv_mem);
+    return true;
+}
+
+/*
+ * Delete the least recently shown screens until the resident total fits the
+ * budget. The active screen and the one just left are kept: the latter may
+ * still own a pressed object that needs its release event. Deletion is async
+ * as this can run from an event of the screen being left.
+ */
+static void screen_evict(void)
+{
+    while (stats.resident_bytes > budget) {
+        int coldest = -1;
+        for (int i = 0; i < screen_count; i++) {
+            if (!screens[i].screen || i == active || i == previous) {
+                continue;
+            }
+            if (coldest < 0 || screens[i].last_used < screens[coldest].last_used) {
+                coldest = i;
+            }
+        }
+        if (coldest < 0) {
+            return;
+        }
+        screen_entry_t *entry = &screens[coldest];
+        ESP_LOGI(TAG, "Evicting %s (%lu bytes)", entry->name, (unsigned long)entry->cost);
+        lv_obj_t *screen = entry->screen;
+        // account now, the delete callback runs later
+        lv_obj_remove_event_cb(screen, screen_delete_cb);
+        stats.resident_bytes -= entry->cost;
+        entry->screen = NULL;
+        memset(entry->key_targets, 0, sizeof(entry->key_targets));
+        lv_obj_del_async(screen);
+        stats.evictions++;
+    }
+}
+
+void screen_manager_show(int index)
+{
+    if (index < 0 || index >= screen_count || index == active) {
+        return;
+    }
+    if (!screens[index].screen && !screen_build(index)) {
+        return;
+    }
+    screens[index].last_used = ++use_clock;
+    previous = active;
+    active = index;
+    lv_scr_load(screens[index].screen);
+    screen_evict();
+}
+
+void screen_manager_next(void)
+{
+    if (screen_count) {
+        screen_manager_show((active + 1) % screen_count);
+    }
+}
+
+void screen_manager_prev(void)
+{
+    if (screen_count) {
+        screen_manager_show((active + screen_count - 1) % screen_count);
+    }
+}
+
+int screen_manager_active(void)
+{
+    return active;
+}
+
+void screen_manager_set_key_target(uint8_t key, lv_obj_t *target)
+{
+    if (building >= 0 && key < SCREEN_MANAGER_MAX_KEYS) {
+        screens[building].key_targets[key] = target;
+    }
+}
+
+lv_obj_t *screen_manager_key_target(uint8_t key)
+{
+    if (active < 0 || key >= SCREEN_MANAGER_MAX_KEYS) {
+        return NULL;
+    }
+    return screens[active].key_targets[key];
+}
+
+void screen_manager_get_stats(screen_manager_stats_t *out)
+{
+    lv_mem_used();
+    *out = stats;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file      screen_manager.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCREEN_MANAGER_MAX_SCREENS  4
+#define SCREEN_MANAGER_MAX_KEYS     8
+
+// Build and return a new screen (lv_obj_create(NULL)); called in LVGL context
+typedef lv_obj_t *(*screen_builder_t)(void *user_ctx);
+
+typedef struct screen_manager_stats {
+    uint32_t        builds;
+    uint32_t        evictions;
+    uint32_t        resident_bytes;     // LVGL heap held by built screens
+    uint32_t        peak_lv_mem;        // high-water mark of the LVGL heap
+    int64_t         build_time_us;      // summed builder time
+} screen_manager_stats_t;
+
+/**
+ * @brief Register a screen by its builder. Nothing is created until the
+ *        screen is first shown.
+ * @return the screen index, or -1 when SCREEN_MANAGER_MAX_SCREENS are in use
+ */
+int screen_manager_register(const char *name, screen_builder_t builder, void *user_ctx);
+
+/**
+ * @brief Limit the LVGL heap held by screens that are not shown. After each
+ *        switch the least recently shown screens are deleted until the
+ *        resident total fits; they are rebuilt when shown again.
+ */
+void screen_manager_set_budget(uint32_t bytes);
+
+// Build the screen if needed and load it. LVGL context only.
+void screen_manager_show(int index);
+
+void screen_manager_next(void);
+
+void screen_manager_prev(void);
+
+int screen_manager_active(void);
+
+/**
+ * @brief Map an input key to an object of the screen being built, so input
+ *        devices can route keys per screen. Call from a builder.
+ */
+void screen_manager_set_key_target(uint8_t key, lv_obj_t *target);
+
+// Target for a key on the active screen, NULL when the screen does not map it
+lv_obj_t *screen_manager_key_target(uint8_t key);
+
+void screen_manager_get_stats(screen_manager_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
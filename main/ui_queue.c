@@ -0,0 +1,181 @@
+/**
+ * @file      ui_queue.c
+ * @license   MIT
+ *
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include "lvgl.h"
+#include "ui_queue.h"
+
+#define UI_QUEUE_LEN    16      /*!< power of two */
+
+/*
+ * Bounded multi-producer/single-consumer ring. Every slot carries a sequence
+ * number: producers claim a position with a CAS on enqueue_pos and publish
+ * the slot by setting its sequence to pos + 1; the consumer frees it again by
+ * moving the sequence one lap ahead.
+ */
+typedef struct ui_slot {
+    atomic_uint     seq;
+    ui_cmd_t        cmd;
+} ui_slot_t;
+
+static ui_slot_t slots[UI_QUEUE_LEN];
+static atomic_uint enqueue_pos;
+static unsigned dequeue_pos;
+
+static atomic_uint posted;
+static atomic_uint dropped;
+static uint32_t applied;
+static uint32_t stale;
+
+static ui_queue_wake_cb_t wake_cb;
+static void *wake_cb_ctx;
+
+void ui_queue_init(void)
+{
+    for (unsigned i = 0; i < UI_QUEUE_LEN; i++) {
+        atomic_init(&slots[i].seq, i);
+    }
+    atomic_init(&enqueue_pos, 0);
+    dequeue_pos = 0;
+}
+
+void ui_queue_register_wake_cb(ui_queue_wake_cb_t cb, void *user_ctx)
+{
+    wake_cb_ctx = user_ctx;
+    wake_cb = cb;
+}
+
+bool ui_queue_post(const ui_cmd_t *cmd)
+{
+    ui_slot_t *slot;
+    unsigned pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+    while (1) {
+        slot = &slots[pos & (UI_QUEUE_LEN - 1)];
+        unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+        }
+    }
+    slot->cmd = *cmd;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    atomic_fetch_add_explicit(&posted, 1, memory_order_relaxed);
+
+    if (wake_cb) {
+        wake_cb(wake_cb_ctx);
+    }
+    return true;
+}
+
+bool ui_set_bg_color(lv_obj_t *obj, lv_color_t color)
+{
+    ui_cmd_t cmd = {
+        .type = UI_CMD_BG_COLOR,
+        .obj = obj,
+    };
+    cmd.color = color;
+    return ui_queue_post(&cmd);
+}
+
+bool ui_set_label_text(lv_obj_t *label, const char *text)
+{
+    ui_cmd_t cmd = {
+        .type = UI_CMD_LABEL_TEXT,
+        .obj = label,
+    };
+    strncpy(cmd.text, text, UI_CMD_TEXT_LEN - 1);
+    cmd.text[UI_CMD_TEXT_LEN - 1] = '\0';
+    return ui_queue_post(&cmd);
+}
+
+bool ui_load_screen(lv_obj_t *screen)
+{
+    ui_cmd_t cmd = {
+        .type = UI_CMD_LOAD_SCREEN,
+        .obj = screen,
+    };
+    return ui_queue_post(&cmd);
+}
+
+bool ui_send_key(lv_obj_t *obj, uint32_t key)
+{
+    ui_cmd_t cmd = {
+        .type = UI_CMD_SEND_KEY,
+        .obj = obj,
+    };
+    cmd.key = key;
+    return ui_queue_post(&cmd);
+}
+
+/*
+ * Commands carry raw object pointers and may be posted just before the
+ * object is deleted (e.g. screens freed with lv_obj_del_async()), so each
+ * one is checked against the live object tree first. A command whose object
+ * was deleted and whose address was reused by a new object still applies.
+ */
+static bool ui_apply(const ui_cmd_t *cmd)
+{
+    if (cmd->obj && !lv_obj_is_valid(cmd->obj)) {
+        return false;
+    }
+    switch (cmd->type) {
+    case UI_CMD_BG_COLOR:
+        lv_obj_set_style_bg_color(cmd->obj, cmd->color, 0);
+        break;
+    case UI_CMD_LABEL_TEXT:
+        lv_label_set_text(cmd->obj, cmd->text);
+        break;
+    case UI_CMD_LOAD_SCREEN:
+        lv_scr_load(cmd->obj);
+        break;
+    case UI_CMD_SEND_KEY: {
+        uint32_t key = cmd->key;
+        lv_event_send(cmd->obj ? cmd->obj : lv_scr_act(), LV_EVENT_KEY, &key);
+        break;
+    }
+    default:
+        break;
+    }
+    return true;
+}
+
+uint32_t ui_queue_drain(void)
+{
+    uint32_t count = 0;
+    while (1) {
+        ui_slot_t *slot = &slots[dequeue_pos & (UI_QUEUE_LEN - 1)];
+        unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if ((int)(seq - (dequeue_pos + 1)) < 0) {
+            break;
+        }
+        if (ui_apply(&slot->cmd)) {
+            count++;
+        } else {
+            stale++;
+        }
+        atomic_store_explicit(&slot->seq, dequeue_pos + UI_QUEUE_LEN, memory_order_release);
+        dequeue_pos++;
+    }
+    applied += count;
+    return count;
+}
+
+void ui_queue_get_stats(ui_queue_stats_t *stats)
+{
+    stats->posted = atomic_load_explicit(&posted, memory_order_relaxed);
+    stats->applied = applied;
+    stats->stale = stale;
+    stats->dropped = atomic_load_explicit(&dropped, memory_order_relaxed);
+}
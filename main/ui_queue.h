@@ -0,0 +1,75 @@
+/**
+ * @file      ui_queue.h
+ * @license   MIT
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UI_CMD_TEXT_LEN     32
+
+typedef enum {
+    UI_CMD_BG_COLOR = 0,        // lv_obj_set_style_bg_color(obj, color, 0)
+    UI_CMD_LABEL_TEXT,          // lv_label_set_text(obj, text)
+    UI_CMD_LOAD_SCREEN,         // lv_scr_load(obj)
+    UI_CMD_SEND_KEY,            // LV_EVENT_KEY to obj, or the active screen if NULL
+} ui_cmd_type_t;
+
+typedef struct ui_cmd {
+    uint8_t         type;       // ui_cmd_type_t
+    lv_obj_t        *obj;
+    union {
+        lv_color_t  color;
+        uint32_t    key;
+        char        text[UI_CMD_TEXT_LEN];
+    };
+} ui_cmd_t;
+
+typedef struct ui_queue_stats {
+    uint32_t        posted;
+    uint32_t        applied;
+    uint32_t        dropped;        // queue was full
+    uint32_t        stale;          // skipped, the object was deleted after the post
+} ui_queue_stats_t;
+
+typedef void (*ui_queue_wake_cb_t)(void *user_ctx);
+
+void ui_queue_init(void);
+
+// Called after every post, from the posting context (task or ISR)
+void ui_queue_register_wake_cb(ui_queue_wake_cb_t cb, void *user_ctx);
+
+/**
+ * @brief Queue a UI change for the LVGL task without taking lvgl_lock().
+ *        Lock-free and safe from any number of tasks and ISRs.
+ * @return false if the queue is full and the command was dropped
+ */
+bool ui_queue_post(const ui_cmd_t *cmd);
+
+bool ui_set_bg_color(lv_obj_t *obj, lv_color_t color);
+
+// Copies text, truncated to UI_CMD_TEXT_LEN - 1 characters
+bool ui_set_label_text(lv_obj_t *label, const char *text);
+
+bool ui_load_screen(lv_obj_t *screen);
+
+bool ui_send_key(lv_obj_t *obj, uint32_t key);
+
+/**
+ * @brief Apply all queued commands. LVGL task only, with lvgl_lock() held.
+ *        Commands for objects deleted since they were posted are skipped.
+ * @return the number of commands applied
+ */
+uint32_t ui_queue_drain(void);
+
+void ui_queue_get_stats(ui_queue_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif